@@ -1,8 +1,75 @@
+// Accept header for endpoints that can answer in CBOR (same schema as JSON, several times smaller)
+function cborAccept() {
+    return CONFIG.useCbor ? { 'Accept': 'application/cbor, application/json;q=0.9' } : {};
+}
+
+// Decodes the CBOR subset the firmware writes: integers, booleans, null, strings, arrays and maps
+// (definite or indefinite length)
+function decodeCbor(buffer) {
+    const view = new DataView(buffer);
+    const utf8 = new TextDecoder();
+    let pos = 0;
+
+    function length(info) {
+        if (info < 24) return info;
+        if (info === 24) return view.getUint8(pos++);
+        if (info === 25) { pos += 2; return view.getUint16(pos - 2); }
+        if (info === 26) { pos += 4; return view.getUint32(pos - 4); }
+        if (info === 31) return -1;  // Indefinite, ends with a break
+        throw new Error('Unsupported CBOR length');
+    }
+
+    function item() {
+        const initial = view.getUint8(pos++);
+        const major = initial >> 5;
+        const info = initial & 0x1F;
+        if (major === 7) {
+            if (info === 20) return false;
+            if (info === 21) return true;
+            if (info === 22) return null;
+            throw new Error('Unsupported CBOR simple value');
+        }
+        const len = length(info);
+        switch (major) {
+            case 0: return len;
+            case 1: return -1 - len;
+            case 3: {
+                const text = utf8.decode(new Uint8Array(buffer, pos, len));
+                pos += len;
+                return text;
+            }
+            case 4: {
+                const items = [];
+                while (len < 0 ? view.getUint8(pos) !== 0xFF : items.length < len) items.push(item());
+                if (len < 0) pos++;
+                return items;
+            }
+            case 5: {
+                const map = {};
+                for (let i = 0; len < 0 ? view.getUint8(pos) !== 0xFF : i < len; i++) {
+                    const key = item();
+                    map[key] = item();
+                }
+                if (len < 0) pos++;
+                return map;
+            }
+            default:
+                throw new Error('Unsupported CBOR major type ' + major);
+        }
+    }
+
+    return item();
+}
+
 // API Communication Layer
 const API = {
+    // Request latency in ms, split by whether the browser reused a kept-alive connection
+    latency: { reused: [], fresh: [], count: 0 },
+
     // Generic API call wrapper
     async call(endpoint, options = {}) {
         try {
+            const started = performance.now();
             const response = await fetch(endpoint, {
                 ...options,
                 headers: {
@@ -15,13 +82,48 @@ const API = {
                 throw new Error(`HTTP error! status: ${response.status}`);
             }
 
-            return await response.json();
+            const type = response.headers.get('Content-Type') || '';
+            const data = type.startsWith('application/cbor')
+                ? decodeCbor(await response.arrayBuffer())
+                : await response.json();
+            this.recordLatency(endpoint, performance.now() - started);
+            return data;
         } catch (error) {
             console.error('API call failed:', error);
             throw error;
         }
     },
 
+    // A request that did not open a TCP connection has connectStart == connectEnd in its resource timing
+    recordLatency(endpoint, elapsed) {
+        const url = new URL(endpoint, window.location.href).href;
+        const entries = performance.getEntriesByName(url);
+        const entry = entries[entries.length - 1];
+        const reused = entry ? entry.connectEnd === entry.connectStart : false;
+        // The resource timing buffer is small and fills up with the status polling
+        performance.clearResourceTimings();
+
+        const bucket = reused ? this.latency.reused : this.latency.fresh;
+        bucket.push(elapsed);
+        if (bucket.length > CONFIG.latencySamples) {
+            bucket.shift();
+        }
+        if (++this.latency.count % CONFIG.latencySamples === 0) {
+            console.log('⏱️ Request latency', this.latencySummary());
+        }
+    },
+
+    // Average latency and sample count with and without connection reuse
+    latencySummary() {
+        const avg = (values) => values.length ? Math.round(values.reduce((a, b) => a + b, 0) / values.length) : null;
+        return {
+            reusedAvgMs: avg(this.latency.reused),
+            reusedSamples: this.latency.reused.length,
+            freshAvgMs: avg(this.latency.fresh),
+            freshSamples: this.latency.fresh.length
+        };
+    },
+
     // Status
     async getStatus() {
         return this.call(CONFIG.api.status);
@@ -29,11 +131,11 @@ const API = {
 
     // Schedule
     async getSchedule(channel) {
-        return this.call(`${CONFIG.api.scheduleGet}?channel=${channel}`);
+        return this.call(`${CONFIG.api.scheduleGet}?channel=${channel}`, { headers: cborAccept() });
     },
 
     async getAllSchedules() {
-        return this.call(CONFIG.api.scheduleAll);
+        return this.call(CONFIG.api.scheduleAll, { headers: cborAccept() });
     },
 
     async saveSchedule(channel, targets) {
@@ -56,6 +158,14 @@ const API = {
         });
     },
 
+    // Ordered add/move/delete operations, applied all or nothing with one save per channel
+    async batchSchedule(ops) {
+        return this.call(CONFIG.api.scheduleBatch, {
+            method: 'POST',
+            body: JSON.stringify({ ops })
+        });
+    },
+
     async deleteTarget(channel, time) {
         return this.call(CONFIG.api.targetDelete, {
             method: 'POST',
@@ -80,12 +190,17 @@ const API = {
     },
 
     // Macros
+    // Status, channel config, schedules and macro list in one response
+    async getBootstrap() {
+        return this.call(CONFIG.api.bootstrap);
+    },
+
     async getMacros() {
         return this.call(CONFIG.api.macroList);
     },
 
     async getMacro(id) {
-        return this.call(`${CONFIG.api.macroGet}?id=${encodeURIComponent(id)}`);
+        return this.call(`${CONFIG.api.macroGet}?id=${encodeURIComponent(id)}`, { headers: cborAccept() });
     },
 
     async saveMacro(id, name, duration, channels) {
@@ -102,8 +217,12 @@ const API = {
         });
     },
 
-    async stopMacro() {
-        return this.call(CONFIG.api.macroStop, { method: 'POST' });
+    async stopMacro(id) {
+        // Without an id every running macro stops
+        return this.call(CONFIG.api.macroStop, {
+            method: 'POST',
+            body: id ? JSON.stringify({ id }) : undefined
+        });
     },
 
     async deleteMacro(id) {
@@ -113,6 +232,13 @@ const API = {
         });
     },
 
+    async setMacroFavorite(id, favorite) {
+        return this.call(CONFIG.api.macroFavorite, {
+            method: 'POST',
+            body: JSON.stringify({ id, favorite })
+        });
+    },
+
     // Channel Configuration
     async getChannelConfig() {
         return this.call(CONFIG.api.channelConfigGet);
@@ -125,3 +251,73 @@ const API = {
         });
     }
 };
+
+// Live test mode control over a WebSocket with binary frames (see TestControl.h in the firmware).
+// At most one frame is in flight; slider moves in between are merged and sent when the ack arrives.
+const TestControl = {
+    socket: null,
+    seq: 0,
+    inFlight: false,
+    sentAt: 0,
+    pending: {},  // channel -> value not sent yet
+
+    connect() {
+        if (!window.WebSocket || this.socket) return;
+        const socket = new WebSocket(`ws://${window.location.hostname}:${CONFIG.testControlPort}/`);
+        socket.binaryType = 'arraybuffer';
+        socket.onopen = () => {
+            this.inFlight = false;
+            this.flush();
+        };
+        socket.onmessage = () => {
+            // Ack of the newest applied frame
+            this.inFlight = false;
+            this.flush();
+        };
+        socket.onclose = () => {
+            this.socket = null;
+        };
+        this.socket = socket;
+    },
+
+    disconnect() {
+        if (this.socket) {
+            this.socket.close();
+            this.socket = null;
+        }
+        this.pending = {};
+    },
+
+    isOpen() {
+        return this.socket !== null && this.socket.readyState === WebSocket.OPEN;
+    },
+
+    set(channel, value) {
+        this.pending[channel] = value;
+        // Do not wait forever for an ack that will not come
+        if (!this.inFlight || performance.now() - this.sentAt > CONFIG.testControlAckTimeout) {
+            this.flush();
+        }
+    },
+
+    // Frame: seq (2 bytes LE), flags, channel mask, one value per channel in the mask
+    flush() {
+        const channels = Object.keys(this.pending).map(Number).sort((a, b) => a - b);
+        if (!channels.length || !this.isOpen()) return;
+
+        const frame = new Uint8Array(4 + channels.length);
+        this.seq = (this.seq + 1) & 0xFFFF;
+        frame[0] = this.seq & 0xFF;
+        frame[1] = this.seq >> 8;
+        frame[2] = CONFIG.testInstantApply ? 1 : 0;
+        channels.forEach((ch, i) => {
+            frame[3] |= 1 << ch;
+            frame[4 + i] = this.pending[ch];
+        });
+        this.socket.send(frame);
+
+        this.pending = {};
+        this.inFlight = true;
+        this.sentAt = performance.now();
+    }
+};
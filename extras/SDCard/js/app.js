@@ -20,8 +20,20 @@ const sliderTimers = {};
 async function init() {
     console.log('🚀 Initializing Aquarium Control...');
 
+    // Everything the first render needs in one request, the single endpoints remain as fallback
+    let boot = null;
+    try {
+        boot = await API.getBootstrap();
+    } catch (error) {
+        console.warn('⚠️ Bootstrap failed, loading separately:', error);
+    }
+
     // Load channel configuration first
-    await loadChannelConfig();
+    if (boot) {
+        applyChannelConfig(boot.config);
+    } else {
+        await loadChannelConfig();
+    }
 
     // Initialize main chart
     mainChart = new ChartManager('scheduleChart');
@@ -31,9 +43,16 @@ async function init() {
     createChannelControls();
 
     // Load initial data
-    await loadSchedules();
-    startScheduleUpdates();
-    await loadMacros();
+    if (boot) {
+        applyStatus(boot.status);
+        applySchedules(boot.schedules);
+        startScheduleUpdates();
+        await applyMacroList(boot.macros);
+    } else {
+        await loadSchedules();
+        startScheduleUpdates();
+        await loadMacros();
+    }
 
     // Start status updates
     startStatusUpdates();
@@ -83,6 +102,7 @@ function createChannelControls(containerId = 'channelControls', includeAllChanne
             <div class="channel-header">
                 <span class="channel-name">${CONFIG.channelNames[i]}</span>
                 <span class="channel-value" id="value-${containerId}-${i}">0%</span>
+                <span class="channel-live" id="live-${containerId}-${i}"></span>
             </div>
             <div class="slider-container">
                 <input type="range" 
@@ -137,6 +157,18 @@ function handleSliderInput(channel, value, containerId = 'channelControls') {
         clearTimeout(sliderTimers[timerKey]);
     }
 
+    // Live control channel: every move is sent, merged while a frame is in flight
+    if (state.testMode && containerId === 'channelControls' && TestControl.isOpen()) {
+        if (state.linkChannels) {
+            for (let i = 0; i < 6; i++) {
+                TestControl.set(i, value);
+            }
+        } else {
+            TestControl.set(channel, value);
+        }
+        return;
+    }
+
     // Debounce: send update after slider stops moving
     if (state.testMode && containerId === 'channelControls') {
         sliderTimers[timerKey] = setTimeout(() => {
@@ -184,27 +216,40 @@ async function sendTestUpdate(channel, value) {
 async function loadSchedules() {
     try {
         console.log('📥 Loading schedules...');
-        const data = await API.getAllSchedules();
-
-        if (data.schedules) {
-            state.schedules = data.schedules;
-            mainChart.updateAll(data.schedules);
-            console.log('✅ Schedules loaded');
-        }
+        applySchedules(await API.getAllSchedules());
     } catch (error) {
         console.error('❌ Failed to load schedules:', error);
     }
 }
 
+function applySchedules(data) {
+    if (data && data.schedules) {
+        state.schedules = data.schedules;
+        mainChart.updateAll(data.schedules);
+        console.log('✅ Schedules loaded');
+    }
+}
+
 // Load macros
 async function loadMacros() {
     try {
         console.log('📥 Loading macros...');
-        const data = await API.getMacros();
+        await applyMacroList(await API.getMacros());
+    } catch (error) {
+        console.error('❌ Failed to load macros:', error);
+        document.getElementById('macroList').innerHTML =
+            '<p class="loading">Fehler beim Laden der Makros</p>';
+    }
+}
 
-        if (data.macros) {
-            // Load full details for each macro to get duration
+async function applyMacroList(data) {
+    try {
+        if (data && data.macros) {
+            // The list carries the duration, load full details only for entries without one
             state.macros = await Promise.all(data.macros.map(async (macro) => {
+                if (macro.duration > 0) {
+                    return macro;
+                }
                 try {
                     const details = await API.getMacro(macro.id);
                     // Calculate duration from first channel's last target time
@@ -326,6 +371,7 @@ async function startTestMode() {
     try {
         await API.startTestMode();
         state.testMode = true;
+        TestControl.connect();
 
         // Update UI
         document.getElementById('testBanner').classList.remove('hidden');
@@ -343,6 +389,7 @@ async function startTestMode() {
 // Exit test mode
 async function exitTestMode() {
     try {
+        TestControl.disconnect();
         await API.exitTestMode();
         state.testMode = false;
 
@@ -372,11 +419,13 @@ async function addTargetAtTime() {
 
     try {
         console.log('🔵 Adding targets for all channels...');
-        // Add current slider values to this time for all channels
+        // Add current slider values to this time for all channels in one request
+        const ops = [];
         for (let channel = 0; channel < 6; channel++) {
             console.log(`🔵 Channel ${channel}: value=${state.channelValues[channel]}`);
-            await API.addTarget(channel, time, state.channelValues[channel]);
+            ops.push({ op: 'add', channel, time, value: state.channelValues[channel] });
         }
+        await API.batchSchedule(ops);
 
         // Reload schedules
         await loadSchedules();
@@ -471,69 +520,156 @@ function buildSampledTargetsForChannel(channel) {
 
 // Status updates
 let statusUpdateTimer = null;
+let eventSource = null;
+let clockTimer = null;
+let lastStatus = {};
+let clockBase = 0;
+let macroBase = 0;
 
 function startStatusUpdates() {
+    if (CONFIG.useEventStream && window.EventSource) {
+        startEventStream();
+    } else {
+        startStatusPolling();
+    }
+}
+
+function startStatusPolling() {
+    if (statusUpdateTimer) return;
     updateStatus();  // Initial update
     statusUpdateTimer = setInterval(updateStatus, CONFIG.statusUpdateInterval);
 }
 
-async function updateStatus() {
-    try {
-        const data = await API.getStatus();
+function stopStatusPolling() {
+    if (statusUpdateTimer) {
+        clearInterval(statusUpdateTimer);
+        statusUpdateTimer = null;
+    }
+}
 
-        // Update time
-        if (data.time) {
-            document.getElementById('time').textContent = data.time;
-        }
+// Server-Sent Events: one status snapshot on connect, then only what changed.
+// While the stream is down the browser reconnects on its own and we poll meanwhile.
+function startEventStream() {
+    eventSource = new EventSource(CONFIG.api.events);
 
-        // Update temperature
-        if (data.temperature !== undefined) {
-            document.getElementById('temp').textContent = data.temperature.toFixed(1);
-        }
+    eventSource.onopen = () => {
+        stopStatusPolling();
+        if (!clockTimer) clockTimer = setInterval(renderLiveStatus, 1000);
+    };
 
-        // Update test mode status
-        if (data.test_mode !== state.testMode) {
-            state.testMode = data.test_mode;
-            if (data.test_mode) {
-                document.getElementById('testBanner').classList.remove('hidden');
-            } else {
-                document.getElementById('testBanner').classList.add('hidden');
-            }
+    eventSource.onerror = () => {
+        if (clockTimer) {
+            clearInterval(clockTimer);
+            clockTimer = null;
         }
+        startStatusPolling();
+    };
 
-        // Update macro status
-        if (data.macro_active !== state.macroActive) {
-            state.macroActive = data.macro_active;
+    eventSource.addEventListener('status', (e) => mergeStatus(JSON.parse(e.data), true));
+    ['macro', 'test', 'temperature'].forEach((name) => {
+        eventSource.addEventListener(name, (e) => mergeStatus(JSON.parse(e.data)));
+    });
+    eventSource.addEventListener('outputs', (e) => applyOutputs(JSON.parse(e.data).outputs));
+}
 
-            if (data.macro_active) {
-                state.activeMacro = data.macro_id || 'Unknown';
-                document.getElementById('macroName').textContent = data.macro_id || 'Macro';
-                document.getElementById('macroBanner').classList.remove('hidden');
-            } else {
-                document.getElementById('macroBanner').classList.add('hidden');
-            }
-        }
+function mergeStatus(data, snapshot = false) {
+    const received = performance.now();
+    if (snapshot) {
+        lastStatus = {};
+    }
+    Object.assign(lastStatus, data);
+    if (data.current_seconds !== undefined) clockBase = received;
+    if (data.macro_active !== undefined) macroBase = received;
+    renderLiveStatus();
+}
 
-        // Update macro timer (use macro_expires_in from server)
-        if (state.macroActive && data.macro_expires_in !== undefined) {
-            const remaining = data.macro_expires_in;
-
-            if (remaining > 0) {
-                const mins = Math.floor(remaining / 60);
-                const secs = remaining % 60;
-                document.getElementById('macroRemaining').textContent =
-                    `${mins.toString().padStart(2, '0')}:${secs.toString().padStart(2, '0')}`;
-            } else {
-                document.getElementById('macroRemaining').textContent = '00:00';
-            }
+// The stream sends no per-second events, so clock and macro countdown tick locally
+function renderLiveStatus() {
+    const elapsed = (performance.now() - clockBase) / 1000;
+    const data = { ...lastStatus };
+
+    if (data.current_seconds !== undefined) {
+        const secs = Math.floor(data.current_seconds + elapsed) % 86400;
+        data.time = [Math.floor(secs / 3600), Math.floor((secs % 3600) / 60), secs % 60]
+            .map((v) => v.toString().padStart(2, '0')).join(':');
+    }
+
+    if (data.macro_active && data.macro_expires_in !== undefined) {
+        const macroElapsed = (performance.now() - macroBase) / 1000;
+        data.macro_expires_in = Math.max(0, Math.round(data.macro_expires_in - macroElapsed));
+    }
+
+    applyStatus(data);
+}
+
+// Live PWM outputs (percent per channel), shown next to the slider values
+function applyOutputs(outputs) {
+    for (const [channel, percent] of Object.entries(outputs)) {
+        const live = document.getElementById(`live-channelControls-${channel}`);
+        if (live) {
+            live.textContent = `💡 ${percent}%`;
         }
+    }
+}
 
+async function updateStatus() {
+    try {
+        applyStatus(await API.getStatus());
     } catch (error) {
         console.error('❌ Status update failed:', error);
         document.getElementById('wifiStatus').textContent = '📶 Verbindungsfehler';
     }
 }
 
+function applyStatus(data) {
+    // Update time
+    if (data.time) {
+        document.getElementById('time').textContent = data.time;
+    }
+
+    // Update temperature
+    if (data.temperature !== undefined) {
+        document.getElementById('temp').textContent = data.temperature.toFixed(1);
+    }
+
+    // Update test mode status
+    if (data.test_mode !== state.testMode) {
+        state.testMode = data.test_mode;
+        if (data.test_mode) {
+            document.getElementById('testBanner').classList.remove('hidden');
+        } else {
+            document.getElementById('testBanner').classList.add('hidden');
+        }
+    }
+
+    // Update macro status
+    if (data.macro_active !== state.macroActive) {
+        state.macroActive = data.macro_active;
+
+        if (data.macro_active) {
+            state.activeMacro = data.macro_id || 'Unknown';
+            document.getElementById('macroName').textContent = data.macro_id || 'Macro';
+            document.getElementById('macroBanner').classList.remove('hidden');
+        } else {
+            document.getElementById('macroBanner').classList.add('hidden');
+        }
+    }
+
+    // Update macro timer (use macro_expires_in from server)
+    if (state.macroActive && data.macro_expires_in !== undefined) {
+        const remaining = data.macro_expires_in;
+
+        if (remaining > 0) {
+            const mins = Math.floor(remaining / 60);
+            const secs = remaining % 60;
+            document.getElementById('macroRemaining').textContent =
+                `${mins.toString().padStart(2, '0')}:${secs.toString().padStart(2, '0')}`;
+        } else {
+            document.getElementById('macroRemaining').textContent = '00:00';
+        }
+    }
+}
+
 // Macro Wizard
 let wizardMode = 'create';  // 'create' or 'edit'
 let wizardMacroName = null;
@@ -759,19 +895,22 @@ async function editMacro(macroId) {
 // Load channel configuration from API
 async function loadChannelConfig() {
     try {
-        const data = await API.getChannelConfig();
-        if (data && data.channels && data.channels.length === 6) {
-            // Update CONFIG with loaded values
-            CONFIG.channelNames = data.channels.map(ch => ch.name);
-            CONFIG.channelColors = data.channels.map(ch => ch.color);
-            console.log('✅ Channel config loaded');
-        }
+        applyChannelConfig(await API.getChannelConfig());
     } catch (error) {
         console.warn('⚠️ Failed to load channel config, using defaults:', error);
         // Keep defaults from config.js
     }
 }
 
+function applyChannelConfig(data) {
+    if (data && data.channels && data.channels.length === 6) {
+        // Update CONFIG with loaded values
+        CONFIG.channelNames = data.channels.map(ch => ch.name);
+        CONFIG.channelColors = data.channels.map(ch => ch.color);
+        console.log('✅ Channel config loaded');
+    }
+}
+
 // Show channel configuration editor
 function showChannelConfigEditor() {
     const modal = document.createElement('div');
@@ -854,4 +993,7 @@ window.addEventListener('beforeunload', () => {
     if (statusUpdateTimer) {
         clearInterval(statusUpdateTimer);
     }
+    if (eventSource) {
+        eventSource.close();
+    }
 });
@@ -24,14 +24,25 @@ const CONFIG = {
     statusUpdateInterval: 1000,      // Update status every second
     chartUpdateInterval: 60000,      // Refresh chart every 6 seconds
     sliderDebounceTime: 150,         // Wait 150ms after slider stops moving
+    latencySamples: 100,             // Requests per latency summary (kept-alive vs. new connection)
+    useEventStream: true,            // Push status via /api/events, poll only while it is unavailable
+    useCbor: true,                   // Ask for CBOR schedules and macros (falls back to JSON if the server sends it)
+
+    // Test mode control channel (WebSocket, falls back to POST /api/test/update)
+    testControlPort: 81,
+    testInstantApply: true,          // Outputs jump to the slider value instead of fading
+    testControlAckTimeout: 500,      // Send the next frame even if the last one was not acknowledged (ms)
 
     // API endpoints (relative URLs work with mock server and ESP8266)
     api: {
         status: '/api/status',
+        bootstrap: '/api/bootstrap',
+        events: '/api/events',
         scheduleGet: '/api/schedule/get',
         scheduleAll: '/api/schedule/all',
         scheduleSave: '/api/schedule/save',
         scheduleClear: '/api/schedule/clear',
+        scheduleBatch: '/api/schedule/batch',
         targetAdd: '/api/schedule/target/add',
         targetDelete: '/api/schedule/target/delete',
         testStart: '/api/test/start',
@@ -43,6 +54,7 @@ const CONFIG = {
         macroActivate: '/api/macro/activate',
         macroStop: '/api/macro/stop',
         macroDelete: '/api/macro/delete',
+        macroFavorite: '/api/macro/favorite',
         channelConfigGet: '/api/config/channels',
         channelConfigSave: '/api/config/channels'
     }
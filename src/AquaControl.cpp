@@ -61,7 +61,7 @@ void AquaControl::initESP8266NetworkConnection()
 		Serial.print(_WlanConfig.IP.toString());
 		WiFi.config(_WlanConfig.IP, _WlanConfig.Gateway, IPAddress(255, 255, 255, 0));
 	}
-	WiFi.begin(_WlanConfig.SSID.c_str(), _WlanConfig.PW.c_str());
+	WiFi.begin(_WlanConfig.SSID, _WlanConfig.PW);
 	uint8_t iTimeout = 20; // 10 sec should be enough for connecting to an existing wlan
 	while (WiFi.status() != WL_CONNECTED && iTimeout > 0)
 	{
@@ -86,255 +86,121 @@ void AquaControl::initESP8266NetworkConnection()
 	Serial.println(WiFi.localIP());
 }
 
-Option extractOptionFromConfigLine(String sLine)
+// Helper: Writes a key="value" config line
+static void writeOption(Print &out, const char *key, const char *value)
 {
-	Option option;
-	option.Key = sLine.substring(0, sLine.indexOf('='));
-	String sValue = sLine.substring(sLine.indexOf('=') + 1);
-	// Filter leading spaces at the beginnning of the config line
-	while (sLine.length() > 0 && sLine.charAt(0) == ' ')
-	{
-		sLine = sLine.substring(1);
-	}
-	if (sValue.length() > 2 && sValue.charAt(0) == '"' && sValue.charAt(sValue.length() - 1) == '"')
-	{
-		option.Value = sValue.substring(1, sValue.length() - 1);
-	}
-	else
-	{
-		option.Value = "";
-	}
-	return option;
-}
-
-String buildLine(Option opt)
-{
-	return opt.Key + "=\"" + opt.Value + "\"";
+	out.print(key);
+	out.print(F("=\""));
+	out.print(value);
+	out.print(F("\"\r\n"));
 }
 
 bool AquaControl::writeWlanConfig()
 {
+	HEAP_SCOPE(HeapScopeSdConfig);
 	File wlanCfg = SD.open("config/wlan.cfg");
-	if (SD.exists("config/wlan_new.cfg"))
-	{
-		if (!SD.remove("config/wlan_new.cfg"))
-		{
-			Serial.println(F("Error deleting old wlan_new.cfg"));
-			return false;
-		}
-		else
-		{
-			Serial.println(F("wlan_new.cfg deleted."));
-		}
-	}
 	if (!wlanCfg)
 	{
 		Serial.println(F("Error opening config/wlan.cfg"));
+		return false;
 	}
-	File wlanCfgNew = SD.open("config/wlan_new.cfg", FILE_WRITE);
-	if (!wlanCfgNew)
+	AtomicFileWriter wlanCfgNew;
+	if (!wlanCfgNew.begin("config/wlan.cfg"))
 	{
-		Serial.println(F("Error creating config/wlan_new.cfg"));
+		wlanCfg.close();
 		return false;
 	}
 
-	if (wlanCfg && wlanCfgNew)
+	// The setting lines are replaced, everything else (comments) is kept as it is
+	ConfigReader reader(wlanCfg);
+	TextView key;
+	TextView value;
+	while (reader.next(true))
 	{
-		while (wlanCfg.available())
+		bool setting = !reader.isComment() && reader.option(key, value);
+		if (setting && key.equals("mode"))
 		{
-			String sLine = wlanCfg.readStringUntil(10); // Read until line feed char(10)
-			// Filter carriage return (13) from the end of the line
-			if (sLine.charAt(sLine.length() - 1) == 13)
-			{
-				sLine = sLine.substring(0, sLine.length() - 1);
-			}
-			// Filter tailing spaces at the end of the config line
-			while (sLine.length() > 2 && sLine.charAt(sLine.length() - 1) == ' ')
-			{
-				sLine = sLine.substring(0, sLine.length() - 1);
-			}
-
-			// Search for config settings
-			if (sLine.startsWith("mode"))
-			{
-				// mode setting found
-				Serial.println(F("Mode line found"));
-				Serial.print(F("Old line: "));
-				Serial.println(sLine);
-				Option opt;
-				opt.Key = "mode";
-				opt.Value = _WlanConfig.Mode == WlanModeClient ? "client" : "ap";
-				sLine = buildLine(opt);
-				Serial.print(F("New line: "));
-				Serial.println(sLine);
-			}
-			if (sLine.startsWith("ssid"))
-			{
-				// ssid setting found
-				Serial.println(F("SSID line found"));
-				Serial.print(F("Old line: "));
-				Serial.println(sLine);
-				Option opt;
-				opt.Key = "ssid";
-				opt.Value = _WlanConfig.SSID;
-				sLine = buildLine(opt);
-				Serial.print(F("New line: "));
-				Serial.println(sLine);
-			}
-			if (sLine.startsWith("pw"))
-			{
-				// password setting found
-				Serial.println(F("PW line found"));
-				Serial.print(F("Old line: "));
-				Serial.println(sLine);
-				Option opt;
-				opt.Key = "pw";
-				opt.Value = _WlanConfig.PW;
-				sLine = buildLine(opt);
-				Serial.print(F("New line: "));
-				Serial.println(sLine);
-			}
-			if (sLine.startsWith("ip"))
-			{
-				// ip address setting found
-				Serial.println(F("IP line found"));
-				Serial.print(F("Old line: "));
-				Serial.println(sLine);
-				Option opt;
-				opt.Key = "ip";
-				opt.Value = _WlanConfig.ManualIP ? _WlanConfig.IP.toString() : "auto";
-				sLine = buildLine(opt);
-				Serial.print(F("New line: "));
-				Serial.println(sLine);
-			}
-			if (sLine.startsWith("gateway"))
-			{
-				// ip address setting found
-				Serial.println(F("Gateway line found"));
-				Serial.print(F("Old line: "));
-				Serial.println(sLine);
-				Option opt;
-				opt.Key = "gateway";
-				opt.Value = _WlanConfig.ManualIP ? _WlanConfig.Gateway.toString() : "auto";
-				sLine = buildLine(opt);
-				Serial.print(F("New line: "));
-				Serial.println(sLine);
-			}
-			wlanCfgNew.write((sLine + (char)13 + char(10)).c_str());
+			writeOption(wlanCfgNew, "mode", _WlanConfig.Mode == WlanModeClient ? "client" : "ap");
 		}
-		wlanCfg.close();
-		wlanCfgNew.close();
-		SD.remove("config/wlan.cfg");
-		wlanCfg = SD.open("config/wlan.cfg", FILE_WRITE);
-		wlanCfgNew = SD.open("config/wlan_new.cfg");
-		while (wlanCfgNew.available())
+		else if (setting && key.equals("ssid"))
 		{
-			String sLine = wlanCfgNew.readStringUntil(10);
-			if (sLine.charAt(sLine.length() - 1) == 13)
-			{
-				sLine = sLine.substring(0, sLine.length() - 1);
-			}
-			wlanCfg.write((sLine + (char)13 + char(10)).c_str());
+			writeOption(wlanCfgNew, "ssid", _WlanConfig.SSID);
 		}
-		wlanCfg.close();
-		wlanCfgNew.close();
-		if (!SD.remove("config/wlan_new.cfg"))
+		else if (setting && key.equals("pw"))
 		{
-			Serial.println("Error deleting new wlan_new.cfg");
-			return false;
+			writeOption(wlanCfgNew, "pw", _WlanConfig.PW);
+		}
+		else if (setting && key.equals("ip"))
+		{
+			writeOption(wlanCfgNew, "ip", _WlanConfig.ManualIP ? _WlanConfig.IP.toString().c_str() : "auto");
+		}
+		else if (setting && key.equals("gateway"))
+		{
+			writeOption(wlanCfgNew, "gateway", _WlanConfig.ManualIP ? _WlanConfig.Gateway.toString().c_str() : "auto");
 		}
 		else
 		{
-			Serial.println("wlan_new.cfg deleted.");
+			TextView line = reader.line();
+			wlanCfgNew.write((const uint8_t *)line.Data, line.Length);
+			wlanCfgNew.print(F("\r\n"));
 		}
-		return true;
-	}
-	else
-	{
-		Serial.println("Error opening files");
-		return false;
 	}
+	wlanCfg.close();
+	return wlanCfgNew.commit();
 }
 
 bool AquaControl::readWlanConfig()
 {
+	HEAP_SCOPE(HeapScopeSdConfig);
 	File wlanCfg = SD.open("config/wlan.cfg");
-	String sMode;
-	String sSSID;
-	String sPW;
-	String sIP;
-	String sGateway;
 
 	if (wlanCfg)
 	{
+		// Currently we have to fix this to client mode
+		_WlanConfig.Mode = WlanModeClient;
+		_WlanConfig.SSID[0] = '\0';
+		_WlanConfig.PW[0] = '\0';
+		_WlanConfig.ManualIP = false;
+		_WlanConfig.IP = IPAddress((uint32_t)0);
+		_WlanConfig.Gateway = IPAddress((uint32_t)0);
+
 		// Read line by line
-		while (wlanCfg.available())
+		ConfigReader reader(wlanCfg);
+		TextView key;
+		TextView value;
+		while (reader.next())
 		{
-			String sLine = wlanCfg.readStringUntil(10);
-			if (sLine.charAt(sLine.length() - 1) == 13)
-			{
-				sLine = sLine.substring(0, sLine.length() - 1);
-			}
-			// Filter leading spaces at the beginnning of the config line
-			while (sLine.length() > 0 && sLine.charAt(0) == ' ')
-			{
-				sLine = sLine.substring(1);
-			}
-			// Filter tailing spaces at the end of the config line
-			while (sLine.length() > 2 && sLine.charAt(sLine.length() - 1) == ' ')
-			{
-				sLine = sLine.substring(0, sLine.length() - 1);
-			}
-			// Search for config settings
-			if (sLine.startsWith("mode"))
+			if (!reader.option(key, value))
 			{
-				// mode setting found
-				sMode = extractOptionFromConfigLine(sLine).Value;
-				sMode.toLowerCase();
+				continue;
 			}
-			if (sLine.startsWith("ssid"))
+			char sValue[sizeof(_WlanConfig.PW)];
+			value.copyTo(sValue, sizeof(sValue));
+			// Search for config settings, "auto" or an invalid address leaves an address unset
+			if (key.equals("ssid"))
 			{
-				// ssid setting found
-				sSSID = extractOptionFromConfigLine(sLine).Value;
+				value.copyTo(_WlanConfig.SSID, sizeof(_WlanConfig.SSID));
 			}
-			if (sLine.startsWith("pw"))
+			else if (key.equals("pw"))
 			{
-				// password setting found
-				sPW = extractOptionFromConfigLine(sLine).Value;
+				value.copyTo(_WlanConfig.PW, sizeof(_WlanConfig.PW));
 			}
-			if (sLine.startsWith("ip"))
+			else if (key.equals("ip"))
 			{
-				// ip address setting found
-				sIP = extractOptionFromConfigLine(sLine).Value;
+				_WlanConfig.ManualIP = _WlanConfig.IP.fromString(sValue);
+				if (!_WlanConfig.ManualIP)
+				{
+					_WlanConfig.IP = IPAddress((uint32_t)0);
+				}
 			}
-			if (sLine.startsWith("gateway"))
+			else if (key.equals("gateway"))
 			{
-				// ip address setting found
-				sGateway = extractOptionFromConfigLine(sLine).Value;
+				if (!_WlanConfig.Gateway.fromString(sValue))
+				{
+					_WlanConfig.Gateway = IPAddress((uint32_t)0);
+				}
 			}
 		}
-		// Currently we have to fix this to client mode
-		sMode = "client";
-		this->_WlanConfig.SSID = sSSID;
-		this->_WlanConfig.PW = sPW;
-		if (sIP != "auto")
-		{
-			this->_WlanConfig.ManualIP = true;
-			this->_WlanConfig.IP = extractIPAddress(sIP);
-		}
-		else
-		{
-			this->_WlanConfig.ManualIP = false;
-			this->_WlanConfig.IP = IPAddress((uint32_t)0);
-		}
-		if (sGateway != "auto")
-		{
-			this->_WlanConfig.Gateway = extractIPAddress(sGateway);
-		}
-		else
-		{
-			this->_WlanConfig.Gateway = IPAddress((uint32_t)0);
-		}
 
 		// close the file:
 		wlanCfg.close();
@@ -351,157 +217,91 @@ bool AquaControl::readWlanConfig()
 
 bool AquaControl::readLedConfig()
 {
-	// Iterate through the pwm channels visible in the UI (6 channels)
+	HEAP_SCOPE(HeapScopeSdConfig);
+	// Only the channels visible in the UI (6 channels) are stored
 	// The system supports more channels (up to 16 on PCA9685), but the UI only manages these 6
-	uint8_t channelsToLoad = (PWM_CHANNELS > 6) ? 6 : PWM_CHANNELS;
-	for (uint8_t i = 0; i < channelsToLoad; i++)
-	{
-		char sTempName[30]; // This is used because the string objects causing freezes when using in SD.exists or SD.open commands
-		String sPwmFilename = "config/ledch_";
-		sPwmFilename += (i <= 9 ? "0" : "") + String(i);
-		sPwmFilename += ".cfg";
-		// Check if config file exists for this channel
-		sPwmFilename.toCharArray(sTempName, 30);
-		if (!SD.exists(sTempName))
+	if (_ScheduleStore.load(_PwmChannels, SCHEDULE_STORE_CHANNELS))
+	{
+		return true;
+	}
+	// No valid store yet: import the text files of earlier versions once and keep them as they are
+	Serial.print(F(" Importing text schedules..."));
+	for (uint8_t i = 0; i < SCHEDULE_STORE_CHANNELS; i++)
+	{
+		importLedConfig(i);
+	}
+	return _ScheduleStore.save(_PwmChannels, SCHEDULE_STORE_CHANNELS);
+}
+
+// Replaces the targets of a channel with the content of config/ledch_NN.cfg.
+// Lines are "HH:MM;value", "HH:MM:SS;value" or "seconds;value", "//" starts a comment.
+bool AquaControl::importLedConfig(uint8_t channel)
+{
+	char sTempName[30];
+	snprintf(sTempName, sizeof(sTempName), "config/ledch_%02u.cfg", channel);
+	File pwmFile = SD.open(sTempName);
+	if (!pwmFile)
+	{
+		// Config file doesn't exist - this is normal for first boot or unconfigured channels
+		return false;
+	}
+
+	// Read into the spare snapshot, the channel keeps playing its targets until the file is complete
+	ScheduleSnapshot *schedule = editSchedule(channel, false);
+	ConfigReader reader(pwmFile);
+	long targetTime;
+	int value;
+	while (reader.next())
+	{
+		if (!reader.record(targetTime, value))
 		{
-			// Config file doesn't exist - this is normal for first boot or unconfigured channels
 			continue;
 		}
-		else
+		if (targetTime > (60 * 60 * 24))
 		{
-			File pwmFile = SD.open(sTempName);
-			if (!pwmFile)
-			{
-				Serial.print(F("Error: Couldn't open config file for LED channel "));
-				Serial.println(i + 1);
-				continue;
-			}
-			else
-			{
-				while (pwmFile.available())
-				{
-					// First line is always the time
-					String sLine = pwmFile.readStringUntil(10);
-					if (sLine.charAt(sLine.length() - 1) == 13)
-					{
-						sLine = sLine.substring(0, sLine.length() - 1);
-					}
-					// Filter leading spaces at the beginnning of the config line
-					while (sLine.length() > 0 && sLine.charAt(0) == ' ')
-					{
-						sLine = sLine.substring(1);
-					}
-					// Filter tailing spaces at the end of the config line
-					while (sLine.length() > 2 && sLine.charAt(sLine.length() - 1) == ' ')
-					{
-						sLine = sLine.substring(0, sLine.length() - 1);
-					}
-					if (sLine.length() == 0)
-					{
-						// Ignore this line
-						continue;
-					}
-					else if (sLine.startsWith("//"))
-					{
-						// Irgnoe this line too
-						continue;
-					}
-					// Try to separate time and value
-					uint8_t iSemikolonIndex = sLine.indexOf(';');
-					String sTime = sLine.substring(0, iSemikolonIndex);
-					String sValue = sLine.substring(iSemikolonIndex + 1);
-					// PArse the time
-					int8_t index = sTime.indexOf(':');
-					long targetTime = 0;
-					// Eighter in format of hh:mm
-					if (index != -1)
-					{
-						int8_t hour = sLine.substring(0, index).toInt();
-						int8_t min = sLine.substring(index + 1).toInt();
-						targetTime = (60 * 60 * hour) + (60 * min);
-					}
-					else
-					{ // Or in format of seconds of the day
-						targetTime = sLine.toInt();
-					}
-					if (targetTime > (60 * 60 * 24))
-					{
-						// if the time is longer than a day, so put it to the last second in a day
-						targetTime = 3600 * 24;
-					}
-					Target target;
-					target.Time = targetTime;
-					target.Value = sValue.toInt();
-					_PwmChannels[i].addTarget(target);
-				}
-			}
+			// if the time is longer than a day, so put it to the last second in a day
+			targetTime = 3600 * 24;
 		}
+		Target target;
+		target.Time = targetTime;
+		target.Value = value;
+		schedule->add(target);
 	}
+	pwmFile.close();
+	publishSchedule(channel);
 	return true;
 }
 
-// Helper: Write targets to file with given path format
-// pathPrefix: e.g. "config/ledch_" or "macros/macro_" (function appends channel number and .cfg)
-bool AquaControl::writeTargetsToFile(const String &pathPrefix, uint8_t channel, PwmChannel &pwmChannel)
+// Marks the schedules as replaced, the store is written by the persistence scheduler.
+// The version was already bumped by publishSchedule().
+void AquaControl::scheduleChanged()
 {
-	char sTempFilename[30];
-	String sFilename = pathPrefix;
-	sFilename += (channel <= 9 ? (String("0") + String(channel)) : String(channel));
-	sFilename += ".cfg";
-	sFilename.toCharArray(sTempFilename, 30);
-
-	// Delete the old file
-	if (SD.exists(sTempFilename))
-	{
-		if (!SD.remove(sTempFilename))
-		{
-			Serial.print(F("Error: Couldn't remove old file "));
-			Serial.println(sFilename);
-			return false;
-		}
-	}
+	_ScheduleStore.noteReplaced();
+}
 
-	// Create the new file
-	File configFile = SD.open(sTempFilename, FILE_WRITE);
-	if (!configFile)
-	{
-		Serial.print(F("Error: Couldn't create file "));
-		Serial.println(sFilename);
-		return false;
-	}
+bool AquaControl::setScheduleTarget(uint8_t channel, Target target)
+{
+	editSchedule(channel, true)->set(target);
+	publishSchedule(channel);
+	_ScheduleStore.noteEdit(ScheduleJournalSet, channel, target.Time, target.Value);
+	return true;
+}
 
-	// Write all targets to file
-	// Format: HH:MM;VALUE (e.g. 08:30;100)
-	for (uint8_t t = 0; t < pwmChannel.TargetCount; t++)
+bool AquaControl::removeScheduleTarget(uint8_t channel, time_t time)
+{
+	if (editSchedule(channel, true)->removeAtTime(time))
 	{
-		Target tTarget = pwmChannel.Targets[t];
-
-		// Format time as HH:MM
-		uint8_t iHour = hour(tTarget.Time);
-		uint8_t iMinute = minute(tTarget.Time);
-
-		char timeBuf[8];
-		sprintf(timeBuf, "%02d:%02d", iHour, iMinute);
-		configFile.print(timeBuf);
-
-		// Write separator and value
-		configFile.write(';');
-		char valueBuf[4];
-		sprintf(valueBuf, "%u", (unsigned int)tTarget.Value);
-		configFile.print(valueBuf);
-
-		// Write line ending
-		configFile.write(13);
-		configFile.write(10);
+		publishSchedule(channel);
+		_ScheduleStore.noteEdit(ScheduleJournalRemove, channel, time, 0);
 	}
-
-	configFile.close();
 	return true;
 }
 
-bool AquaControl::writeLedConfig(uint8_t pwmChannel)
+// Persists pending schedule edits right away, e.g. before a restart
+bool AquaControl::flushSchedules()
 {
-	return writeTargetsToFile("config/ledch_", pwmChannel, _PwmChannels[pwmChannel]);
+	HEAP_SCOPE(HeapScopeSdConfig);
+	return _ScheduleStore.flush(_PwmChannels, SCHEDULE_STORE_CHANNELS);
 }
 
 #if defined(USE_NTP)
@@ -667,7 +467,45 @@ void AquaControl::initTimeKeeper()
 	{
 		Serial.println(F("WARNING: No time source available. Time sync via /api/time/set required."));
 	}
+	notifyChange(ChangeTimeSync);
+}
+
+#if defined(USE_WEBSERVER)
+// Request headers the handlers read (the web server drops all others)
+static const char *_CollectedHeaders[] = {"Accept", "Accept-Encoding", "If-None-Match", "Range"};
+
+// Registers a web route. With the heap tracker enabled every route gets its own attribution scope.
+static void onRoute(const char *uri, HTTPMethod method, ESP8266WebServer::THandlerFunction handler,
+					ESP8266WebServer::THandlerFunction uploadHandler = nullptr)
+{
+#if defined(USE_HEAP_TRACKER)
+	uint8_t scope = _HeapTracker.addScope(uri, method);
+	ESP8266WebServer::THandlerFunction trackedHandler = [scope, handler]()
+	{
+		HEAP_SCOPE(scope);
+		handler();
+	};
+	if (uploadHandler)
+	{
+		ESP8266WebServer::THandlerFunction trackedUpload = [scope, uploadHandler]()
+		{
+			HEAP_SCOPE(scope);
+			uploadHandler();
+		};
+		_Server.on(uri, method, trackedHandler, trackedUpload);
+		return;
+	}
+	_Server.on(uri, method, trackedHandler);
+#else
+	if (uploadHandler)
+	{
+		_Server.on(uri, method, handler, uploadHandler);
+		return;
+	}
+	_Server.on(uri, method, handler);
+#endif
 }
+#endif
 
 uint8_t AquaControl::getPhysicalChannelAddress(uint8_t channelNumber)
 {
@@ -714,6 +552,10 @@ uint8_t AquaControl::getPhysicalChannelAddress(uint8_t channelNumber)
 
 void AquaControl::init()
 {
+#if defined(USE_HEAP_TRACKER)
+	_HeapTracker.begin();
+#endif
+	HEAP_SCOPE(HeapScopeBoot);
 
 	// Init SD card device
 	Serial.println();
@@ -731,6 +573,9 @@ void AquaControl::init()
 		return;
 	}
 	Serial.println(F(" Done."));
+	// Complete or discard config writes that a reset interrupted
+	recoverAtomicFile("config/wlan.cfg");
+	recoverAtomicFile("config/channels.cfg");
 
 #if defined(ESP8266)
 	Serial.print(F("Reading wlan config from SD card..."));
@@ -749,7 +594,8 @@ void AquaControl::init()
 	ArduinoOTA.setPassword("aquarium123"); // Change this for security!
 
 	ArduinoOTA.onStart([]()
-					   { Serial.println(F("\nOTA: Starting update...")); });
+					   { Serial.println(F("\nOTA: Starting update..."));
+						 _aqc->flushSchedules(); });
 	ArduinoOTA.onEnd([]()
 					 { Serial.println(F("\nOTA: Update complete!")); });
 	ArduinoOTA.onProgress([](unsigned int progress, unsigned int total)
@@ -781,41 +627,66 @@ void AquaControl::init()
 	}
 	Serial.println(" Done.");
 
+#if defined(USE_WEBSERVER) && defined(USE_FLASH_ASSET_CACHE)
+	Serial.println(F("Mirroring web assets to flash..."));
+	_AssetCache.begin();
+#endif
+
 #if defined(USE_WEBSERVER)
 	Serial.print(F("Initializing Webserver..."));
+	_Server.collectHeaders(_CollectedHeaders, sizeof(_CollectedHeaders) / sizeof(_CollectedHeaders[0]));
+#if defined(USE_HTTP_KEEPALIVE)
+	_Server.enableKeepAlive(true);
+#endif
+	// Counts requests and connection reuse for /api/debug
+	_Server.addHook([](const String &, const String &, WiFiClient *client, ESP8266WebServer::ContentTypeFunction)
+					{
+		noteHttpRequest(client);
+		return ESP8266WebServer::CLIENT_REQUEST_CAN_CONTINUE; });
 	_Server.begin();
 
 	// Main entry point
-	_Server.on("/", handleRoot);
+	onRoute("/", HTTP_ANY, handleRoot);
 
 	// File upload endpoint
-	_Server.on("/upload", HTTP_POST, handleUploadComplete, handleUpload);
+	onRoute("/upload", HTTP_POST, handleUploadComplete, handleUpload);
 
 	// JSON API endpoints
-	_Server.on("/api/status", HTTP_GET, handleApiStatus);
-	_Server.on("/api/schedule/get", HTTP_GET, handleApiScheduleGet);
-	_Server.on("/api/schedule/all", HTTP_GET, handleApiScheduleAll);
-	_Server.on("/api/schedule/save", HTTP_POST, handleApiScheduleSave);
-	_Server.on("/api/schedule/clear", HTTP_POST, handleApiScheduleClear);
-	_Server.on("/api/schedule/target/add", HTTP_POST, handleApiTargetAdd);
-	_Server.on("/api/schedule/target/delete", HTTP_POST, handleApiTargetDelete);
-	_Server.on("/api/test/start", HTTP_POST, handleApiTestStart);
-	_Server.on("/api/test/update", HTTP_POST, handleApiTestUpdate);
-	_Server.on("/api/test/exit", HTTP_POST, handleApiTestExit);
-	_Server.on("/api/macro/list", HTTP_GET, handleApiMacroList);
-	_Server.on("/api/macro/get", HTTP_GET, handleApiMacroGet);
-	_Server.on("/api/macro/save", HTTP_POST, handleApiMacroSave);
-	_Server.on("/api/macro/activate", HTTP_POST, handleApiMacroActivate);
-	_Server.on("/api/macro/stop", HTTP_POST, handleApiMacroStop);
-	_Server.on("/api/macro/delete", HTTP_POST, handleApiMacroDelete);
-	_Server.on("/api/reboot", HTTP_POST, handleApiReboot);
-	_Server.on("/api/debug", HTTP_GET, handleApiDebug);
-	_Server.on("/api/time/set", HTTP_POST, handleApiTimeSet);
-	_Server.on("/api/config/channels", HTTP_GET, handleApiChannelConfigGet);
-	_Server.on("/api/config/channels", HTTP_POST, handleApiChannelConfigSave);
+	onRoute("/api/status", HTTP_GET, handleApiStatus);
+	onRoute("/api/bootstrap", HTTP_GET, handleApiBootstrap);
+#if defined(USE_SERVER_SENT_EVENTS)
+	onRoute("/api/events", HTTP_GET, handleApiEvents);
+#endif
+	onRoute("/api/schedule/get", HTTP_GET, handleApiScheduleGet);
+	onRoute("/api/schedule/all", HTTP_GET, handleApiScheduleAll);
+	onRoute("/api/schedule/save", HTTP_POST, handleApiScheduleSave);
+	onRoute("/api/schedule/clear", HTTP_POST, handleApiScheduleClear);
+	onRoute("/api/schedule/export", HTTP_GET, handleApiScheduleExport);
+	onRoute("/api/schedule/target/add", HTTP_POST, handleApiTargetAdd);
+	onRoute("/api/schedule/target/delete", HTTP_POST, handleApiTargetDelete);
+	onRoute("/api/schedule/batch", HTTP_POST, handleApiScheduleBatch);
+	onRoute("/api/test/start", HTTP_POST, handleApiTestStart);
+	onRoute("/api/test/update", HTTP_POST, handleApiTestUpdate);
+	onRoute("/api/test/exit", HTTP_POST, handleApiTestExit);
+	onRoute("/api/macro/list", HTTP_GET, handleApiMacroList);
+	onRoute("/api/macro/get", HTTP_GET, handleApiMacroGet);
+	onRoute("/api/macro/save", HTTP_POST, handleApiMacroSave);
+	onRoute("/api/macro/activate", HTTP_POST, handleApiMacroActivate);
+	onRoute("/api/macro/stop", HTTP_POST, handleApiMacroStop);
+	onRoute("/api/macro/delete", HTTP_POST, handleApiMacroDelete);
+	onRoute("/api/macro/reindex", HTTP_POST, handleApiMacroReindex);
+	onRoute("/api/macro/favorite", HTTP_POST, handleApiMacroFavorite);
+	onRoute("/api/reboot", HTTP_POST, handleApiReboot);
+	onRoute("/api/debug", HTTP_GET, handleApiDebug);
+	onRoute("/api/time/set", HTTP_POST, handleApiTimeSet);
+	onRoute("/api/config/channels", HTTP_GET, handleApiChannelConfigGet);
+	onRoute("/api/config/channels", HTTP_POST, handleApiChannelConfigSave);
 
 	_Server.onNotFound(handleNotFound);
 	_Server.begin();
+#if defined(USE_TEST_CONTROL)
+	_TestControl.begin();
+#endif
 	Serial.println(F(" Done."));
 #else
 	Serial.println(F("Webserver is deactivated."));
@@ -835,6 +706,10 @@ void AquaControl::init()
 		Serial.println(F(" Done."));
 	}
 
+	Serial.println(F("Reading macro index from SD card..."));
+	_MacroIndex.begin();
+	_MacroCache.warm();
+
 #if defined(USE_DS18B20_TEMP_SENSOR)
 	Serial.print(F("Initializing DS18B20 Temerature Sensor..."));
 	if (!_Temperature.init(CurrentSecOfDay))
@@ -851,13 +726,14 @@ void AquaControl::init()
 
 bool AquaControl::addChannelTarget(uint8_t channel, Target target)
 {
-	if (channel > PWM_CHANNELS)
+	if (channel >= PWM_CHANNELS)
 	{
 		return false;
 	}
 	else
 	{
-		uint8_t pos = _PwmChannels[channel].addTarget(target);
+		uint8_t pos = editSchedule(channel, true)->add(target);
+		publishSchedule(channel);
 		Serial.print(F("Added target at position "));
 		Serial.print(pos);
 		Serial.print(F(" of channel "));
@@ -866,6 +742,27 @@ bool AquaControl::addChannelTarget(uint8_t channel, Target target)
 	}
 }
 
+ScheduleSnapshot *AquaControl::editSchedule(uint8_t channel, bool keepTargets)
+{
+	_SpareSchedule->Count = 0;
+	if (keepTargets)
+	{
+		const ScheduleSnapshot *live = _PwmChannels[channel].Schedule;
+		memcpy(_SpareSchedule->Targets, live->Targets, live->Count * sizeof(Target));
+		_SpareSchedule->Count = live->Count;
+	}
+	return _SpareSchedule;
+}
+
+void AquaControl::publishSchedule(uint8_t channel)
+{
+	// The engine sees the old targets or the new ones, never a schedule in between
+	ScheduleSnapshot *replaced = _PwmChannels[channel].Schedule;
+	_PwmChannels[channel].Schedule = _SpareSchedule;
+	_SpareSchedule = replaced;
+	_PwmChannels[channel].Version++;
+}
+
 void AquaControl::proceedCycle()
 {
 	uint8_t cycle = 0;
@@ -880,23 +777,25 @@ void AquaControl::proceedCycle()
 
 	// Check macro expiration (non-blocking timer)
 #if defined(USE_WEBSERVER)
-	if (_activeMacro.active && getMacroTimeRemaining() == 0)
-	{
-		restoreSchedule();
-	}
-
-	// Use macro-relative time when a macro is active; otherwise use 24h schedule time
-	time_t timeReference = CurrentSecOfDay;
-	if (_activeMacro.active)
+	for (uint8_t i = 0; i < MACRO_OVERLAYS; i++)
 	{
-		timeReference = now() - _activeMacro.startTime;
+		if (_Overlays[i].Slot && getMacroTimeRemaining(_Overlays[i]) == 0)
+		{
+			Serial.print(F("✅ Macro auto-restored: "));
+			Serial.println(_Overlays[i].MacroId);
+			endMacro(_Overlays[i]);
+		}
 	}
-#else
-	time_t timeReference = CurrentSecOfDay;
 #endif
 
 	for (cycle = 0; cycle < PWM_CHANNELS; cycle++)
 	{
+		// Channels of a running macro use macro-relative time, the others the 24h schedule time
+		time_t timeReference = CurrentSecOfDay;
+		if (_PwmChannels[cycle].OverlayRecords)
+		{
+			timeReference = now() - _PwmChannels[cycle].OverlayStart;
+		}
 		_PwmChannels[cycle].proceedCycle(timeReference, CurrentMilli);
 		if (_PwmChannels[cycle].HasToWritePwm || _IsFirstCycle)
 		{
@@ -907,14 +806,39 @@ void AquaControl::proceedCycle()
 
 #if defined(USE_WEBSERVER)
 	// Hande the Webserver features
+	uint32_t serviceStart = micros();
+#if defined(USE_TEST_CONTROL)
+	// Slider frames first, they are applied by the channels in the next cycle
+	_TestControl.pump();
+#endif
 	_Server.handleClient();
+	_Arena.reset(); // Release all scratch memory of the handled request at once
+	// Long responses continue with one slice per cycle
+	_Jobs.pump();
+	_Arena.reset();
+#if defined(USE_SERVER_SENT_EVENTS)
+	// Push coalesced changes to the event stream subscribers
+	_Events.pump();
+	_Arena.reset();
+#endif
+	_Jobs.noteServiceTime(micros() - serviceStart);
+	// Persist settled schedule edits while no response is streamed. Macros do not touch the schedules,
+	// so this goes on while they run.
+	if (_ScheduleStore.pending() && _Jobs.active() == 0)
+	{
+		HEAP_SCOPE(HeapScopeSdConfig);
+		_ScheduleStore.pump(_PwmChannels, SCHEDULE_STORE_CHANNELS);
+	}
 	yield(); // Prevent watchdog reset
 #endif
 
 #if defined(USE_DS18B20_TEMP_SENSOR)
 	if (_Temperature.Status)
 	{
-		_Temperature.readTemperature(CurrentSecOfDay);
+		if (_Temperature.readTemperature(CurrentSecOfDay))
+		{
+			notifyChange(ChangeTemperature);
+		}
 	}
 	else
 	{
@@ -1021,88 +945,128 @@ void AquaControl::writePwmToDevice(uint8_t channel)
 #else
 	analogWrite(_PwmChannels[channel].ChannelAddress, _PwmChannels[channel].CurrentWriteValue);
 #endif
+	notifyChange(ChangeOutputs);
 }
 
-#if defined(ESP8266)
-IPAddress AquaControl::extractIPAddress(const String &sIP)
-{
-	// Create local mutable copy to avoid const-correctness violation
-	String temp = sIP;
-	uint32_t ip = 0;
-	int8_t iIndex = 0;
-	while ((iIndex = temp.lastIndexOf(".")) != -1)
-	{
-		uint8_t singleVal = temp.substring(iIndex + 1).toInt();
-		ip |= singleVal;
-		ip = ip << 8;
-		// Remove the leading dot by truncating string
-		temp = temp.substring(0, iIndex);
-	}
-	ip |= temp.substring(0).toInt();
-	return IPAddress(ip);
-}
-#endif
-
-uint8_t PwmChannel::addTarget(Target t)
+uint8_t ScheduleSnapshot::add(Target t)
 {
 
-	if (TargetCount >= MAX_TARGET_COUNT_PER_CHANNEL)
+	if (Count >= MAX_TARGET_COUNT_PER_CHANNEL)
 	{
 		return -1;
 	}
 	else
 	{
 		time_t newTargetTime = elapsedSecsToday(t.Time);
-		for (uint8_t i = 0; i < TargetCount - 1; i++)
+		for (uint8_t i = 0; i < Count; i++)
 		{
 			time_t currentTime = elapsedSecsToday(Targets[i].Time);
 			if (newTargetTime < currentTime)
 			{
 				// We have to put in the new target before the current one to keep the right time order
 				// First move all following targets one slot to right
-				for (uint8_t n = TargetCount; n > i; n--)
+				for (uint8_t n = Count; n > i; n--)
 				{
 					Targets[n] = Targets[n - 1];
 				}
 				// Now insert the new target
 				Targets[i] = t;
-				TargetCount++;
+				Count++;
 				return i;
 			}
 		}
 		// If no target was inserted, the the new target must be placed at the end of the list
-		Targets[TargetCount] = t;
-		TargetCount++;
-		return TargetCount;
+		Targets[Count] = t;
+		Count++;
+		return Count;
 	}
 }
 
-bool PwmChannel::removeTargetAt(uint8_t pos)
+bool ScheduleSnapshot::removeAt(uint8_t pos)
 {
-	if (pos >= TargetCount)
+	if (pos >= Count)
 	{
 		return false;
 	}
-	else if (pos == (TargetCount - 1))
+	for (uint8_t i = pos; i < (Count - 1); i++)
 	{
-		TargetCount--;
-		return true;
+		Targets[i] = Targets[i + 1];
 	}
-	else
+	Count--;
+	return true;
+}
+
+uint8_t ScheduleSnapshot::set(Target t)
+{
+	removeAtTime(t.Time);
+	return add(t);
+}
+
+bool ScheduleSnapshot::removeAtTime(time_t time)
+{
+	for (uint8_t i = 0; i < Count; i++)
 	{
-		for (uint8_t i = pos; i < (TargetCount - 1); i++)
+		if (Targets[i].Time == time)
 		{
-			Targets[i] = Targets[i + 1];
+			return removeAt(i);
 		}
-		TargetCount--;
-		return true;
 	}
+	return false;
+}
+
+uint8_t PwmChannel::addTarget(Target t)
+{
+	uint8_t pos = Schedule->add(t);
+	if (pos != (uint8_t)-1)
+	{
+		Version++;
+	}
+	return pos;
+}
+
+bool PwmChannel::removeTargetAt(uint8_t pos)
+{
+	if (!Schedule->removeAt(pos))
+	{
+		return false;
+	}
+	Version++;
+	return true;
+}
+
+uint8_t PwmChannel::setTarget(Target t)
+{
+	removeTargetAtTime(t.Time);
+	return addTarget(t);
+}
+
+bool PwmChannel::removeTargetAtTime(time_t time)
+{
+	if (!Schedule->removeAtTime(time))
+	{
+		return false;
+	}
+	Version++;
+	return true;
+}
+
+Target PwmChannel::playedTarget(uint8_t pos) const
+{
+	if (!OverlayRecords)
+	{
+		return Schedule->Targets[pos];
+	}
+	Target t;
+	t.Time = OverlayRecords[pos] >> 8;
+	t.Value = OverlayRecords[pos] & 0xFF;
+	return t;
 }
 
 #define PWM_MIN 1
 void PwmChannel::proceedCycle(time_t currentSecOfDay, time_t currentMilliOfSec)
 {
-	if (TargetCount > 0)
+	uint8_t count = playedCount();
+	if (count > 0)
 	{
 		HasToWritePwm = false;
 		CurrentSecOfDay = currentSecOfDay;
@@ -1113,33 +1077,34 @@ void PwmChannel::proceedCycle(time_t currentSecOfDay, time_t currentMilliOfSec)
 		bool bTargetFound = false;
 
 		// if only one target is set
-		if (TargetCount == 1)
+		if (count == 1)
 		{
 			// then we have a constant value from 00:00:00 until 23:59:59
-			currentTarget.Time = (60 * 60 * 24);					   // End of the day
-			currentTarget.Value = lastTarget.Value = Targets[0].Value; // Take the constant value
-			lastTarget.Time = 0;									   // start of day
+			currentTarget.Time = (60 * 60 * 24);							// End of the day
+			currentTarget.Value = lastTarget.Value = playedTarget(0).Value; // Take the constant value
+			lastTarget.Time = 0;											// start of day
 		}
 		else
 		{
 			// find the current and last target
-			for (uint8_t t = 0; t < TargetCount; t++)
+			for (uint8_t t = 0; t < count; t++)
 			{
-				if (Targets[t].Time > CurrentSecOfDay)
+				Target target = playedTarget(t);
+				if (target.Time > CurrentSecOfDay)
 				{
-					currentTarget = Targets[t];
+					currentTarget = target;
 					bTargetFound = true;
 					// if it is the first timer event of the day
 					if (t == 0)
 					{
 						// then take the value from the last timer in the pool and calculate the relative time of the day
-						lastTarget.Time = 0 - ((60 * 60 * 24) - Targets[TargetCount - 1].Time);
-						lastTarget.Value = Targets[TargetCount - 1].Value;
+						lastTarget.Time = 0 - ((60 * 60 * 24) - playedTarget(count - 1).Time);
+						lastTarget.Value = playedTarget(count - 1).Value;
 					}
 					else
 					{
 						// simply take the previous target
-						lastTarget = Targets[t - 1];
+						lastTarget = playedTarget(t - 1);
 					}
 					break;
 				}
@@ -1148,9 +1113,9 @@ void PwmChannel::proceedCycle(time_t currentSecOfDay, time_t currentMilliOfSec)
 			if (!bTargetFound)
 			{
 				// take the first target of the next day (simply the first target in the pool)
-				currentTarget = Targets[0];
+				currentTarget = playedTarget(0);
 				// take the last target of the current day
-				lastTarget = Targets[TargetCount - 1];
+				lastTarget = playedTarget(count - 1);
 				// and now correct the time, because the new target is at the next day. So we have to add the remaining time of the current day
 				currentTarget.Time = currentTarget.Time + (60 * 60 * 24) - lastTarget.Time;
 			}
@@ -1185,6 +1150,8 @@ void PwmChannel::proceedCycle(time_t currentSecOfDay, time_t currentMilliOfSec)
 			if (TestModeSetTime < (_aqc->CurrentSecOfDay - 60) || TestModeSetTime > _aqc->CurrentSecOfDay)
 			{
 				TestMode = false;
+				TestInstant = false;
+				_aqc->notifyChange(ChangeTestMode);
 			}
 		}
 		else
@@ -1197,7 +1164,12 @@ void PwmChannel::proceedCycle(time_t currentSecOfDay, time_t currentMilliOfSec)
 		if (_PwmTarget != _PwmValue)
 		{
 			HasToWritePwm = true;
-			if (_PwmTarget > _PwmValue)
+			if (TestMode && TestInstant)
+			{
+				// Live adjustment over the test control channel follows the slider without delay
+				_PwmValue = _PwmTarget;
+			}
+			else if (_PwmTarget > _PwmValue)
 			{
 				_PwmValue += PWM_STEP;
 				if (_PwmTarget > _PwmValue + 100)
@@ -1244,116 +1216,103 @@ void PwmChannel::proceedCycle(time_t currentSecOfDay, time_t currentMilliOfSec)
 #if defined(USE_WEBSERVER)
 
 // Macro implementation: activateMacro
-bool AquaControl::activateMacro(const String &macroId, uint32_t duration)
+MacroActivation AquaControl::activateMacro(const String &macroId, uint32_t duration)
 {
-	// Check if macro is already active
-	if (_activeMacro.active)
-	{
-		Serial.println(F("❌ Macro already active"));
-		return false;
-	}
-
+	HEAP_SCOPE(HeapScopeMacro);
 	// Guard against zero duration
 	if (duration == 0)
 	{
 		Serial.println(F("❌ Invalid macro duration: 0"));
-		return false;
+		return MacroInvalid;
 	}
 
-	// Backup current schedules to restore later
-	for (uint8_t ch = 0; ch < PWM_CHANNELS; ch++)
+	const MacroIndexEntry *entry = _MacroIndex.find(macroId.c_str());
+	if (!entry)
+	{
+		Serial.println(F("❌ Macro not found"));
+		return MacroInvalid;
+	}
+	// The macro takes over the channels it defines, they must be free
+	uint16_t mask = entry->ChannelMask & (uint16_t)((1UL << PWM_CHANNELS) - 1);
+	if (mask == 0)
+	{
+		Serial.println(F("❌ Macro has no channels"));
+		return MacroInvalid;
+	}
+	// Activating a running macro again restarts it
+	MacroOverlay *overlay = nullptr;
+	MacroOverlay *running = nullptr;
+	for (uint8_t i = 0; i < MACRO_OVERLAYS; i++)
 	{
-		_activeMacro.originalTargetCounts[ch] = _PwmChannels[ch].TargetCount;
-		for (uint8_t t = 0; t < _PwmChannels[ch].TargetCount; t++)
+		if (!_Overlays[i].Slot)
+		{
+			overlay = overlay ? overlay : &_Overlays[i];
+		}
+		else if (strcmp(_Overlays[i].MacroId, macroId.c_str()) == 0)
 		{
-			_activeMacro.originalTargets[ch][t] = _PwmChannels[ch].Targets[t];
+			running = &_Overlays[i];
+		}
+		else if (_Overlays[i].ChannelMask & mask)
+		{
+			Serial.print(F("❌ Macro shares channels with running macro "));
+			Serial.println(_Overlays[i].MacroId);
+			return MacroConflict;
 		}
 	}
+	if (!overlay && !running)
+	{
+		Serial.println(F("❌ Too many macros running"));
+		return MacroNoRoom;
+	}
 
-	// Load macro targets from SD card for each channel
-	for (uint8_t ch = 0; ch < PWM_CHANNELS; ch++)
+	if (running)
 	{
-		char sTempFilename[50];
-		sprintf(sTempFilename, "macros/%s_ch%02d.cfg", macroId.c_str(), ch);
+		// The old run lets go of its slot first. A macro saved since it was started needs a slot for the
+		// new version, and with every other slot pinned that is the one of the old run.
+		endMacro(*running);
+		overlay = running;
+	}
 
-		// If macro file exists for this channel, load it
-		if (SD.exists(sTempFilename))
+	// The targets are played from the cache slot, a miss reads the whole macro file into it first
+	const MacroCacheSlot *slot = _MacroCache.acquire(macroId.c_str());
+	if (!slot)
+	{
+		Serial.println(F("❌ Macro file invalid or too large"));
+		return MacroInvalid;
+	}
+	// Channels without targets keep following their schedules
+	mask &= slot->ChannelMask;
+	for (uint8_t ch = 0; ch < PWM_CHANNELS; ch++)
+	{
+		if (slot->Counts[ch] == 0)
 		{
-			// Clear existing targets for this channel
-			_PwmChannels[ch].TargetCount = 0;
-
-			// Open and parse macro file
-			File macroFile = SD.open(sTempFilename);
-			if (macroFile)
-			{
-				// Use char buffer to avoid heap fragmentation (matches computeMacroDuration pattern)
-				char lineBuf[64];
-				while (macroFile.available())
-				{
-					int len = macroFile.readBytesUntil('\n', lineBuf, sizeof(lineBuf) - 1);
-					if (len == 0)
-						continue;
-					lineBuf[len] = '\0';
-
-					// Strip CR if present
-					if (len > 0 && lineBuf[len - 1] == '\r')
-					{
-						lineBuf[len - 1] = '\0';
-						len--;
-					}
-
-					// Skip empty lines or comments
-					if (len == 0 || (lineBuf[0] == '/' && lineBuf[1] == '/'))
-						continue;
-
-					// Find semicolon separator
-					char *semi = strchr(lineBuf, ';');
-					if (!semi)
-						continue;
-
-					// Parse time from start to semicolon
-					long timeVal = 0;
-					char *colon = strchr(lineBuf, ':');
-					if (colon && colon < semi)
-					{
-						// MM:SS format
-						*colon = '\0';
-						timeVal = atoi(lineBuf) * 60 + atoi(colon + 1);
-					}
-					else
-					{
-						// Seconds format
-						timeVal = atoi(lineBuf);
-					}
-
-					// Parse value after semicolon
-					int value = atoi(semi + 1);
-					value = max(0, min(100, value));
-
-					Target t;
-					t.Time = timeVal;
-					t.Value = (uint8_t)value;
-					_PwmChannels[ch].addTarget(t);
-				}
-				macroFile.close();
-				_PwmChannels[ch].HasToWritePwm = true; // Force PWM update
-			}
+			mask &= ~(1 << ch);
 		}
-		else
+	}
+	if (mask == 0)
+	{
+		_MacroCache.release(slot);
+		Serial.println(F("❌ Macro has no targets"));
+		return MacroInvalid;
+	}
+	overlay->Slot = slot;
+	overlay->StartTime = now();
+	overlay->Duration = duration;
+	overlay->ChannelMask = mask;
+	strncpy(overlay->MacroId, macroId.c_str(), sizeof(overlay->MacroId) - 1);
+	overlay->MacroId[sizeof(overlay->MacroId) - 1] = '\0';
+
+	// Switch the channels of the macro over, the others keep running their schedules
+	for (uint8_t ch = 0; ch < PWM_CHANNELS; ch++)
+	{
+		if (overlay->ChannelMask & (1 << ch))
 		{
-			// If macro file doesn't exist for this channel, clear it
-			_PwmChannels[ch].TargetCount = 0;
-			_PwmChannels[ch].HasToWritePwm = true;
+			_PwmChannels[ch].OverlayRecords = slot->Records + slot->First[ch];
+			_PwmChannels[ch].OverlayCount = slot->Counts[ch];
+			_PwmChannels[ch].OverlayStart = overlay->StartTime;
 		}
 	}
 
-	// Set macro state
-	_activeMacro.active = true;
-	_activeMacro.startTime = now();
-	_activeMacro.duration = duration;
-	strncpy(_activeMacro.macroId, macroId.c_str(), 19);
-	_activeMacro.macroId[19] = '\0';
-
 	_IsFirstCycle = true; // Force immediate PWM updates
 
 	Serial.print(F("🎬 Macro activated: "));
@@ -1362,54 +1321,108 @@ bool AquaControl::activateMacro(const String &macroId, uint32_t duration)
 	Serial.print(duration);
 	Serial.println(F("s"));
 
-	return true;
+	notifyChange(ChangeMacro);
+	return MacroActivated;
 }
 
-// Macro implementation: restoreSchedule
-void AquaControl::restoreSchedule()
+// Macro implementation: endMacro
+void AquaControl::endMacro(MacroOverlay &overlay)
 {
-	if (!_activeMacro.active)
+	if (!overlay.Slot)
 	{
 		return;
 	}
 
-	// Restore original targets for all channels
+	// The channels play their schedules again, nothing has to be copied back
 	for (uint8_t ch = 0; ch < PWM_CHANNELS; ch++)
 	{
-		_PwmChannels[ch].TargetCount = _activeMacro.originalTargetCounts[ch];
-		for (uint8_t t = 0; t < _activeMacro.originalTargetCounts[ch]; t++)
+		if (overlay.ChannelMask & (1 << ch))
 		{
-			_PwmChannels[ch].Targets[t] = _activeMacro.originalTargets[ch][t];
+			_PwmChannels[ch].OverlayRecords = nullptr;
+			_PwmChannels[ch].OverlayCount = 0;
 		}
-		_PwmChannels[ch].HasToWritePwm = true; // Force PWM update
 	}
+	_MacroCache.release(overlay.Slot);
 
 	// Clear macro state
-	_activeMacro.active = false;
-	_activeMacro.startTime = 0;
-	_activeMacro.duration = 0;
-	_activeMacro.macroId[0] = '\0';
+	overlay.Slot = nullptr;
+	overlay.ChannelMask = 0;
+	overlay.MacroId[0] = '\0';
 
 	_IsFirstCycle = true; // Force immediate PWM updates
+	notifyChange(ChangeMacro);
+}
+
+// Macro implementation: restoreSchedule
+void AquaControl::restoreSchedule()
+{
+	for (uint8_t i = 0; i < MACRO_OVERLAYS; i++)
+	{
+		endMacro(_Overlays[i]);
+	}
+}
+
+// Macro implementation: stopMacro
+bool AquaControl::stopMacro(const char *macroId)
+{
+	for (uint8_t i = 0; i < MACRO_OVERLAYS; i++)
+	{
+		if (_Overlays[i].Slot && strcmp(_Overlays[i].MacroId, macroId) == 0)
+		{
+			endMacro(_Overlays[i]);
+			return true;
+		}
+	}
+	return false;
+}
 
-	Serial.println(F("✅ Macro auto-restored"));
+uint8_t AquaControl::activeMacroCount() const
+{
+	uint8_t n = 0;
+	for (uint8_t i = 0; i < MACRO_OVERLAYS; i++)
+	{
+		if (_Overlays[i].Slot)
+		{
+			n++;
+		}
+	}
+	return n;
+}
+
+const MacroOverlay *AquaControl::activeMacro() const
+{
+	const MacroOverlay *last = nullptr;
+	for (uint8_t i = 0; i < MACRO_OVERLAYS; i++)
+	{
+		if (_Overlays[i].Slot && (!last || getMacroTimeRemaining(_Overlays[i]) > getMacroTimeRemaining(*last)))
+		{
+			last = &_Overlays[i];
+		}
+	}
+	return last;
 }
 
 // Macro implementation: getMacroTimeRemaining
-uint32_t AquaControl::getMacroTimeRemaining() const
+uint32_t AquaControl::getMacroTimeRemaining(const MacroOverlay &overlay) const
 {
-	if (!_activeMacro.active)
+	if (!overlay.Slot)
 	{
 		return 0;
 	}
 
-	uint32_t elapsed = now() - _activeMacro.startTime;
-	if (elapsed >= _activeMacro.duration)
+	uint32_t elapsed = now() - overlay.StartTime;
+	if (elapsed >= overlay.Duration)
 	{
 		return 0;
 	}
 
-	return _activeMacro.duration - elapsed;
+	return overlay.Duration - elapsed;
+}
+
+uint32_t AquaControl::getMacroTimeRemaining() const
+{
+	const MacroOverlay *last = activeMacro();
+	return last ? getMacroTimeRemaining(*last) : 0;
 }
 
 #endif
@@ -13,6 +13,7 @@ Copyright 2016
 #define __AQUACONTROL_H_
 
 #include "AquaControl_config.h"
+#include "HeapTracker.h"
 
 #define AQC_VERSION "0.5"
 #define AQC_BUILD "0.5.001"
@@ -45,10 +46,44 @@ Copyright 2016
 // This is for the sd card modul
 #include <SPI.h>
 #include <SD.h>
+#include "AtomicFile.h"
+#include "ConfigReader.h"
+#include "ScheduleStore.h"
+#include "MacroFile.h"
+#include "MacroIndex.h"
+#include "MacroCache.h"
 
 #include <TimeLib.h>
 
 #if defined(USE_WEBSERVER)
+#include "RequestArena.h"
+#include "PageTemplate.h"
+#include "AssetCache.h"
+#include "ResponseJob.h"
+#include "EventStream.h"
+#include "TestControl.h"
+#include "CborWriter.h"
+
+// Builds the /api/status JSON (also the snapshot event of /api/events), returns its length
+#define STATUS_JSON_SIZE 448
+size_t formatStatusJson(char *json, size_t size);
+
+// The /api/status JSON pre-serialized, rebuilt at most once per second or after a notified change
+struct StatusSnapshot
+{
+	char Json[STATUS_JSON_SIZE];
+	uint16_t Length = 0;
+	uint32_t Version = 0; // Increases whenever the content changes (clock included), sent as ETag. Starts boot dependent.
+	time_t BuiltAt = 0;	  // now() of the last build
+	bool Dirty = true;	  // A change was notified since the last build
+};
+
+// Returns the status snapshot, rebuilt first if it is outdated
+const StatusSnapshot &currentStatus();
+
+// Counts a parsed request and whether it arrived on a kept-alive connection
+void noteHttpRequest(WiFiClient *client);
+
 // Webserver handlers
 void handleRoot();
 void handleNotFound();
@@ -57,12 +92,18 @@ void handleUploadComplete();
 
 // JSON API handlers
 void handleApiStatus();
+void handleApiBootstrap();
+#if defined(USE_SERVER_SENT_EVENTS)
+void handleApiEvents();
+#endif
 void handleApiScheduleGet();
 void handleApiScheduleAll();
 void handleApiScheduleSave();
 void handleApiScheduleClear();
+void handleApiScheduleExport();
 void handleApiTargetAdd();
 void handleApiTargetDelete();
+void handleApiScheduleBatch();
 void handleApiTestStart();
 void handleApiTestUpdate();
 void handleApiTestExit();
@@ -72,6 +113,8 @@ void handleApiMacroSave();
 void handleApiMacroActivate();
 void handleApiMacroStop();
 void handleApiMacroDelete();
+void handleApiMacroReindex();
+void handleApiMacroFavorite();
 void handleApiReboot();
 void handleApiDebug();
 void handleApiTimeSet();
@@ -152,12 +195,6 @@ void handleApiChannelConfigSave();
 #define PWM_CHANNEL_3 FUNC_GPIO3
 #endif // defined(__AVR__)
 
-typedef struct
-{
-	String Key;
-	String Value;
-} Option;
-
 #if defined(ESP8266)
 enum WlanMode
 {
@@ -168,8 +205,8 @@ enum WlanMode
 typedef struct
 {
 	WlanMode Mode;
-	String SSID;
-	String PW;
+	char SSID[33]; // 32 characters at most (802.11)
+	char PW[65];   // 64 characters at most (WPA2)
 	bool ManualIP;
 	IPAddress IP;
 	IPAddress Gateway;
@@ -184,18 +221,43 @@ typedef struct
 } Target;
 
 #if defined(USE_WEBSERVER)
-/* Macro state tracking for temporary lighting overrides */
+/* A running macro. It drives the channels of its ChannelMask from the targets in its cache slot, the
+   schedules of the channels stay untouched. Macros on disjoint channels run side by side. */
 typedef struct
 {
-	bool active;														// Is a macro currently running?
-	time_t startTime;													// Unix timestamp when macro was activated
-	uint32_t duration;													// Macro duration in seconds
-	char macroId[20];													// Macro identifier (e.g., "macro_001")
-	Target originalTargets[PWM_CHANNELS][MAX_TARGET_COUNT_PER_CHANNEL]; // Backup of original schedules
-	uint8_t originalTargetCounts[PWM_CHANNELS];							// Backup of original target counts
-} MacroState;
+	const MacroCacheSlot *Slot; // Targets of the macro (pinned in _MacroCache), nullptr if the overlay is free
+	time_t StartTime;			// Unix timestamp when the macro was activated
+	uint32_t Duration;			// Macro duration in seconds
+	uint16_t ChannelMask;		// Channels driven by the macro
+	char MacroId[20];			// Macro identifier (e.g., "macro_001")
+} MacroOverlay;
+
+enum MacroActivation : uint8_t
+{
+	MacroActivated,
+	MacroInvalid,  // Unknown, damaged or too large macro, or no duration
+	MacroConflict, // Shares channels with a running macro
+	MacroNoRoom	   // MACRO_OVERLAYS macros are running
+};
 #endif
 
+/* The targets of a channel in time order. A snapshot the engine plays is not changed any more, edits are
+   made in the spare snapshot and published by swapping the channel's pointer (AquaControl::editSchedule). */
+class ScheduleSnapshot
+{
+public:
+	Target Targets[MAX_TARGET_COUNT_PER_CHANNEL];
+	uint8_t Count = 0;
+
+	uint8_t add(Target t); // Inserts a new target in time order and gives back the position
+
+	bool removeAt(uint8_t pos); // Removes the target at the specified position
+
+	uint8_t set(Target t); // Like add, but replaces a target at the same time
+
+	bool removeAtTime(time_t time); // Removes the target at the specified time, false if there is none
+};
+
 class PwmChannel
 {
 private:
@@ -204,26 +266,46 @@ private:
 
 public:
 	uint8_t ChannelAddress; // Contains the address or pin for setting the pwm value
-	Target Targets[MAX_TARGET_COUNT_PER_CHANNEL];
-	uint8_t TargetCount;
+	ScheduleSnapshot *Schedule;		// Published targets, replaced as a whole by AquaControl::publishSchedule
+	const uint32_t *OverlayRecords; // Targets of a running macro (time << 8 | value), played instead of the schedule if set
+	uint8_t OverlayCount;
+	time_t OverlayStart; // Unix timestamp the macro target times count from
+	uint32_t Version; // Increases with every change of the targets, used as validator (ETag)
 	uint16_t CurrentWriteValue;
 	bool HasToWritePwm; // Indecates, that a new pwm values has to be written to the pwm device
 	bool TestMode;
 	time_t TestModeSetTime;
 	uint8_t TestValue;
+	bool TestInstant; // Jump to TestValue instead of fading with PWM_STEP (live adjustment)
 	time_t CurrentSecOfDay;
 	time_t CurrentMilli;
 
 	PwmChannel()
 	{
 		TestMode = false;
+		TestInstant = false;
+		Version = 0;
+		Schedule = nullptr;
+		OverlayRecords = nullptr;
+		OverlayCount = 0;
 	}
 
+	// Edits of the published snapshot in place, for loading schedules before the first cycle. At run time the
+	// edits go through AquaControl::editSchedule.
 	uint8_t addTarget(Target t); // Inserts a new target (time and value for the channel) and gives back the position.
 
 	bool removeTargetAt(uint8_t pos); // Removes the target at the specified position
 
+	uint8_t setTarget(Target t); // Like addTarget, but replaces a target at the same time
+
+	bool removeTargetAtTime(time_t time); // Removes the target at the specified time, false if there is none
+
 	void proceedCycle(time_t currentSecOfDay, time_t currentMilliOfSec); // the main function for each step. Here the pwm value will be calculated
+
+private:
+	// The targets that are played, the macro overlay if one is set, else the schedule
+	uint8_t playedCount() const { return OverlayRecords ? OverlayCount : Schedule->Count; }
+	Target playedTarget(uint8_t pos) const;
 };
 
 #if defined(USE_DS18B20_TEMP_SENSOR)
@@ -265,6 +347,17 @@ enum class TimeSyncSource
 	Api		 // Time manually set via /api/time/set
 };
 
+// Change notifications for push clients (see EventStream)
+enum AquaChange : uint8_t
+{
+	ChangeOutputs = 0x01,	  // A pwm output value was written
+	ChangeMacro = 0x02,		  // Macro started, stopped or expired
+	ChangeTimeSync = 0x04,	  // Time was synchronized (or lost its source)
+	ChangeTemperature = 0x08, // New temperature reading
+	ChangeTestMode = 0x10,	  // Test mode entered or left
+	ChangeAll = 0x1F
+};
+
 class AquaControl
 {
 public:
@@ -286,11 +379,16 @@ public:
 	// Read ant write the Wlan configuration
 	bool readWlanConfig();
 	bool writeWlanConfig();
-	// Read and write led configuration
+	// Read led configuration, scheduleChanged() has the store written after a schedule was replaced
 	bool readLedConfig();
-	bool writeLedConfig(uint8_t pwmChannel);
-	// Helper: Write targets to file with given path (reusable for schedules and macros)
-	bool writeTargetsToFile(const String &pathPrefix, uint8_t channel, PwmChannel &pwmChannel);
+	void scheduleChanged();
+	// Loads a channel from its text file (config/ledch_NN.cfg), used to migrate and import schedules
+	bool importLedConfig(uint8_t channel);
+	// Single target edits, applied and appended to the schedule journal
+	bool setScheduleTarget(uint8_t channel, Target target);
+	bool removeScheduleTarget(uint8_t channel, time_t time);
+	// Persists pending schedule edits now instead of waiting for the quiet period
+	bool flushSchedules();
 #endif
 
 	// Initializes the time synch mechanisim (RTC or NTP)
@@ -298,52 +396,88 @@ public:
 
 	uint8_t getPhysicalChannelAddress(uint8_t channelNumber);
 
-	PwmChannel _PwmChannels[PWM_CHANNELS]; // Stores the PWM chanels
-	bool _IsFirstCycle;					   // Indicates, that we have not set any pwm value
+	PwmChannel _PwmChannels[PWM_CHANNELS];			// Stores the PWM chanels
+	ScheduleSnapshot _Schedules[PWM_CHANNELS + 1];	// Target storage of the channels plus the spare snapshot
+	ScheduleSnapshot *_SpareSchedule;				// The snapshot edits are made in, see editSchedule
+	bool _IsFirstCycle;								// Indicates, that we have not set any pwm value
 #if defined(ESP8266)
 	WlanConfig _WlanConfig;
 #endif
 #if defined(USE_WEBSERVER)
-	MacroState _activeMacro; // Current active macro state
+	MacroOverlay _Overlays[MACRO_OVERLAYS]; // Running macros
 #endif
 
 	// Time sync state tracking
 	time_t _LastTimeSync;				// Timestamp of last successful sync
 	TimeSyncSource _LastTimeSyncSource; // Source of last successful sync
 	bool _NtpSyncFailed;				// True if last NTP attempt failed (signals browser to auto-sync)
+	uint8_t _Changes;					// AquaChange flags raised since the event stream last looked
+#if defined(USE_WEBSERVER)
+	StatusSnapshot _Status; // Served by /api/status
+#endif
 
 	AquaControl()
 	{
 		_IsFirstCycle = true;
+		for (uint8_t ch = 0; ch < PWM_CHANNELS; ch++)
+		{
+			_PwmChannels[ch].Schedule = &_Schedules[ch];
+		}
+		_SpareSchedule = &_Schedules[PWM_CHANNELS];
 #if defined(USE_WEBSERVER)
-		_activeMacro.active = false;
-		_activeMacro.startTime = 0;
-		_activeMacro.duration = 0;
-		_activeMacro.macroId[0] = '\0';
+		for (uint8_t i = 0; i < MACRO_OVERLAYS; i++)
+		{
+			_Overlays[i].Slot = nullptr;
+			_Overlays[i].MacroId[0] = '\0';
+		}
 #endif
 		_LastTimeSync = 0;
 		_LastTimeSyncSource = TimeSyncSource::Unknown;
 		_NtpSyncFailed = false;
+		_Changes = 0;
 	}
 
 	void init();
 
 	bool addChannelTarget(uint8_t channel, Target target);
 
+	// Schedule edits at run time: editSchedule() returns the spare snapshot, empty or with a copy of the
+	// channel's targets, publishSchedule() makes it the channel's schedule with one pointer swap. The
+	// replaced snapshot becomes the spare, so one edit is open at a time and is published before the next.
+	ScheduleSnapshot *editSchedule(uint8_t channel, bool keepTargets);
+	void publishSchedule(uint8_t channel);
+
 	void proceedCycle();
 
 	void writePwmToDevice(uint8_t channel);
 
+	// Raises change flags for the event stream (AquaChange)
+	void notifyChange(uint8_t changes)
+	{
+		_Changes |= changes;
+#if defined(USE_WEBSERVER)
+		// Outputs are not part of the status
+		if (changes & ~ChangeOutputs)
+			_Status.Dirty = true;
+#endif
+	}
+
 #if defined(USE_WEBSERVER)
 	/* Macro activation and management */
-	bool activateMacro(const String &macroId, uint32_t duration);
+	MacroActivation activateMacro(const String &macroId, uint32_t duration);
+	// Stops every running macro, the channels return to their schedules
 	void restoreSchedule();
-	bool isMacroActive() const { return _activeMacro.active; }
+	// Stops one running macro, false if it is not running
+	bool stopMacro(const char *macroId);
+	bool isMacroActive() const { return activeMacroCount() > 0; }
+	uint8_t activeMacroCount() const;
+	// The running macro that ends last, nullptr if none runs
+	const MacroOverlay *activeMacro() const;
+	// Seconds until the last running macro ends
 	uint32_t getMacroTimeRemaining() const;
-#endif
-
-#if defined(ESP8266)
-	IPAddress extractIPAddress(const String &sIP);
+	uint32_t getMacroTimeRemaining(const MacroOverlay &overlay) const;
+	// Releases the channels and the cache slot of a running macro
+	void endMacro(MacroOverlay &overlay);
 #endif
 };
 
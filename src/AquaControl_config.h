@@ -1,6 +1,24 @@
 #ifndef _AQUACONTROL_CONFIG_H_
 #define _AQUACONTROL_CONFIG_H_
 
+/* Single target edits are appended to a journal (config/schedule.jnl) instead of rewriting the schedule
+   store. Once the journal reaches this size it is folded into the store. */
+#ifndef SCHEDULE_JOURNAL_COMPACT_BYTES
+#define SCHEDULE_JOURNAL_COMPACT_BYTES 1024
+#endif
+/* Schedule edits are persisted outside the request, once no edit came for SCHEDULE_PERSIST_QUIET_MS
+   or at the latest SCHEDULE_PERSIST_MAX_DELAY_MS after the first pending edit. SCHEDULE_PERSIST_QUEUE
+   single target edits are buffered for one journal append, more of them write the store. */
+#ifndef SCHEDULE_PERSIST_QUIET_MS
+#define SCHEDULE_PERSIST_QUIET_MS 2000
+#endif
+#ifndef SCHEDULE_PERSIST_MAX_DELAY_MS
+#define SCHEDULE_PERSIST_MAX_DELAY_MS 10000
+#endif
+#ifndef SCHEDULE_PERSIST_QUEUE
+#define SCHEDULE_PERSIST_QUEUE 16
+#endif
+
 /* Comment this out to use the on board pins to control the pwm channels.
    When using an ESP8266 then use a levelshifter from 3, 3V to 5V for connecting to a Meanwell LDD700L constant current supply.*/
 #define USE_PCA9685
@@ -16,11 +34,95 @@
 /* Comment this out to not use the web interface functionality */
 #define USE_WEBSERVER
 
+/* Size in bytes of the scratch arena the web handlers use for short-lived strings and buffers.
+   The arena is preallocated once and reset after every handled request. */
+#ifndef REQUEST_ARENA_SIZE
+#define REQUEST_ARENA_SIZE 2048
+#endif
+
+/* Cache lifetime in seconds for static files (js, css, images) served from SD.
+   0 lets the browser revalidate every time, which is answered with 304 via ETag. */
+#ifndef STATIC_CACHE_MAX_AGE
+#define STATIC_CACHE_MAX_AGE 0
+#endif
+
+/* Block size in bytes used to stream static files from SD to the client */
+#ifndef STATIC_STREAM_BLOCK_SIZE
+#define STATIC_STREAM_BLOCK_SIZE 1024
+#endif
+
+/* Comment this out to close the connection after every request. With keep-alive the UI reuses one
+   connection for its polling. The web server serves one client at a time, so at most one connection is
+   kept alive. It is dropped after the idle timeout of the core (HTTP_MAX_CLOSE_WAIT, 2 s) or as soon as
+   another client connects. Responses sent by jobs always close their connection. */
+#define USE_HTTP_KEEPALIVE
+
+/* Comment this out to disable the Server-Sent Events stream (/api/events). The UI then polls /api/status. */
+#define USE_SERVER_SENT_EVENTS
+
+/* Comment this out to disable the WebSocket control channel for test mode. Slider moves are then sent
+   as POST /api/test/update. TEST_CONTROL_PORT is the port of the WebSocket listener. */
+#define USE_TEST_CONTROL
+#ifndef TEST_CONTROL_PORT
+#define TEST_CONTROL_PORT 81
+#endif
+
+/* Long responses are sent by resumable jobs, one slice per loop cycle.
+   RESPONSE_JOB_SLOTS is the number of responses streamed in parallel (each holds a client and a file),
+   RESPONSE_JOB_SLICE_BYTES caps the bytes sent per job and cycle (one TCP segment) and
+   RESPONSE_JOB_TIMEOUT_MS drops clients that stop reading. */
+#ifndef RESPONSE_JOB_SLOTS
+#define RESPONSE_JOB_SLOTS 3
+#endif
+#ifndef RESPONSE_JOB_SLICE_BYTES
+#define RESPONSE_JOB_SLICE_BYTES 1460
+#endif
+#ifndef RESPONSE_JOB_TIMEOUT_MS
+#define RESPONSE_JOB_TIMEOUT_MS 10000
+#endif
+
+/* The macro index (macros/index) holds up to MACRO_INDEX_CAPACITY macros in RAM, names are cut to
+   MACRO_NAME_LENGTH - 1 characters. Every entry costs MACRO_NAME_LENGTH + 12 bytes. */
+#ifndef MACRO_INDEX_CAPACITY
+#define MACRO_INDEX_CAPACITY 32
+#endif
+#ifndef MACRO_NAME_LENGTH
+#define MACRO_NAME_LENGTH 32
+#endif
+/* Parsed macros kept in RAM for activation without SD access, favorites first, the rest by last use.
+   A slot holds MACRO_CACHE_RECORDS targets over all channels of a macro (4 bytes each). Saving a macro
+   with more answers 413, an uploaded one can not be started. The default fits every channel the web
+   interface edits at full length. */
+#ifndef MACRO_CACHE_SLOTS
+#define MACRO_CACHE_SLOTS 2
+#endif
+#ifndef MACRO_CACHE_RECORDS
+#define MACRO_CACHE_RECORDS (6 * MAX_TARGET_COUNT_PER_CHANNEL)
+#endif
+/* Macros that can run at the same time, on channels that do not overlap. Each one keeps a cache slot
+   pinned while it runs, so there have to be at least as many slots. */
+#ifndef MACRO_OVERLAYS
+#define MACRO_OVERLAYS 2
+#endif
+#if MACRO_OVERLAYS > MACRO_CACHE_SLOTS
+#error "MACRO_OVERLAYS must not exceed MACRO_CACHE_SLOTS"
+#endif
+
+/* Comment this out to serve the web assets from SD only. Otherwise the files below are mirrored into
+   the on-chip flash (LittleFS) at boot and after uploads, and served from there with SD as fallback. */
+#define USE_FLASH_ASSET_CACHE
+/* Files and directories (not recursive) on SD that are mirrored into flash */
+#ifndef FLASH_ASSET_PATHS
+#define FLASH_ASSET_PATHS {"app.htm", "js", "css"}
+#endif
+
 /* Comment this out, if you do not have a DS18B20 temerature sensor */
 // #define USE_DS18B20_TEMP_SENSOR
 
 /* Defines the maximum amount of target (time/value) blocks per channel.
-   Increase for ESP8266 where RAM allows denser sampling. Keep conservative on AVR. */
+   Increase for ESP8266 where RAM allows denser sampling. Keep conservative on AVR.
+   Can be overridden with a build flag (-D MAX_TARGET_COUNT_PER_CHANNEL=...) to spend DRAM freed elsewhere. */
+#ifndef MAX_TARGET_COUNT_PER_CHANNEL
 #if defined(ESP8266)
 #define MAX_TARGET_COUNT_PER_CHANNEL 32
 #elif defined(__AVR__)
@@ -28,5 +130,6 @@
 #else
 #define MAX_TARGET_COUNT_PER_CHANNEL 64
 #endif
+#endif
 
 #endif
\ No newline at end of file
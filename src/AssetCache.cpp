@@ -0,0 +1,338 @@
+/*
+Aqua Control Library
+
+Creationdate: 2026-10-18
+Flash (LittleFS) mirror of the web assets on SD.
+
+Further information on www.schullebernd.de
+*/
+
+#include "AquaControl.h"
+
+#if defined(USE_WEBSERVER) && defined(USE_FLASH_ASSET_CACHE)
+
+#include <LittleFS.h>
+
+#define ASSET_CACHE_MANIFEST_TMP "/assets.tmp"
+
+AssetCache _AssetCache;
+
+static const char *const _AssetPaths[] = FLASH_ASSET_PATHS;
+
+// Helper: LittleFS paths are absolute, SD paths in this library are not
+static bool flashPath(char *dest, size_t size, const char *path, const char *suffix = "")
+{
+	return (size_t)snprintf(dest, size, "/%s%s", path, suffix) < size;
+}
+
+bool AssetCache::covers(const char *path)
+{
+	for (uint8_t i = 0; i < sizeof(_AssetPaths) / sizeof(_AssetPaths[0]); i++)
+	{
+		const char *entry = _AssetPaths[i];
+		size_t len = strlen(entry);
+		if (strncmp(path, entry, len) != 0)
+			continue;
+		// The file itself or a direct child of the directory
+		if (path[len] == '\0' || (path[len] == '/' && path[len + 1] != '\0' && strchr(path + len + 1, '/') == nullptr))
+			return true;
+	}
+	return false;
+}
+
+bool AssetCache::begin()
+{
+	Mounted = LittleFS.begin();
+	if (!Mounted)
+	{
+		Serial.println(F("Asset cache: LittleFS mount failed, serving from SD."));
+		return false;
+	}
+
+	for (uint8_t i = 0; i < sizeof(_AssetPaths) / sizeof(_AssetPaths[0]); i++)
+	{
+		const char *entry = _AssetPaths[i];
+		File src = SD.open(entry);
+		if (!src)
+			continue;
+		if (src.isDirectory())
+		{
+			File child;
+			while ((child = src.openNextFile()))
+			{
+				if (!child.isDirectory())
+				{
+					char childPath[ASSET_CACHE_MAX_PATH];
+					if ((size_t)snprintf(childPath, sizeof(childPath), "%s/%s", entry, child.name()) < sizeof(childPath))
+					{
+						syncFile(childPath, child, false);
+					}
+				}
+				child.close();
+			}
+		}
+		else
+		{
+			syncFile(entry, src, false);
+		}
+		src.close();
+	}
+	prune();
+	return true;
+}
+
+void AssetCache::prune()
+{
+	// Same pass as updateManifest(), keeping only lines whose SD original still exists
+	File manifest = LittleFS.open(ASSET_CACHE_MANIFEST, "r");
+	if (!manifest)
+	{
+		return;
+	}
+	File tmp = LittleFS.open(ASSET_CACHE_MANIFEST_TMP, "w");
+	if (!tmp)
+	{
+		manifest.close();
+		return;
+	}
+	char line[ASSET_CACHE_MAX_PATH + 40];
+	uint8_t dropped = 0;
+	while (manifest.available())
+	{
+		size_t len = manifest.readBytesUntil('\n', line, sizeof(line) - 1);
+		line[len] = '\0';
+		char *sep = strchr(line, ';');
+		if (!sep)
+			continue;
+		*sep = '\0';
+		if (!covers(line) || !SD.exists(line))
+		{
+			char fpath[ASSET_CACHE_MAX_PATH + 1];
+			if (flashPath(fpath, sizeof(fpath), line))
+			{
+				LittleFS.remove(fpath);
+			}
+			Serial.print(F("Asset cache: dropped "));
+			Serial.println(line);
+			dropped++;
+			continue;
+		}
+		*sep = ';';
+		tmp.print(line);
+		tmp.print('\n');
+	}
+	manifest.close();
+	tmp.close();
+	if (dropped == 0)
+	{
+		LittleFS.remove(ASSET_CACHE_MANIFEST_TMP);
+		return;
+	}
+	LittleFS.remove(ASSET_CACHE_MANIFEST);
+	LittleFS.rename(ASSET_CACHE_MANIFEST_TMP, ASSET_CACHE_MANIFEST);
+}
+
+File AssetCache::open(const char *path, time_t &lastWrite)
+{
+	char fpath[ASSET_CACHE_MAX_PATH + 1];
+	uint32_t size, mtime, crc;
+	if (!Mounted || !covers(path) || !flashPath(fpath, sizeof(fpath), path) || !findManifestEntry(path, size, mtime, crc))
+	{
+		return File();
+	}
+	lastWrite = mtime;
+	return LittleFS.open(fpath, "r");
+}
+
+void AssetCache::remove(const char *path)
+{
+	char fpath[ASSET_CACHE_MAX_PATH + 1];
+	if (!Mounted || !covers(path) || !flashPath(fpath, sizeof(fpath), path))
+	{
+		return;
+	}
+	if (LittleFS.exists(fpath))
+	{
+		LittleFS.remove(fpath);
+	}
+	updateManifest(path, nullptr);
+}
+
+bool AssetCache::mirror(const char *path)
+{
+	if (!Mounted || !covers(path))
+	{
+		return false;
+	}
+	File src = SD.open(path);
+	if (!src)
+	{
+		return false;
+	}
+	bool ok = syncFile(path, src, true);
+	src.close();
+	return ok;
+}
+
+bool AssetCache::syncFile(const char *path, File &src, bool force)
+{
+	char fpath[ASSET_CACHE_MAX_PATH + 1];
+	if (!flashPath(fpath, sizeof(fpath), path))
+	{
+		return false;
+	}
+	uint32_t size = src.size();
+	uint32_t mtime = (uint32_t)src.getLastWrite();
+
+	// Unchanged on SD and still complete in flash
+	if (!force)
+	{
+		uint32_t cachedSize, cachedMtime, cachedCrc;
+		if (findManifestEntry(path, cachedSize, cachedMtime, cachedCrc) && cachedSize == size && cachedMtime == mtime)
+		{
+			File cached = LittleFS.open(fpath, "r");
+			if (cached && cached.size() == size)
+			{
+				cached.close();
+				return true;
+			}
+		}
+	}
+
+	uint32_t crc;
+	if (!copyVerified(fpath, src, crc))
+	{
+		Serial.print(F("Asset cache: failed to mirror "));
+		Serial.println(path);
+		LittleFS.remove(fpath);
+		updateManifest(path, nullptr);
+		return false;
+	}
+
+	char line[ASSET_CACHE_MAX_PATH + 40];
+	snprintf(line, sizeof(line), "%s;%lu;%lu;%08lx", path, (unsigned long)size, (unsigned long)mtime, (unsigned long)crc);
+	updateManifest(path, line);
+	Serial.print(F("Asset cache: mirrored "));
+	Serial.print(path);
+	Serial.print(F(" ("));
+	Serial.print(size);
+	Serial.println(F(" bytes)"));
+	return true;
+}
+
+bool AssetCache::copyVerified(const char *fpath, File &src, uint32_t &crc)
+{
+	char tmpPath[ASSET_CACHE_MAX_PATH + 5];
+	snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", fpath);
+
+	uint8_t buf[256];
+	File dst = LittleFS.open(tmpPath, "w");
+	if (!dst)
+	{
+		return false;
+	}
+	crc = 0;
+	bool ok = true;
+	src.seek(0);
+	int n;
+	while ((n = src.read(buf, sizeof(buf))) > 0)
+	{
+		crc = crc32Update(crc, buf, n);
+		if (dst.write(buf, n) != (size_t)n)
+		{
+			ok = false;
+			break;
+		}
+		yield();
+	}
+	dst.close();
+
+	// Read the copy back and compare with the CRC of the SD original
+	if (ok)
+	{
+		uint32_t check = 0;
+		File verify = LittleFS.open(tmpPath, "r");
+		while (verify && (n = verify.read(buf, sizeof(buf))) > 0)
+		{
+			check = crc32Update(check, buf, n);
+		}
+		ok = verify && verify.size() == src.size() && check == crc;
+		verify.close();
+	}
+
+	if (!ok)
+	{
+		LittleFS.remove(tmpPath);
+		return false;
+	}
+	LittleFS.remove(fpath);
+	return LittleFS.rename(tmpPath, fpath);
+}
+
+bool AssetCache::findManifestEntry(const char *path, uint32_t &size, uint32_t &mtime, uint32_t &crc)
+{
+	File manifest = LittleFS.open(ASSET_CACHE_MANIFEST, "r");
+	if (!manifest)
+	{
+		return false;
+	}
+	char line[ASSET_CACHE_MAX_PATH + 40];
+	size_t pathLen = strlen(path);
+	bool found = false;
+	while (manifest.available())
+	{
+		size_t len = manifest.readBytesUntil('\n', line, sizeof(line) - 1);
+		line[len] = '\0';
+		// Format: path;size;mtime;crc
+		if (strncmp(line, path, pathLen) != 0 || line[pathLen] != ';')
+			continue;
+		char *field = line + pathLen + 1;
+		size = strtoul(field, &field, 10);
+		if (*field == ';')
+			mtime = strtoul(field + 1, &field, 10);
+		if (*field == ';')
+		{
+			crc = strtoul(field + 1, &field, 16);
+			found = true;
+		}
+		break;
+	}
+	manifest.close();
+	return found;
+}
+
+void AssetCache::updateManifest(const char *path, const char *newLine)
+{
+	// Rewrite the manifest without the old entry of path, then append the new one
+	File manifest = LittleFS.open(ASSET_CACHE_MANIFEST, "r");
+	File tmp = LittleFS.open(ASSET_CACHE_MANIFEST_TMP, "w");
+	if (!tmp)
+	{
+		return;
+	}
+	char line[ASSET_CACHE_MAX_PATH + 40];
+	size_t pathLen = strlen(path);
+	while (manifest && manifest.available())
+	{
+		size_t len = manifest.readBytesUntil('\n', line, sizeof(line) - 1);
+		line[len] = '\0';
+		if (len == 0 || (strncmp(line, path, pathLen) == 0 && line[pathLen] == ';'))
+			continue;
+		tmp.print(line);
+		tmp.print('\n');
+	}
+	if (newLine)
+	{
+		tmp.print(newLine);
+		tmp.print('\n');
+	}
+	if (manifest)
+	{
+		manifest.close();
+	}
+	tmp.close();
+	LittleFS.remove(ASSET_CACHE_MANIFEST);
+	LittleFS.rename(ASSET_CACHE_MANIFEST_TMP, ASSET_CACHE_MANIFEST);
+}
+
+#endif
@@ -0,0 +1,62 @@
+/*
+Aqua Control Library
+
+Creationdate: 2026-10-18
+Flash (LittleFS) mirror of the web assets on SD.
+
+Further information on www.schullebernd.de
+*/
+
+#ifndef __ASSETCACHE_H_
+#define __ASSETCACHE_H_
+
+#include "AquaControl_config.h"
+#include <Arduino.h>
+#include <FS.h>
+
+#if defined(USE_WEBSERVER) && defined(USE_FLASH_ASSET_CACHE)
+
+#define ASSET_CACHE_MANIFEST "/assets.idx"
+#define ASSET_CACHE_MAX_PATH 48
+
+/* Copies the configured web assets (FLASH_ASSET_PATHS) from SD into LittleFS, so page loads do not
+   compete with schedule and macro IO on the SPI bus.
+   The manifest keeps size, mtime and CRC32 of the SD original of every mirrored file. At boot only
+   files whose size or mtime changed are copied again. Every copy is written to a temp file, verified
+   against the CRC of the SD original and renamed afterwards, so a file present in flash is always
+   complete and can be served without further checks. Flash copies whose SD original is gone are
+   dropped at boot. */
+class AssetCache
+{
+public:
+	// Mounts LittleFS and brings the mirror up to date with SD
+	bool begin();
+	// Opens the flash copy of an SD path, an invalid File if it is not mirrored. lastWrite is the
+	// modification time of the SD original, so validators do not change when a file is mirrored again.
+	File open(const char *path, time_t &lastWrite);
+	// Whether path is covered by FLASH_ASSET_PATHS
+	bool covers(const char *path);
+	// Drops the flash copy of a file that is about to be replaced on SD
+	void remove(const char *path);
+	// Copies a single file from SD after it was uploaded
+	bool mirror(const char *path);
+
+	bool Mounted = false;
+	uint32_t Hits = 0;	 // Requests for covered files answered from flash, counted by the web server
+	uint32_t Misses = 0; // Requests for covered files answered from SD
+
+private:
+	bool syncFile(const char *path, File &src, bool force);
+	bool copyVerified(const char *fpath, File &src, uint32_t &crc);
+	bool findManifestEntry(const char *path, uint32_t &size, uint32_t &mtime, uint32_t &crc);
+	// Drops the flash copies and manifest lines of files that are no longer on SD
+	void prune();
+	// Replaces the manifest line of path, newLine nullptr drops it
+	void updateManifest(const char *path, const char *newLine);
+};
+
+extern AssetCache _AssetCache;
+
+#endif
+
+#endif
@@ -0,0 +1,182 @@
+/*
+Aqua Control Library
+
+Creationdate: 2026-10-18
+Buffered writer that replaces a file on SD atomically.
+
+Further information on www.schullebernd.de
+*/
+
+#include "AquaControl.h"
+
+// Helper: <path>.tmp, false if it does not fit
+static bool tmpPath(char *dest, size_t size, const char *path)
+{
+	return (size_t)snprintf(dest, size, "%s.tmp", path) < size;
+}
+
+// Helper: <path>.new, the name of a temp file that passed verify()
+static bool newPath(char *dest, size_t size, const char *path)
+{
+	return (size_t)snprintf(dest, size, "%s.new", path) < size;
+}
+
+bool AtomicFileWriter::begin(const char *path)
+{
+	_Used = 0;
+	_Size = 0;
+	_Crc = 0;
+	_Failed = strlen(path) >= sizeof(_Path) || !tmpPath(_TmpPath, sizeof(_TmpPath), path);
+	if (_Failed)
+	{
+		return false;
+	}
+	strcpy(_Path, path);
+	// FILE_WRITE appends, so a temp file left by an earlier failure has to go first
+	SD.remove(_TmpPath);
+	_File = SD.open(_TmpPath, FILE_WRITE);
+	if (!_File)
+	{
+		Serial.print(F("Error: Couldn't create "));
+		Serial.println(_TmpPath);
+		_Failed = true;
+	}
+	return !_Failed;
+}
+
+size_t AtomicFileWriter::write(uint8_t b)
+{
+	return write(&b, 1);
+}
+
+size_t AtomicFileWriter::write(const uint8_t *data, size_t len)
+{
+	if (_Failed)
+	{
+		return 0;
+	}
+	_Crc = crc32Update(_Crc, data, len);
+	_Size += len;
+	size_t left = len;
+	while (left > 0)
+	{
+		size_t n = min(left, (size_t)(ATOMIC_FILE_BUFFER - _Used));
+		memcpy(_Buffer + _Used, data, n);
+		_Used += n;
+		data += n;
+		left -= n;
+		if (_Used == ATOMIC_FILE_BUFFER && !flushBuffer())
+		{
+			return 0;
+		}
+	}
+	return len;
+}
+
+bool AtomicFileWriter::flushBuffer()
+{
+	if (_Used > 0 && _File.write(_Buffer, _Used) != _Used)
+	{
+		_Failed = true;
+	}
+	_Used = 0;
+	return !_Failed;
+}
+
+// Reads the temp file back and compares size and CRC with what was written
+bool AtomicFileWriter::verify()
+{
+	File file = SD.open(_TmpPath);
+	if (!file)
+	{
+		return false;
+	}
+	bool ok = file.size() == _Size;
+	uint32_t crc = 0;
+	while (ok && file.available())
+	{
+		int n = file.read(_Buffer, ATOMIC_FILE_BUFFER);
+		if (n <= 0)
+		{
+			ok = false;
+			break;
+		}
+		crc = crc32Update(crc, _Buffer, n);
+	}
+	file.close();
+	return ok && crc == _Crc;
+}
+
+bool AtomicFileWriter::commit()
+{
+	if (!_Failed)
+	{
+		flushBuffer();
+		_File.close();
+	}
+	if (_Failed || !verify())
+	{
+		Serial.print(F("Error: Couldn't write "));
+		Serial.println(_Path);
+		abort();
+		return false;
+	}
+	_Failed = true; // A writer commits once
+	// Only a file under the .new name is known to be complete, recoverAtomicFile() relies on that
+	char verified[ATOMIC_FILE_MAX_PATH + 4];
+	newPath(verified, sizeof(verified), _Path);
+	SD.remove(verified);
+	if (!SD.rename(_TmpPath, verified))
+	{
+		Serial.print(F("Error: Couldn't rename "));
+		Serial.println(_TmpPath);
+		SD.remove(_TmpPath);
+		return false;
+	}
+	SD.remove(_Path);
+	if (!SD.rename(verified, _Path))
+	{
+		// recoverAtomicFile() finishes the swap at the next boot
+		Serial.print(F("Error: Couldn't rename "));
+		Serial.println(verified);
+		return false;
+	}
+	return true;
+}
+
+void AtomicFileWriter::abort()
+{
+	if (_File)
+	{
+		_File.close();
+	}
+	_Failed = true;
+	SD.remove(_TmpPath);
+}
+
+void recoverAtomicFile(const char *path)
+{
+	char tmp[ATOMIC_FILE_MAX_PATH + 4];
+	char verified[ATOMIC_FILE_MAX_PATH + 4];
+	if (!tmpPath(tmp, sizeof(tmp), path) || !newPath(verified, sizeof(verified), path))
+	{
+		return;
+	}
+	if (SD.exists(tmp))
+	{
+		// The reset came while writing, the temp file may be incomplete even if there is no old file
+		SD.remove(tmp);
+		Serial.print(F("Dropped incomplete "));
+		Serial.println(tmp);
+	}
+	if (SD.exists(verified))
+	{
+		// The reset came during the swap, the file was verified before it got this name
+		SD.remove(path);
+		if (SD.rename(verified, path))
+		{
+			Serial.print(F("Completed interrupted write of "));
+			Serial.println(path);
+		}
+	}
+}
@@ -0,0 +1,56 @@
+/*
+Aqua Control Library
+
+Creationdate: 2026-10-18
+Buffered writer that replaces a file on SD atomically.
+
+Further information on www.schullebernd.de
+*/
+
+#ifndef __ATOMICFILE_H_
+#define __ATOMICFILE_H_
+
+#include "AquaControl_config.h"
+#include <Arduino.h>
+#include <SD.h>
+
+#define ATOMIC_FILE_BUFFER 512 // One SD sector, the card is written in whole sectors
+#define ATOMIC_FILE_MAX_PATH 48
+
+/* Writes a file as <path>.tmp through a sector sized buffer. commit() reads the temp file back, checks
+   its size and CRC32 against what was written, renames it to <path>.new and only then removes the old
+   file and renames <path>.new into its place. A file at path is therefore always complete:
+     - reset while writing: an unverified <path>.tmp exists, it is dropped (also if there is no old file)
+     - reset during the swap: the verified <path>.new exists, it replaces the old file if there is one
+   recoverAtomicFile() does this at boot. The writer holds the buffer, so keep it a local variable. */
+class AtomicFileWriter : public Print
+{
+public:
+	// Starts a new temp file for path, a stale one from an earlier failure is removed
+	bool begin(const char *path);
+	size_t write(uint8_t b) override;
+	size_t write(const uint8_t *data, size_t len) override;
+	using Print::write;
+	// Writes the rest of the buffer, verifies the temp file and swaps it in
+	bool commit();
+	// Drops the temp file, the old file stays as it is
+	void abort();
+
+private:
+	bool flushBuffer();
+	bool verify();
+
+	char _Path[ATOMIC_FILE_MAX_PATH];
+	char _TmpPath[ATOMIC_FILE_MAX_PATH + 4];
+	File _File;
+	uint8_t _Buffer[ATOMIC_FILE_BUFFER];
+	uint16_t _Used = 0;
+	uint32_t _Size = 0;
+	uint32_t _Crc = 0;
+	bool _Failed = true;
+};
+
+// Completes or discards a swap of path that a reset interrupted, call before path is read
+void recoverAtomicFile(const char *path);
+
+#endif
@@ -0,0 +1,77 @@
+/*
+Aqua Control Library
+
+Creationdate: 2026-10-18
+Minimal CBOR encoder for compact API responses.
+
+Further information on www.schullebernd.de
+*/
+
+#include "CborWriter.h"
+
+void CborWriter::put(uint8_t b)
+{
+	if (_Used >= _Size)
+	{
+		flush();
+	}
+	_Buf[_Used++] = b;
+}
+
+// Major type in the upper 3 bits, the value in the shortest of the inline / 1 / 2 / 4 byte forms
+void CborWriter::head(uint8_t major, uint32_t value)
+{
+	major <<= 5;
+	if (value < 24)
+	{
+		put(major | value);
+	}
+	else if (value <= 0xFF)
+	{
+		put(major | 24);
+		put(value);
+	}
+	else if (value <= 0xFFFF)
+	{
+		put(major | 25);
+		put(value >> 8);
+		put(value);
+	}
+	else
+	{
+		put(major | 26);
+		put(value >> 24);
+		put(value >> 16);
+		put(value >> 8);
+		put(value);
+	}
+}
+
+void CborWriter::key(PGM_P name)
+{
+	size_t len = strlen_P(name);
+	head(3, len);
+	for (size_t i = 0; i < len; i++)
+	{
+		put(pgm_read_byte(name + i));
+	}
+}
+
+void CborWriter::text(const char *value)
+{
+	size_t len = strlen(value);
+	head(3, len);
+	for (size_t i = 0; i < len; i++)
+	{
+		put(value[i]);
+	}
+}
+
+void CborWriter::flush()
+{
+	if (_Used > 0)
+	{
+		_Sink(_Buf, _Used);
+		_Used = 0;
+	}
+}
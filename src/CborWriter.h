@@ -0,0 +1,52 @@
+/*
+Aqua Control Library
+
+Creationdate: 2026-10-18
+Minimal CBOR encoder for compact API responses.
+
+Further information on www.schullebernd.de
+*/
+
+#ifndef __CBORWRITER_H_
+#define __CBORWRITER_H_
+
+#include "AquaControl_config.h"
+#include <Arduino.h>
+
+/* Encodes CBOR (RFC 8949) data items into a small buffer and hands every full buffer to a sink,
+   so responses of any size are produced without building them in RAM. Only the items the API needs
+   are supported: unsigned integers, booleans, text strings and maps / arrays of definite or
+   indefinite length. Keys are flash strings, the schema is the same as that of the JSON responses. */
+class CborWriter
+{
+public:
+	typedef void (*Sink)(const uint8_t *data, size_t len);
+
+	CborWriter(uint8_t *buf, size_t size, Sink sink) : _Buf(buf), _Size(size), _Sink(sink) {}
+
+	void map(uint32_t entries) { head(5, entries); }
+	void array(uint32_t items) { head(4, items); }
+	// Indefinite length map / array, closed by end()
+	void beginMap() { put(0xBF); }
+	void beginArray() { put(0x9F); }
+	void end() { put(0xFF); }
+
+	void key(PGM_P name);
+	void text(const char *value);
+	void uint(uint32_t value) { head(0, value); }
+	void boolean(bool value) { put(value ? 0xF5 : 0xF4); }
+
+	// Passes the buffered bytes to the sink
+	void flush();
+
+private:
+	void head(uint8_t major, uint32_t value);
+	void put(uint8_t b);
+
+	uint8_t *_Buf;
+	size_t _Size;
+	size_t _Used = 0;
+	Sink _Sink;
+};
+
+#endif // #ifndef __CBORWRITER_H_
@@ -0,0 +1,132 @@
+/*
+Aqua Control Library
+
+Creationdate: 2026-10-18
+Allocation free line tokenizer for the text config files on SD.
+
+Further information on www.schullebernd.de
+*/
+
+#include "AquaControl.h"
+
+void TextView::copyTo(char *dest, size_t size) const
+{
+	size_t n = min((size_t)Length, size - 1);
+	memcpy(dest, Data, n);
+	dest[n] = '\0';
+}
+
+// Helper: Removes blanks (and the CR of CRLF line ends) on both sides
+static TextView trimmed(const char *begin, const char *end)
+{
+	while (begin < end && (*begin == ' ' || *begin == '\t'))
+	{
+		begin++;
+	}
+	while (end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r'))
+	{
+		end--;
+	}
+	TextView view;
+	view.Data = begin;
+	view.Length = end - begin;
+	return view;
+}
+
+bool ConfigReader::next(bool comments)
+{
+	while (true)
+	{
+		// Move the unread bytes to the front and top up the buffer, a whole line then starts at 0
+		if (_Start > 0)
+		{
+			memmove(_Buffer, _Buffer + _Start, _End - _Start);
+			_End -= _Start;
+			_Start = 0;
+		}
+		if (_End < CONFIG_READER_BUFFER && _File.available())
+		{
+			int n = _File.read((uint8_t *)_Buffer + _End, CONFIG_READER_BUFFER - _End);
+			if (n > 0)
+			{
+				_End += n;
+			}
+		}
+		if (_End == 0)
+		{
+			return false;
+		}
+
+		char *newline = (char *)memchr(_Buffer, '\n', _End);
+		uint8_t length = newline ? newline - _Buffer : _End;
+		_Start = newline ? length + 1 : _End;
+		bool skip = _SkipRest;
+		// A line that fills the whole buffer is cut, the rest of it is skipped with the next call
+		_SkipRest = !newline && _End == CONFIG_READER_BUFFER;
+		if (skip)
+		{
+			continue;
+		}
+
+		_Line = trimmed(_Buffer, _Buffer + length);
+		if (_Line.Length == 0 || (!comments && isComment()))
+		{
+			continue;
+		}
+		// The byte after the line is consumed (or the spare byte of the buffer)
+		_Buffer[(_Line.Data - _Buffer) + _Line.Length] = '\0';
+		return true;
+	}
+}
+
+bool ConfigReader::isComment() const
+{
+	return _Line.Data[0] == '#' || (_Line.Data[0] == '/' && _Line.Length > 1 && _Line.Data[1] == '/');
+}
+
+bool ConfigReader::option(TextView &key, TextView &value) const
+{
+	const char *end = _Line.Data + _Line.Length;
+	const char *equals = (const char *)memchr(_Line.Data, '=', _Line.Length);
+	if (!equals)
+	{
+		return false;
+	}
+	key = trimmed(_Line.Data, equals);
+	value = trimmed(equals + 1, end);
+	if (value.Length >= 2 && value.Data[0] == '"' && value.Data[value.Length - 1] == '"')
+	{
+		value.Data++;
+		value.Length -= 2;
+	}
+	return true;
+}
+
+bool ConfigReader::record(long &time, int &value, ConfigTimeFormat format) const
+{
+	const char *semi = strchr(_Line.Data, ';');
+	if (!semi)
+	{
+		return false;
+	}
+	time = atol(_Line.Data);
+	const char *colon = strchr(_Line.Data, ':');
+	if (colon && colon < semi)
+	{
+		if (format == ConfigDuration)
+		{
+			time = time * 60 + atol(colon + 1);
+		}
+		else
+		{
+			time = time * 3600 + atol(colon + 1) * 60;
+			const char *seconds = strchr(colon + 1, ':');
+			if (seconds && seconds < semi)
+			{
+				time += atol(seconds + 1);
+			}
+		}
+	}
+	value = max(0, min(100, atoi(semi + 1)));
+	return true;
+}
@@ -0,0 +1,64 @@
+/*
+Aqua Control Library
+
+Creationdate: 2026-10-18
+Allocation free line tokenizer for the text config files on SD.
+
+Further information on www.schullebernd.de
+*/
+
+#ifndef __CONFIGREADER_H_
+#define __CONFIGREADER_H_
+
+#include "AquaControl_config.h"
+#include <Arduino.h>
+#include <SD.h>
+
+#define CONFIG_READER_BUFFER 128 // Longest line, the rest of a longer line is skipped
+
+// A part of the reader buffer, valid until the next call of ConfigReader::next()
+struct TextView
+{
+	const char *Data = "";
+	uint8_t Length = 0;
+
+	bool equals(const char *text) const { return strlen(text) == Length && strncmp(Data, text, Length) == 0; }
+	// Copies the text with a terminating zero, cut to size - 1 characters
+	void copyTo(char *dest, size_t size) const;
+};
+
+// How "a:b" in the time of a record is read
+enum ConfigTimeFormat : uint8_t
+{
+	ConfigTimeOfDay, // HH:MM or HH:MM:SS (schedules)
+	ConfigDuration,	 // MM:SS (macros)
+};
+
+/* Reads a file block by block into a fixed buffer and hands out one line at a time, trimmed and
+   zero terminated in place. Nothing is allocated, so the readers of wlan.cfg, the text schedules and
+   the macro files can run at boot without touching the heap.
+   Empty lines are skipped, comments ("//" or "#") unless asked for. */
+class ConfigReader
+{
+public:
+	explicit ConfigReader(File &file) : _File(file) {}
+
+	// Advances to the next line with content, false at the end of the file
+	bool next(bool comments = false);
+	TextView line() const { return _Line; }
+	bool isComment() const;
+	// key="value" or key=value, blanks around '=' are ignored. False if the line has no '='
+	bool option(TextView &key, TextView &value) const;
+	// time;value with the time as seconds or in the given format, the value is clamped to 0-100
+	bool record(long &time, int &value, ConfigTimeFormat format = ConfigTimeOfDay) const;
+
+private:
+	File &_File;
+	char _Buffer[CONFIG_READER_BUFFER + 1];
+	uint8_t _Start = 0; // Unread bytes are _Buffer[_Start.._End)
+	uint8_t _End = 0;
+	bool _SkipRest = false; // Inside the remainder of a line that did not fit
+	TextView _Line;
+};
+
+#endif
@@ -0,0 +1,188 @@
+/*
+Aqua Control Library
+
+Creationdate: 2026-10-18
+Server-Sent Events push channel (/api/events) for status changes and live outputs.
+
+Further information on www.schullebernd.de
+*/
+
+#include "AquaControl.h"
+
+#if defined(USE_WEBSERVER) && defined(USE_SERVER_SENT_EVENTS)
+
+#include "WebStrings.h"
+
+#define EVENT_BUFFER_SIZE 1024
+
+extern "C" AquaControl *_aqc;
+
+EventStream _Events;
+
+bool EventStream::subscribe(WiFiClient &client)
+{
+	for (uint8_t i = 0; i < EVENT_STREAM_MAX_SUBSCRIBERS; i++)
+	{
+		EventSubscriber &sub = _Subscribers[i];
+		if (!sub.Active)
+		{
+			sub.Client = client;
+			sub.Active = true;
+			// The first event is a full snapshot plus all outputs
+			sub.Pending = ChangeAll;
+			memset(sub.Outputs, 0xFF, sizeof(sub.Outputs));
+			sub.LastWrite = millis();
+			return true;
+		}
+	}
+	return false;
+}
+
+uint8_t EventStream::subscribers() const
+{
+	uint8_t count = 0;
+	for (uint8_t i = 0; i < EVENT_STREAM_MAX_SUBSCRIBERS; i++)
+	{
+		if (_Subscribers[i].Active)
+			count++;
+	}
+	return count;
+}
+
+void EventStream::pump()
+{
+	// Coalesce changes (a fade raises ChangeOutputs every cycle)
+	if (millis() - _LastPump < EVENT_STREAM_INTERVAL_MS)
+	{
+		return;
+	}
+	_LastPump = millis();
+	uint8_t changes = _aqc->_Changes;
+	_aqc->_Changes = 0;
+
+	for (uint8_t i = 0; i < EVENT_STREAM_MAX_SUBSCRIBERS; i++)
+	{
+		EventSubscriber &sub = _Subscribers[i];
+		if (!sub.Active)
+			continue;
+		if (!sub.Client.connected())
+		{
+			drop(sub);
+			continue;
+		}
+		sub.Pending |= changes;
+		if (sub.Pending == 0 && millis() - sub.LastWrite < EVENT_STREAM_HEARTBEAT_MS)
+			continue;
+
+		// Backpressure: keep the flags pending until the client has read its data
+		if (sub.Client.availableForWrite() < EVENT_STREAM_MIN_WRITABLE)
+		{
+			if (millis() - sub.LastWrite > EVENT_STREAM_STALL_MS)
+				drop(sub);
+			continue;
+		}
+		send(sub);
+	}
+}
+
+void EventStream::send(EventSubscriber &sub)
+{
+	size_t arenaMark = _Arena.mark();
+	char *out = (char *)_Arena.alloc(EVENT_BUFFER_SIZE);
+	if (!out)
+	{
+		return;
+	}
+	size_t len = 0;
+	out[0] = '\0';
+	uint8_t pending = sub.Pending;
+	char line[128];
+
+	// A time sync moves the clock of the UI, so it gets a full snapshot (covers macro, test and temperature)
+	if (pending & ChangeTimeSync)
+	{
+		appendJson_P(out, EVENT_BUFFER_SIZE, len, EVT_STATUS);
+		appendJson(out, EVENT_BUFFER_SIZE, len, currentStatus().Json);
+		appendJson_P(out, EVENT_BUFFER_SIZE, len, EVT_END);
+		pending &= ~(ChangeMacro | ChangeTestMode | ChangeTemperature);
+	}
+	if (pending & ChangeMacro)
+	{
+		const MacroOverlay *macro = _aqc->activeMacro();
+		if (macro)
+		{
+			snprintf_P(line, sizeof(line), FMT_EVT_MACRO_ACTIVE, (unsigned long)_aqc->getMacroTimeRemaining(*macro),
+					   macro->MacroId, (unsigned int)_aqc->activeMacroCount());
+			appendJson(out, EVENT_BUFFER_SIZE, len, line);
+		}
+		else
+		{
+			appendJson_P(out, EVENT_BUFFER_SIZE, len, EVT_MACRO_INACTIVE);
+		}
+	}
+	if (pending & ChangeTestMode)
+	{
+		snprintf_P(line, sizeof(line), FMT_EVT_TEST, _aqc->_PwmChannels[0].TestMode ? "true" : "false");
+		appendJson(out, EVENT_BUFFER_SIZE, len, line);
+	}
+#if defined(USE_DS18B20_TEMP_SENSOR)
+	if (pending & ChangeTemperature)
+	{
+		char temp[16];
+		dtostrf(_aqc->_Temperature._TemperatureInCelsius, 1, 1, temp);
+		snprintf_P(line, sizeof(line), FMT_EVT_TEMPERATURE, temp);
+		appendJson(out, EVENT_BUFFER_SIZE, len, line);
+	}
+#endif
+	if (pending & ChangeOutputs)
+	{
+		// Only the channels whose percentage changed since the last event
+		bool first = true;
+		for (uint8_t ch = 0; ch < EVENT_STREAM_CHANNELS; ch++)
+		{
+			uint8_t percent = (uint8_t)(((uint32_t)_aqc->_PwmChannels[ch].CurrentWriteValue * 100 + PWM_MAX / 2) / PWM_MAX);
+			if (percent == sub.Outputs[ch])
+				continue;
+			sub.Outputs[ch] = percent;
+			if (first)
+				appendJson_P(out, EVENT_BUFFER_SIZE, len, EVT_OUTPUTS);
+			else
+				appendJson(out, EVENT_BUFFER_SIZE, len, ",");
+			first = false;
+			snprintf_P(line, sizeof(line), FMT_EVT_OUTPUT, ch, percent);
+			appendJson(out, EVENT_BUFFER_SIZE, len, line);
+		}
+		if (!first)
+			appendJson_P(out, EVENT_BUFFER_SIZE, len, EVT_OUTPUTS_END);
+	}
+	sub.Pending = 0;
+
+	if (len == 0 && millis() - sub.LastWrite >= EVENT_STREAM_HEARTBEAT_MS)
+	{
+		appendJson_P(out, EVENT_BUFFER_SIZE, len, EVT_HEARTBEAT);
+	}
+	if (len > 0)
+	{
+		if (sub.Client.write((const uint8_t *)out, len) != len)
+		{
+			drop(sub);
+		}
+		else
+		{
+			sub.LastWrite = millis();
+			Sent++;
+		}
+	}
+	_Arena.rewind(arenaMark);
+}
+
+void EventStream::drop(EventSubscriber &sub)
+{
+	sub.Client.stop(1);
+	sub.Client = WiFiClient();
+	sub.Active = false;
+	sub.Pending = 0;
+	Dropped++;
+}
+
+#endif
@@ -0,0 +1,65 @@
+/*
+Aqua Control Library
+
+Creationdate: 2026-10-18
+Server-Sent Events push channel (/api/events) for status changes and live outputs.
+
+Further information on www.schullebernd.de
+*/
+
+#ifndef __EVENTSTREAM_H_
+#define __EVENTSTREAM_H_
+
+#include "AquaControl_config.h"
+#include <Arduino.h>
+
+#if defined(USE_WEBSERVER) && defined(USE_SERVER_SENT_EVENTS)
+
+#include <WiFiClient.h>
+
+#define EVENT_STREAM_MAX_SUBSCRIBERS 2
+#define EVENT_STREAM_INTERVAL_MS 250	 // Changes are coalesced and sent at most this often
+#define EVENT_STREAM_HEARTBEAT_MS 15000	 // Comment line on idle streams, detects dead clients
+#define EVENT_STREAM_STALL_MS 15000		 // A subscriber that takes no data for this long is dropped
+#define EVENT_STREAM_MIN_WRITABLE 512	 // Free send buffer required before events are written
+#define EVENT_STREAM_CHANNELS 6			 // Channels reported in the outputs event
+
+// One connected EventSource
+struct EventSubscriber
+{
+	WiFiClient Client;
+	bool Active = false;
+	uint8_t Pending = 0;						// AquaChange flags not yet sent
+	uint8_t Outputs[EVENT_STREAM_CHANNELS];		// Last sent output per channel in percent
+	uint32_t LastWrite = 0;
+};
+
+/* Pushes changes to a small, fixed set of subscribers instead of having every UI poll /api/status.
+   AquaControl raises change flags (notifyChange). The pump distributes them to the subscribers and
+   sends one event per changed topic, containing the current state of that topic. A slow subscriber
+   keeps its flags pending (so changes coalesce) until its send buffer has room again. */
+class EventStream
+{
+public:
+	// Takes over the current client of the web server, false if all slots are taken
+	bool subscribe(WiFiClient &client);
+	// Distributes pending changes and sends the due events
+	void pump();
+	uint8_t subscribers() const;
+
+	uint32_t Sent = 0;
+	uint32_t Dropped = 0;
+
+private:
+	void send(EventSubscriber &sub);
+	void drop(EventSubscriber &sub);
+
+	EventSubscriber _Subscribers[EVENT_STREAM_MAX_SUBSCRIBERS];
+	uint32_t _LastPump = 0;
+};
+
+extern EventStream _Events;
+
+#endif
+
+#endif
@@ -0,0 +1,168 @@
+/*
+Aqua Control Library
+
+Creationdate: 2026-10-18
+Optional heap allocation tracker with per-subsystem attribution.
+
+Further information on www.schullebernd.de
+*/
+
+#include "AquaControl.h"
+
+#if defined(USE_HEAP_TRACKER)
+
+HeapTracker _HeapTracker;
+
+static const char SCOPE_LOOP[] PROGMEM = "loop";
+static const char SCOPE_BOOT[] PROGMEM = "boot";
+static const char SCOPE_SD_CONFIG[] PROGMEM = "sd_config";
+static const char SCOPE_MACRO[] PROGMEM = "macro";
+static const char SCOPE_WEB[] PROGMEM = "web_static";
+
+void HeapTracker::begin()
+{
+	BootFreeHeap = ESP.getFreeHeap();
+	MinFreeHeap = BootFreeHeap;
+	ScopeMinFreeHeap = BootFreeHeap;
+	Scopes[HeapScopeLoop].Name = SCOPE_LOOP;
+	Scopes[HeapScopeBoot].Name = SCOPE_BOOT;
+	Scopes[HeapScopeSdConfig].Name = SCOPE_SD_CONFIG;
+	Scopes[HeapScopeMacro].Name = SCOPE_MACRO;
+	Scopes[HeapScopeWeb].Name = SCOPE_WEB;
+	if (ScopeCount < HeapScopeFirstRoute)
+	{
+		ScopeCount = HeapScopeFirstRoute;
+	}
+}
+
+uint8_t HeapTracker::addScope(const char *name, uint8_t method)
+{
+	if (ScopeCount >= HEAP_TRACKER_MAX_SCOPES)
+	{
+		return HeapScopeWeb;
+	}
+	Scopes[ScopeCount].Name = name;
+	Scopes[ScopeCount].Method = method;
+	return ScopeCount++;
+}
+
+void HeapTracker::noteAlloc(size_t size, void *result)
+{
+	HeapScopeStats &scope = Scopes[CurrentScope];
+	AllocCount++;
+	scope.AllocCount++;
+	scope.AllocBytes += size;
+	if (size > scope.LargestBlock)
+	{
+		scope.LargestBlock = size;
+	}
+	if (size > LargestBlock)
+	{
+		LargestBlock = size;
+	}
+	if (result && BootFreeHeap)
+	{
+		uint32_t freeHeap = ESP.getFreeHeap();
+		if (freeHeap < MinFreeHeap)
+		{
+			MinFreeHeap = freeHeap;
+		}
+		if (freeHeap < ScopeMinFreeHeap)
+		{
+			ScopeMinFreeHeap = freeHeap;
+		}
+	}
+}
+
+void HeapTracker::noteFree(void *ptr)
+{
+	if (ptr)
+	{
+		FreeCount++;
+		Scopes[CurrentScope].FreeCount++;
+	}
+}
+
+uint32_t HeapTracker::liveBytes() const
+{
+	uint32_t freeHeap = ESP.getFreeHeap();
+	return BootFreeHeap > freeHeap ? BootFreeHeap - freeHeap : 0;
+}
+
+uint32_t HeapTracker::peakBytes() const
+{
+	return BootFreeHeap > MinFreeHeap ? BootFreeHeap - MinFreeHeap : 0;
+}
+
+HeapScopeGuard::HeapScopeGuard(uint8_t scope)
+{
+	_PreviousScope = _HeapTracker.CurrentScope;
+	_PreviousMinFreeHeap = _HeapTracker.ScopeMinFreeHeap;
+	_EntryFreeHeap = ESP.getFreeHeap();
+	_HeapTracker.ScopeMinFreeHeap = _EntryFreeHeap;
+	_HeapTracker.CurrentScope = scope;
+}
+
+HeapScopeGuard::~HeapScopeGuard()
+{
+	HeapScopeStats &stats = _HeapTracker.Scopes[_HeapTracker.CurrentScope];
+	uint32_t exitFreeHeap = ESP.getFreeHeap();
+	stats.Retained += (int32_t)_EntryFreeHeap - (int32_t)exitFreeHeap;
+	uint32_t peak = _EntryFreeHeap > _HeapTracker.ScopeMinFreeHeap ? _EntryFreeHeap - _HeapTracker.ScopeMinFreeHeap : 0;
+	if (peak > stats.Peak)
+	{
+		stats.Peak = peak;
+	}
+	// The outer scope saw everything the inner one saw
+	if (_HeapTracker.ScopeMinFreeHeap < _PreviousMinFreeHeap)
+	{
+		_PreviousMinFreeHeap = _HeapTracker.ScopeMinFreeHeap;
+	}
+	_HeapTracker.ScopeMinFreeHeap = _PreviousMinFreeHeap;
+	_HeapTracker.CurrentScope = _PreviousScope;
+}
+
+// Linker wrappers (-Wl,--wrap=malloc ...). The tracker itself never allocates.
+extern "C"
+{
+	void *__real_malloc(size_t size);
+	void *__real_calloc(size_t count, size_t size);
+	void *__real_realloc(void *ptr, size_t size);
+	void __real_free(void *ptr);
+
+	void *__wrap_malloc(size_t size)
+	{
+		void *p = __real_malloc(size);
+		_HeapTracker.noteAlloc(size, p);
+		return p;
+	}
+
+	void *__wrap_calloc(size_t count, size_t size)
+	{
+		void *p = __real_calloc(count, size);
+		_HeapTracker.noteAlloc(count * size, p);
+		return p;
+	}
+
+	void *__wrap_realloc(void *ptr, size_t size)
+	{
+		void *p = __real_realloc(ptr, size);
+		if (size == 0)
+		{
+			_HeapTracker.noteFree(ptr);
+		}
+		else
+		{
+			_HeapTracker.noteAlloc(size, p);
+		}
+		return p;
+	}
+
+	void __wrap_free(void *ptr)
+	{
+		_HeapTracker.noteFree(ptr);
+		__real_free(ptr);
+	}
+}
+
+#endif
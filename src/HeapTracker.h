@@ -0,0 +1,97 @@
+/*
+Aqua Control Library
+
+Creationdate: 2026-10-18
+Optional heap allocation tracker with per-subsystem attribution.
+
+Further information on www.schullebernd.de
+*/
+
+#ifndef __HEAPTRACKER_H_
+#define __HEAPTRACKER_H_
+
+#include "AquaControl_config.h"
+#include <Arduino.h>
+
+#if defined(USE_HEAP_TRACKER)
+
+/* Build with the esp8266_heaptrack environment. It defines USE_HEAP_TRACKER and links with
+   --wrap=malloc/calloc/realloc/free, so every allocation of the sketch and the core passes through
+   the tracker and is counted for the currently active scope.
+   Live and peak bytes are taken from the umm heap statistics (free heap deltas), so they include
+   block overhead and need no per-allocation header. */
+
+#define HEAP_TRACKER_MAX_SCOPES 40
+
+// Fixed scopes, web routes are appended behind them at registration time
+enum HeapScopeTag : uint8_t
+{
+	HeapScopeLoop = 0, // Everything outside a more specific scope
+	HeapScopeBoot,
+	HeapScopeSdConfig,
+	HeapScopeMacro,
+	HeapScopeWeb, // Requests without a registered route (static files, 404)
+	HeapScopeFirstRoute
+};
+
+typedef struct
+{
+	const char *Name;	   // Scope name or route URI (RAM or flash, print with the _P functions)
+	uint8_t Method;		   // HTTPMethod of a route scope
+	uint32_t AllocCount;   // malloc / calloc / realloc calls
+	uint32_t FreeCount;	   // free calls (including realloc to 0)
+	uint32_t AllocBytes;   // Sum of all requested sizes
+	uint32_t LargestBlock; // Largest single request
+	int32_t Retained;	   // Net heap change over all completed scopes (positive = leaked / kept)
+	uint32_t Peak;		   // Largest heap use seen while the scope was active
+} HeapScopeStats;
+
+/* Plain data only: the object lives in .bss and is usable by the malloc wrappers
+   even before the static constructors have run. */
+class HeapTracker
+{
+public:
+	HeapScopeStats Scopes[HEAP_TRACKER_MAX_SCOPES];
+	uint8_t ScopeCount;
+	uint8_t CurrentScope;
+	uint32_t BootFreeHeap; // Free heap when begin() was called
+	uint32_t MinFreeHeap;  // Lowest free heap seen after an allocation
+	uint32_t ScopeMinFreeHeap;
+	uint32_t AllocCount;
+	uint32_t FreeCount;
+	uint32_t LargestBlock;
+
+	void begin();
+	// Adds a named scope (e.g. a web route) and returns its index, or HeapScopeWeb if the table is full
+	uint8_t addScope(const char *name, uint8_t method = 0);
+	void noteAlloc(size_t size, void *result);
+	void noteFree(void *ptr);
+	uint32_t liveBytes() const;
+	uint32_t peakBytes() const;
+};
+
+extern HeapTracker _HeapTracker;
+
+/* Attributes all allocations inside the enclosing block to the given scope.
+   Scopes nest, the previous scope is restored on exit. */
+class HeapScopeGuard
+{
+public:
+	HeapScopeGuard(uint8_t scope);
+	~HeapScopeGuard();
+
+private:
+	uint8_t _PreviousScope;
+	uint32_t _EntryFreeHeap;
+	uint32_t _PreviousMinFreeHeap;
+};
+
+#define HEAP_SCOPE(scope) HeapScopeGuard _heapScopeGuard(scope)
+
+#else
+
+#define HEAP_SCOPE(scope)
+
+#endif // defined(USE_HEAP_TRACKER)
+
+#endif // #ifndef __HEAPTRACKER_H_
@@ -0,0 +1,210 @@
+/*
+Aqua Control Library
+
+Creationdate: 2026-10-18
+RAM cache of parsed macros, so activation does not wait for the SD card.
+
+Further information on www.schullebernd.de
+*/
+
+#include "AquaControl.h"
+
+MacroCache _MacroCache;
+
+uint16_t macroCacheRecords(const uint8_t *counts, uint8_t channels)
+{
+	uint16_t total = 0;
+	for (uint8_t ch = 0; ch < channels && ch < PWM_CHANNELS; ch++)
+	{
+		total += min(counts[ch], (uint8_t)MAX_TARGET_COUNT_PER_CHANNEL);
+	}
+	return total;
+}
+
+bool MacroCache::load(MacroCacheSlot &slot, uint16_t number)
+{
+	const MacroIndexEntry *entry = _MacroIndex.find(number);
+	if (!entry)
+	{
+		return false;
+	}
+	char macroId[16];
+	sprintf(macroId, "macro_%03u", number);
+	MacroReader reader;
+	if (!reader.open(macroId))
+	{
+		return false;
+	}
+	// A channel plays at most MAX_TARGET_COUNT_PER_CHANNEL targets, the rest of it is not loaded, and
+	// channels this controller does not have are not loaded at all
+	if (macroCacheRecords(reader.info().Counts, MACRO_FILE_CHANNELS) > MACRO_CACHE_RECORDS)
+	{
+		reader.close();
+		Serial.print(F("Error: Macro has more targets than a cache slot holds: "));
+		Serial.println(macroId);
+		return false;
+	}
+
+	slot.Number = 0; // Free until the targets are complete
+	slot.ChannelMask = reader.info().ChannelMask & (uint16_t)((1UL << PWM_CHANNELS) - 1);
+	uint16_t n = 0;
+	for (uint8_t ch = 0; ch < MACRO_FILE_CHANNELS; ch++)
+	{
+		slot.First[ch] = n;
+		slot.Counts[ch] = 0;
+		if (!(slot.ChannelMask & (1 << ch)) || !reader.channel(ch))
+		{
+			continue;
+		}
+		uint32_t time;
+		uint8_t value;
+		while (slot.Counts[ch] < MAX_TARGET_COUNT_PER_CHANNEL && reader.next(time, value))
+		{
+			slot.Records[n++] = (time << 8) | value;
+			slot.Counts[ch]++;
+		}
+	}
+	reader.close();
+	slot.Number = number;
+	slot.Version = entry->Version;
+	slot.LastUsed = ++_Uses;
+	return true;
+}
+
+MacroCacheSlot *MacroCache::victim(bool evictFavorites)
+{
+	// A free slot, a slot of a macro that is gone or changed, else the least recently used non-favorite.
+	// Favorites only go if evictFavorites is set and no other slot is left, pinned slots never.
+	MacroCacheSlot *oldest = nullptr;
+	bool oldestFavorite = false;
+	for (uint8_t i = 0; i < MACRO_CACHE_SLOTS; i++)
+	{
+		MacroCacheSlot &slot = _Slots[i];
+		if (slot.Pins)
+		{
+			continue;
+		}
+		const MacroIndexEntry *entry = slot.Number ? _MacroIndex.find(slot.Number) : nullptr;
+		if (!entry || entry->Version != slot.Version)
+		{
+			slot.Number = 0;
+			return &slot;
+		}
+		bool favorite = entry->Flags & MacroFavorite;
+		if (favorite && !evictFavorites)
+		{
+			continue;
+		}
+		if (!oldest || (oldestFavorite && !favorite) ||
+			(favorite == oldestFavorite && slot.LastUsed < oldest->LastUsed))
+		{
+			oldest = &slot;
+			oldestFavorite = favorite;
+		}
+	}
+	return oldest;
+}
+
+MacroCacheSlot *MacroCache::slotOf(uint16_t number, uint32_t version)
+{
+	for (uint8_t i = 0; i < MACRO_CACHE_SLOTS; i++)
+	{
+		if (_Slots[i].Number == number && _Slots[i].Version == version)
+		{
+			return &_Slots[i];
+		}
+	}
+	return nullptr;
+}
+
+const MacroCacheSlot *MacroCache::acquire(const char *macroId)
+{
+	const MacroIndexEntry *entry = _MacroIndex.find(macroId);
+	if (!entry)
+	{
+		return nullptr;
+	}
+	MacroCacheSlot *slot = slotOf(entry->Number, entry->Version);
+	if (slot)
+	{
+		Hits++;
+	}
+	else
+	{
+		// Not cached or saved since it was cached. A stale slot is reused unless a running macro still
+		// plays from it.
+		Misses++;
+		slot = victim(true);
+		if (!slot || !load(*slot, entry->Number))
+		{
+			return nullptr;
+		}
+	}
+	slot->LastUsed = ++_Uses;
+	slot->Pins++;
+	return slot;
+}
+
+void MacroCache::release(const MacroCacheSlot *slot)
+{
+	MacroCacheSlot &own = _Slots[slot - _Slots];
+	if (own.Pins > 0)
+	{
+		own.Pins--;
+	}
+	warm();
+}
+
+void MacroCache::warm()
+{
+	for (uint8_t i = 0; i < _MacroIndex.count(); i++)
+	{
+		const MacroIndexEntry &entry = _MacroIndex.entry(i);
+		if (!(entry.Flags & MacroFavorite) || slotOf(entry.Number, entry.Version))
+		{
+			continue;
+		}
+		MacroCacheSlot *slot = victim(false);
+		if (slot)
+		{
+			load(*slot, entry.Number);
+		}
+	}
+}
+
+void MacroCache::drop(uint16_t number)
+{
+	for (uint8_t i = 0; i < MACRO_CACHE_SLOTS; i++)
+	{
+		if (_Slots[i].Number == number && !_Slots[i].Pins)
+		{
+			_Slots[i].Number = 0;
+		}
+	}
+}
+
+uint8_t MacroCache::used() const
+{
+	uint8_t n = 0;
+	for (uint8_t i = 0; i < MACRO_CACHE_SLOTS; i++)
+	{
+		if (_Slots[i].Number)
+		{
+			n++;
+		}
+	}
+	return n;
+}
+
+uint8_t MacroCache::pinned() const
+{
+	uint8_t n = 0;
+	for (uint8_t i = 0; i < MACRO_CACHE_SLOTS; i++)
+	{
+		if (_Slots[i].Pins)
+		{
+			n++;
+		}
+	}
+	return n;
+}
@@ -0,0 +1,68 @@
+/*
+Aqua Control Library
+
+Creationdate: 2026-10-18
+RAM cache of parsed macros, so activation does not wait for the SD card.
+
+Further information on www.schullebernd.de
+*/
+
+#ifndef __MACROCACHE_H_
+#define __MACROCACHE_H_
+
+#include "AquaControl_config.h"
+#include <Arduino.h>
+#include "MacroFile.h"
+
+typedef struct
+{
+	uint16_t Number;	  // macro_NNN, 0 for a free slot
+	uint16_t ChannelMask; // As in the macro file
+	uint32_t Version;	  // Version of the index entry the targets were read for
+	uint32_t LastUsed;	  // Use counter of the cache when the slot was last hit
+	uint8_t Pins;		  // Running macro overlays on the targets, a pinned slot is neither evicted nor reloaded
+	uint16_t First[MACRO_FILE_CHANNELS]; // Records index of the first target of a channel
+	uint8_t Counts[MACRO_FILE_CHANNELS];
+	uint32_t Records[MACRO_CACHE_RECORDS]; // time << 8 | value, by channel and in time order within a channel
+} MacroCacheSlot;
+
+/* Holds up to MACRO_CACHE_SLOTS macros with their targets in RAM. Favorites (MacroFavorite in the index)
+   are loaded at boot and evicted only for a macro that is started, the other slots go to the least
+   recently used macro. A slot is only used while its Version matches the index entry, so a save or
+   delete invalidates it. Running macros play their targets straight from the slot (see MacroOverlay). */
+class MacroCache
+{
+public:
+	// The parsed macro, read from SD into a slot on a miss, and pinned until release(). nullptr if the
+	// macro is not in the index, can not be read or has more targets than MACRO_CACHE_RECORDS (saving
+	// rejects such macros, see macroCacheRecords()). A free overlay always finds an unpinned slot, as
+	// there are at least as many slots as overlays.
+	const MacroCacheSlot *acquire(const char *macroId);
+	// Unpins a slot of acquire(), favorites that made room for it are loaded again
+	void release(const MacroCacheSlot *slot);
+	// Loads the favorites that are not cached yet and refreshes stale slots of favorites
+	void warm();
+	// Drops the slot of a deleted macro
+	void drop(uint16_t number);
+
+	uint8_t used() const;
+	uint8_t pinned() const;
+	uint32_t Hits = 0;
+	uint32_t Misses = 0;
+
+private:
+	bool load(MacroCacheSlot &slot, uint16_t number);
+	MacroCacheSlot *slotOf(uint16_t number, uint32_t version);
+	MacroCacheSlot *victim(bool evictFavorites);
+
+	MacroCacheSlot _Slots[MACRO_CACHE_SLOTS];
+	uint32_t _Uses = 0;
+};
+
+extern MacroCache _MacroCache;
+
+// Records a cache slot needs for a macro with these target counts per channel. Only the channels this
+// controller has are loaded, each with up to MAX_TARGET_COUNT_PER_CHANNEL targets.
+uint16_t macroCacheRecords(const uint8_t *counts, uint8_t channels);
+
+#endif
@@ -0,0 +1,253 @@
+/*
+Aqua Control Library
+
+Creationdate: 2026-10-18
+Binary macro file, name, duration and the targets of all channels of a macro in one file.
+
+Further information on www.schullebernd.de
+*/
+
+#include "AquaControl.h"
+
+#define MACRO_FILE_BLOCK 16 // Records per read call
+
+void macroFilePath(char *dest, size_t size, const char *macroId)
+{
+	snprintf(dest, size, "macros/%s.mac", macroId);
+}
+
+bool MacroWriter::begin(const char *macroId)
+{
+	char path[ATOMIC_FILE_MAX_PATH];
+	macroFilePath(path, sizeof(path), macroId);
+	memset(&_Trailer, 0, sizeof(_Trailer));
+	_Crc = 0;
+	_LastTime = 0;
+	_Channel = -1;
+	_Failed = !_File.begin(path);
+	return !_Failed;
+}
+
+void MacroWriter::addChannel(uint8_t channel)
+{
+	if (channel < MACRO_FILE_CHANNELS)
+	{
+		_Trailer.ChannelMask |= 1 << channel;
+	}
+}
+
+bool MacroWriter::add(uint8_t channel, uint32_t time, uint8_t value)
+{
+	if (_Failed || channel >= MACRO_FILE_CHANNELS || (int8_t)channel < _Channel || _Trailer.Counts[channel] == 255)
+	{
+		return false;
+	}
+	_Channel = channel;
+	addChannel(channel);
+	time = min(time, (uint32_t)MACRO_FILE_MAX_TIME);
+	uint32_t record = (time << 8) | min(value, (uint8_t)100);
+	_Crc = crc32Update(_Crc, (const uint8_t *)&record, sizeof(record));
+	_File.write((const uint8_t *)&record, sizeof(record));
+	_Trailer.Counts[channel]++;
+	_LastTime = max(_LastTime, time);
+	return true;
+}
+
+bool MacroWriter::commit(const char *name, uint32_t duration)
+{
+	if (_Failed)
+	{
+		return false;
+	}
+	strncpy(_Trailer.Name, name, MACRO_NAME_LENGTH - 1);
+	_Trailer.Duration = duration > 0 ? duration : _LastTime;
+	_Trailer.Format = MACRO_FILE_FORMAT;
+	_Trailer.RecordSize = sizeof(uint32_t);
+	_Trailer.Magic = MACRO_FILE_MAGIC;
+	_Trailer.Crc = crc32Update(_Crc, (const uint8_t *)&_Trailer, offsetof(MacroFileTrailer, Crc));
+	_File.write((const uint8_t *)&_Trailer, sizeof(_Trailer));
+	_Failed = true;
+	return _File.commit();
+}
+
+bool MacroReader::open(const char *macroId)
+{
+	char path[ATOMIC_FILE_MAX_PATH];
+	macroFilePath(path, sizeof(path), macroId);
+	_File = SD.open(path);
+	if (!_File)
+	{
+		return false;
+	}
+
+	// Trailer first, it tells how many records the file must have
+	size_t size = _File.size();
+	bool ok = size >= sizeof(_Trailer) && _File.seek(size - sizeof(_Trailer)) &&
+			  (size_t)_File.read((uint8_t *)&_Trailer, sizeof(_Trailer)) == sizeof(_Trailer) &&
+			  _Trailer.Magic == MACRO_FILE_MAGIC && _Trailer.Format == MACRO_FILE_FORMAT &&
+			  _Trailer.RecordSize == sizeof(uint32_t);
+	uint32_t records = 0;
+	for (uint8_t ch = 0; ok && ch < MACRO_FILE_CHANNELS; ch++)
+	{
+		records += _Trailer.Counts[ch];
+	}
+	ok = ok && size == sizeof(_Trailer) + records * sizeof(uint32_t) && _File.seek(0);
+
+	// The file is small, checking the CRC before anything is used costs one extra read of it
+	uint32_t crc = 0;
+	uint32_t block[MACRO_FILE_BLOCK];
+	while (ok && records > 0)
+	{
+		size_t n = min(records, (uint32_t)MACRO_FILE_BLOCK) * sizeof(uint32_t);
+		ok = (size_t)_File.read((uint8_t *)block, n) == n;
+		crc = crc32Update(crc, (const uint8_t *)block, n);
+		records -= n / sizeof(uint32_t);
+	}
+	if (!ok || crc32Update(crc, (const uint8_t *)&_Trailer, offsetof(MacroFileTrailer, Crc)) != _Trailer.Crc)
+	{
+		Serial.print(F("Error: Macro file is invalid: "));
+		Serial.println(path);
+		_File.close();
+		return false;
+	}
+	_Trailer.Name[MACRO_NAME_LENGTH - 1] = '\0';
+	_Left = 0;
+	return true;
+}
+
+void MacroReader::close()
+{
+	if (_File)
+	{
+		_File.close();
+	}
+}
+
+bool MacroReader::channel(uint8_t channel)
+{
+	if (channel >= MACRO_FILE_CHANNELS)
+	{
+		_Left = 0;
+		return false;
+	}
+	uint32_t offset = 0;
+	for (uint8_t ch = 0; ch < channel; ch++)
+	{
+		offset += _Trailer.Counts[ch] * sizeof(uint32_t);
+	}
+	_Left = _Trailer.Counts[channel];
+	return _File.seek(offset);
+}
+
+bool MacroReader::next(uint32_t &time, uint8_t &value)
+{
+	uint32_t record;
+	if (_Left == 0 || _File.read((uint8_t *)&record, sizeof(record)) != sizeof(record))
+	{
+		return false;
+	}
+	_Left--;
+	time = record >> 8;
+	value = record & 0xFF;
+	return true;
+}
+
+// Helper: Name and duration from the old metadata file <id>.json, false if there is none
+static bool readLegacyMetadata(const char *macroId, char *name, size_t size, uint32_t &duration)
+{
+	char metadataPath[50];
+	sprintf(metadataPath, "macros/%s.json", macroId);
+	File metaFile = SD.open(metadataPath);
+	if (!metaFile)
+	{
+		return false;
+	}
+	// {"name":"...","duration":N}, a name longer than the buffer loses the duration
+	char json[MACRO_NAME_LENGTH + 48];
+	size_t len = metaFile.read((uint8_t *)json, sizeof(json) - 1);
+	json[len] = '\0';
+	metaFile.close();
+
+	const char *rest = json;
+	char *nameStart = strstr(json, "\"name\":\"");
+	if (nameStart)
+	{
+		nameStart += 8;
+		char *nameEnd = strchr(nameStart, '"');
+		size_t nameLen = nameEnd ? (size_t)(nameEnd - nameStart) : strlen(nameStart);
+		nameLen = min(nameLen, size - 1);
+		memcpy(name, nameStart, nameLen);
+		name[nameLen] = '\0';
+		rest = nameEnd ? nameEnd : json + len;
+	}
+	const char *durStart = strstr(rest, "\"duration\":");
+	if (durStart)
+	{
+		duration = strtoul(durStart + 11, nullptr, 10);
+	}
+	return true;
+}
+
+bool convertLegacyMacro(const char *macroId)
+{
+	MacroWriter writer;
+	if (!writer.begin(macroId))
+	{
+		return false;
+	}
+	char path[50];
+	for (uint8_t ch = 0; ch < min(PWM_CHANNELS, MACRO_FILE_CHANNELS); ch++)
+	{
+		sprintf(path, "macros/%s_ch%02d.cfg", macroId, ch);
+		File macroFile = SD.open(path);
+		if (!macroFile)
+		{
+			continue;
+		}
+		// add() sorts the targets and caps them like activation always did
+		ScheduleSnapshot sorted;
+		ConfigReader reader(macroFile);
+		long timeVal;
+		int value;
+		while (reader.next())
+		{
+			if (reader.record(timeVal, value, ConfigDuration))
+			{
+				Target t;
+				t.Time = timeVal;
+				t.Value = (uint8_t)value;
+				sorted.add(t);
+			}
+		}
+		macroFile.close();
+		writer.addChannel(ch);
+		for (uint8_t t = 0; t < sorted.Count; t++)
+		{
+			writer.add(ch, sorted.Targets[t].Time, sorted.Targets[t].Value);
+		}
+	}
+
+	char name[MACRO_NAME_LENGTH];
+	strncpy(name, macroId, sizeof(name) - 1);
+	name[sizeof(name) - 1] = '\0';
+	uint32_t duration = 0;
+	readLegacyMetadata(macroId, name, sizeof(name), duration);
+	if (!writer.commit(name, duration))
+	{
+		Serial.print(F("Error: Couldn't convert macro "));
+		Serial.println(macroId);
+		return false;
+	}
+
+	// The new file is complete, a reset from here on only leaves old files behind that are converted again
+	for (uint8_t ch = 0; ch < PWM_CHANNELS; ch++)
+	{
+		sprintf(path, "macros/%s_ch%02d.cfg", macroId, ch);
+		SD.remove(path);
+	}
+	sprintf(path, "macros/%s.json", macroId);
+	SD.remove(path);
+	Serial.print(F("Converted macro "));
+	Serial.println(macroId);
+	return true;
+}
@@ -0,0 +1,87 @@
+/*
+Aqua Control Library
+
+Creationdate: 2026-10-18
+Binary macro file, name, duration and the targets of all channels of a macro in one file.
+
+Further information on www.schullebernd.de
+*/
+
+#ifndef __MACROFILE_H_
+#define __MACROFILE_H_
+
+#include "AquaControl_config.h"
+#include <Arduino.h>
+#include <SD.h>
+#include "AtomicFile.h"
+
+#define MACRO_FILE_MAGIC 0x434D5141UL // "AQMC"
+#define MACRO_FILE_FORMAT 1
+#define MACRO_FILE_CHANNELS 16
+#define MACRO_FILE_MAX_TIME 0xFFFFFFUL // Records hold 24 bits of time
+
+/* File layout (little endian), macros/<id>.mac:
+     uint32_t records, time since the start of the macro in seconds << 8 | value (0-100),
+              grouped by channel in ascending order and in time order within a channel
+     MacroFileTrailer
+   The trailer is written last, so the writer streams the targets without knowing their number up front.
+   Crc covers the records followed by the trailer up to Crc. The file is replaced with AtomicFileWriter. */
+typedef struct
+{
+	char Name[MACRO_NAME_LENGTH];
+	uint8_t Counts[MACRO_FILE_CHANNELS]; // Targets per channel
+	uint32_t Duration;					 // Seconds
+	uint16_t ChannelMask;				 // Bit n is set if channel n is part of the macro
+	uint8_t Format;
+	uint8_t RecordSize;
+	uint32_t Magic;
+	uint32_t Crc;
+} MacroFileTrailer;
+
+// Builds the path of the macro file of macroId
+void macroFilePath(char *dest, size_t size, const char *macroId);
+
+/* Writes a macro file. Call add() for the targets channel by channel in ascending order, a channel
+   without add() calls is not part of the macro unless addChannel() names it. */
+class MacroWriter
+{
+public:
+	bool begin(const char *macroId);
+	void addChannel(uint8_t channel);
+	bool add(uint8_t channel, uint32_t time, uint8_t value);
+	// Writes the trailer and swaps the file in, a duration of 0 is taken from the latest target
+	bool commit(const char *name, uint32_t duration);
+	void abort() { _File.abort(); }
+	const MacroFileTrailer &info() const { return _Trailer; }
+
+private:
+	AtomicFileWriter _File;
+	MacroFileTrailer _Trailer;
+	uint32_t _Crc = 0;
+	uint32_t _LastTime = 0;
+	int8_t _Channel = -1;
+	bool _Failed = true;
+};
+
+/* Reads a macro file. open() checks the trailer and the CRC, channel() then positions at the first
+   target of a channel and next() returns its targets in time order. */
+class MacroReader
+{
+public:
+	bool open(const char *macroId);
+	void close();
+	const MacroFileTrailer &info() const { return _Trailer; }
+	bool channel(uint8_t channel);
+	bool next(uint32_t &time, uint8_t &value);
+
+private:
+	File _File;
+	MacroFileTrailer _Trailer;
+	uint8_t _Left = 0; // Targets of the current channel not read yet
+};
+
+// Writes the macro file of a macro in the old layout (<id>_chNN.cfg and <id>.json) and removes the
+// old files once the new one is complete
+bool convertLegacyMacro(const char *macroId);
+
+#endif
@@ -0,0 +1,416 @@
+/*
+Aqua Control Library
+
+Creationdate: 2026-10-18
+Manifest of the stored macros, kept in RAM and in macros/index.
+
+Further information on www.schullebernd.de
+*/
+
+#include "AquaControl.h"
+
+MacroIndex _MacroIndex;
+
+#define MACRO_REBUILD_LEGACY 0x80 // Flag of entries whose macro is still in the old layout, only used by rebuild()
+
+bool parseMacroNumber(const char *macroId, uint16_t &number)
+{
+	if (strncmp(macroId, "macro_", 6) != 0 || strlen(macroId) != 9)
+	{
+		return false;
+	}
+	number = 0;
+	for (uint8_t i = 6; i < 9; i++)
+	{
+		if (macroId[i] < '0' || macroId[i] > '9')
+		{
+			return false;
+		}
+		number = number * 10 + (macroId[i] - '0');
+	}
+	return number > 0;
+}
+
+// Helper: Fills a rebuilt entry from the trailer of its macro file, false if the file is unusable
+static bool readEntry(MacroIndexEntry &entry)
+{
+	char macroId[16];
+	sprintf(macroId, "macro_%03u", entry.Number);
+	MacroReader reader;
+	if (!reader.open(macroId))
+	{
+		return false;
+	}
+	const MacroFileTrailer &info = reader.info();
+	memcpy(entry.Name, info.Name, MACRO_NAME_LENGTH);
+	entry.Duration = info.Duration;
+	entry.ChannelMask = info.ChannelMask;
+	reader.close();
+	return true;
+}
+
+// Helper: Completes or discards the swaps of macro files that a reset interrupted. Macro files are
+// written like any atomic file (<file>.tmp, then <file>.new), so only the temp names are looked for.
+// The directory is read first and changed afterwards. True if there was anything to recover.
+static bool recoverMacroFiles()
+{
+	File dir = SD.open("macros");
+	if (!dir)
+	{
+		return false;
+	}
+	uint8_t pending[(999 + 8) / 8];
+	memset(pending, 0, sizeof(pending));
+	bool any = false;
+	File file;
+	while ((file = dir.openNextFile()))
+	{
+		unsigned int number;
+		int end = 0;
+		const char *name = file.name();
+		if (!file.isDirectory() && sscanf(name, "macro_%3u.mac%n", &number, &end) == 1 && end == 13 &&
+			(strcmp(name + end, ".new") == 0 || strcmp(name + end, ".tmp") == 0) && number > 0 && number <= 999)
+		{
+			pending[(number - 1) / 8] |= 1 << ((number - 1) % 8);
+			any = true;
+		}
+		file.close();
+	}
+	dir.close();
+	for (uint16_t number = 1; any && number <= 999; number++)
+	{
+		if (pending[(number - 1) / 8] & (1 << ((number - 1) % 8)))
+		{
+			char macroId[16];
+			char path[ATOMIC_FILE_MAX_PATH];
+			sprintf(macroId, "macro_%03u", number);
+			macroFilePath(path, sizeof(path), macroId);
+			recoverAtomicFile(path);
+		}
+	}
+	return any;
+}
+
+void MacroIndex::begin()
+{
+	recoverAtomicFile(MACRO_INDEX_PATH);
+	if (load())
+	{
+		_Loaded = true;
+		// A macro save cut short by a reset may have changed a macro file behind the index
+		if (recoverMacroFiles())
+		{
+			rebuild();
+		}
+		return;
+	}
+	Serial.println(F("Macro index missing or invalid, rebuilding it"));
+	rebuild();
+}
+
+bool MacroIndex::load()
+{
+	File file = SD.open(MACRO_INDEX_PATH);
+	if (!file)
+	{
+		return false;
+	}
+	MacroIndexHeader header;
+	bool ok = file.read((uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+			  header.Magic == MACRO_INDEX_MAGIC && header.Format == MACRO_INDEX_FORMAT &&
+			  header.EntrySize == sizeof(MacroIndexEntry) && header.Count <= MACRO_INDEX_CAPACITY &&
+			  file.size() == sizeof(header) + header.Count * sizeof(MacroIndexEntry);
+	if (ok)
+	{
+		size_t size = header.Count * sizeof(MacroIndexEntry);
+		ok = (size_t)file.read((uint8_t *)_Entries, size) == size &&
+			 crc32Update(0, (const uint8_t *)_Entries, size) == header.Crc;
+	}
+	file.close();
+	if (!ok)
+	{
+		_Count = 0;
+		return false;
+	}
+	_Count = header.Count;
+	_Generation = header.Generation;
+	return true;
+}
+
+bool MacroIndex::save()
+{
+	MacroIndexHeader header;
+	header.Magic = MACRO_INDEX_MAGIC;
+	header.Format = MACRO_INDEX_FORMAT;
+	header.Count = _Count;
+	header.EntrySize = sizeof(MacroIndexEntry);
+	header.Reserved = 0;
+	header.Generation = _Generation;
+	header.Crc = crc32Update(0, (const uint8_t *)_Entries, _Count * sizeof(MacroIndexEntry));
+
+	AtomicFileWriter file;
+	if (!file.begin(MACRO_INDEX_PATH))
+	{
+		return false;
+	}
+	file.write((const uint8_t *)&header, sizeof(header));
+	file.write((const uint8_t *)_Entries, _Count * sizeof(MacroIndexEntry));
+	if (!file.commit())
+	{
+		Serial.println(F("Error: Couldn't write the macro index"));
+		return false;
+	}
+	Writes++;
+	return true;
+}
+
+bool MacroIndex::rebuild()
+{
+	// One pass over the directory collects the macro files, so unused numbers cost nothing.
+	// Entries stay ordered by number like the listing always was. Favorites are not part of the macro
+	// files, they are carried over from the entries in RAM.
+	uint16_t favorites[MACRO_INDEX_CAPACITY];
+	uint8_t favoriteCount = 0;
+	for (uint8_t i = 0; i < _Count; i++)
+	{
+		if (_Entries[i].Flags & MacroFavorite)
+		{
+			favorites[favoriteCount++] = _Entries[i].Number;
+		}
+	}
+	_Count = 0;
+	_Generation++;
+	_Loaded = true;
+	_Stale = false;
+	Rebuilds++;
+	Skipped = 0;
+
+	recoverMacroFiles();
+	File dir = SD.open("macros");
+	if (!dir)
+	{
+		return true; // No macros yet, the index is written with the first one
+	}
+	// Macros still in the old layout (one text file per channel) are flagged and converted after the
+	// scan, the directory must not change while it is read
+	File file;
+	while ((file = dir.openNextFile()))
+	{
+		unsigned int number;
+		unsigned int channel;
+		int end = 0;
+		const char *name = file.name();
+		// Only the exact names count, temp files (macro_NNN.mac.tmp/.new) are not macros
+		bool binary = sscanf(name, "macro_%3u.mac%n", &number, &end) == 1 && end == 13 && name[end] == '\0';
+		end = 0;
+		bool legacy = !binary && sscanf(name, "macro_%3u_ch%2u.cfg%n", &number, &channel, &end) == 2 && end == 18 &&
+					  name[end] == '\0';
+		if (!file.isDirectory() && (binary || legacy) && number > 0 && number <= 999)
+		{
+			// Macro files are checked right away, so a damaged one does not take the place of a valid one
+			MacroIndexEntry checked;
+			memset(&checked, 0, sizeof(checked));
+			checked.Number = number;
+			if (binary && !readEntry(checked))
+			{
+				file.close();
+				continue;
+			}
+			int8_t i = indexOf(number);
+			bool added = i < 0;
+			if (added)
+			{
+				if (_Count >= MACRO_INDEX_CAPACITY)
+				{
+					Serial.print(F("Warning: Macro index is full, skipping macro "));
+					Serial.println(number);
+					Skipped++;
+					file.close();
+					continue;
+				}
+				// Insert ordered by number
+				i = _Count;
+				while (i > 0 && _Entries[i - 1].Number > number)
+				{
+					_Entries[i] = _Entries[i - 1];
+					i--;
+				}
+				_Entries[i] = checked;
+				_Count++;
+			}
+			// A macro file wins over old files of the same macro
+			if (binary)
+			{
+				_Entries[i] = checked;
+			}
+			else if (added)
+			{
+				_Entries[i].Flags = MACRO_REBUILD_LEGACY;
+			}
+		}
+		file.close();
+	}
+	dir.close();
+
+	uint8_t kept = 0;
+	for (uint8_t i = 0; i < _Count; i++)
+	{
+		MacroIndexEntry &entry = _Entries[i];
+		char macroId[16];
+		sprintf(macroId, "macro_%03u", entry.Number);
+		// Legacy macros are converted now that the directory is closed and read like the others
+		if ((entry.Flags & MACRO_REBUILD_LEGACY) && (!convertLegacyMacro(macroId) || !readEntry(entry)))
+		{
+			continue; // Leave the files alone, an unreadable macro just is not listed
+		}
+		entry.Version = _Generation;
+		entry.Flags = 0;
+		for (uint8_t f = 0; f < favoriteCount; f++)
+		{
+			if (favorites[f] == entry.Number)
+			{
+				entry.Flags |= MacroFavorite;
+			}
+		}
+		_Entries[kept++] = entry;
+	}
+	_Count = kept;
+	Serial.print(F("Macro index rebuilt, "));
+	Serial.print(_Count);
+	Serial.println(F(" macros"));
+	if (Skipped > 0)
+	{
+		Serial.print(F("Warning: "));
+		Serial.print(Skipped);
+		Serial.println(F(" macro files are not listed, raise MACRO_INDEX_CAPACITY"));
+	}
+	return save();
+}
+
+bool MacroIndex::ensure()
+{
+	if (_Stale)
+	{
+		// Favorites are carried over from the entries in RAM, so an index that was never read is read first
+		if (!_Loaded)
+		{
+			load();
+		}
+		rebuild();
+	}
+	else if (!_Loaded)
+	{
+		begin();
+	}
+	return _Loaded;
+}
+
+int8_t MacroIndex::indexOf(uint16_t number) const
+{
+	for (uint8_t i = 0; i < _Count; i++)
+	{
+		if (_Entries[i].Number == number)
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+uint8_t MacroIndex::count()
+{
+	ensure();
+	return _Count;
+}
+
+const MacroIndexEntry *MacroIndex::find(uint16_t number)
+{
+	ensure();
+	int8_t i = indexOf(number);
+	return i < 0 ? nullptr : &_Entries[i];
+}
+
+const MacroIndexEntry *MacroIndex::find(const char *macroId)
+{
+	uint16_t number;
+	return parseMacroNumber(macroId, number) ? find(number) : nullptr;
+}
+
+uint16_t MacroIndex::nextFreeNumber()
+{
+	ensure();
+	if (_Count >= MACRO_INDEX_CAPACITY)
+	{
+		return 0;
+	}
+	// Entries are ordered, the first gap is the lowest free number
+	uint16_t number = 1;
+	for (uint8_t i = 0; i < _Count && _Entries[i].Number == number; i++)
+	{
+		number++;
+	}
+	return number <= 999 ? number : 0;
+}
+
+bool MacroIndex::put(uint16_t number, const char *name, uint32_t duration, uint16_t channelMask)
+{
+	ensure();
+	int8_t i = indexOf(number);
+	if (i < 0)
+	{
+		if (_Count >= MACRO_INDEX_CAPACITY)
+		{
+			return false;
+		}
+		i = _Count;
+		while (i > 0 && _Entries[i - 1].Number > number)
+		{
+			_Entries[i] = _Entries[i - 1];
+			i--;
+		}
+		_Count++;
+		memset(&_Entries[i], 0, sizeof(MacroIndexEntry));
+	}
+	MacroIndexEntry &entry = _Entries[i];
+	entry.Number = number;
+	entry.ChannelMask = channelMask;
+	entry.Duration = duration;
+	strncpy(entry.Name, name, MACRO_NAME_LENGTH - 1);
+	entry.Version = ++_Generation;
+	return save();
+}
+
+bool MacroIndex::setFavorite(uint16_t number, bool favorite)
+{
+	ensure();
+	int8_t i = indexOf(number);
+	if (i < 0)
+	{
+		return false;
+	}
+	uint8_t flags = favorite ? (_Entries[i].Flags | MacroFavorite) : (_Entries[i].Flags & ~MacroFavorite);
+	if (flags == _Entries[i].Flags)
+	{
+		return true;
+	}
+	_Entries[i].Flags = flags;
+	_Generation++;
+	return save();
+}
+
+bool MacroIndex::remove(uint16_t number)
+{
+	ensure();
+	int8_t i = indexOf(number);
+	if (i < 0)
+	{
+		return true;
+	}
+	for (; i < _Count - 1; i++)
+	{
+		_Entries[i] = _Entries[i + 1];
+	}
+	_Count--;
+	_Generation++;
+	return save();
+}
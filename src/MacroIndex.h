@@ -0,0 +1,101 @@
+/*
+Aqua Control Library
+
+Creationdate: 2026-10-18
+Manifest of the stored macros, kept in RAM and in macros/index.
+
+Further information on www.schullebernd.de
+*/
+
+#ifndef __MACROINDEX_H_
+#define __MACROINDEX_H_
+
+#include "AquaControl_config.h"
+#include <Arduino.h>
+
+#define MACRO_INDEX_PATH "macros/index"
+#define MACRO_INDEX_MAGIC 0x494D5141UL // "AQMI"
+#define MACRO_INDEX_FORMAT 3
+
+/* File layout (little endian):
+     MacroIndexHeader
+     MacroIndexEntry[Count], ordered by Number
+   Crc covers the entries. The file is replaced with AtomicFileWriter on every change. */
+typedef struct
+{
+	uint32_t Magic;
+	uint8_t Format;
+	uint8_t Count;
+	uint8_t EntrySize;
+	uint8_t Reserved;
+	uint32_t Generation; // Increases with every change of the index
+	uint32_t Crc;
+} MacroIndexHeader;
+
+enum MacroIndexFlags : uint8_t
+{
+	MacroFavorite = 0x01, // Pinned in the macro cache
+};
+
+typedef struct
+{
+	uint16_t Number;	  // macro_NNN
+	uint16_t ChannelMask; // Bit n is set if channel n is part of the macro
+	uint32_t Duration;	  // Seconds
+	uint32_t Version;	  // Generation of the index when the macro was saved
+	uint8_t Flags;		  // MacroIndexFlags
+	uint8_t Reserved[3];
+	char Name[MACRO_NAME_LENGTH];
+} MacroIndexEntry;
+
+/* Listing the macros used to probe up to 999 file names on SD and to read the metadata of every hit.
+   The index answers that from RAM. Save and delete update it (the index file is swapped atomically),
+   a missing or damaged file is rebuilt from one pass over the macros directory and the trailers of
+   the macro files. Macros in the old layout are converted on the way. */
+class MacroIndex
+{
+public:
+	// Loads the index file or rebuilds it
+	void begin();
+	// Scans the macros directory and writes a new index file
+	bool rebuild();
+	// Files in macros/ changed behind the index (upload), it is rebuilt on the next access
+	void invalidate() { _Stale = true; }
+
+	uint8_t count();
+	const MacroIndexEntry &entry(uint8_t i) const { return _Entries[i]; }
+	const MacroIndexEntry *find(uint16_t number);
+	const MacroIndexEntry *find(const char *macroId);
+	// Lowest unused macro number, 0 if the index is full
+	uint16_t nextFreeNumber();
+
+	// Adds or replaces the entry of a macro whose file was written, the flags are kept
+	bool put(uint16_t number, const char *name, uint32_t duration, uint16_t channelMask);
+	bool setFavorite(uint16_t number, bool favorite);
+	// Removes the entry, call before the file is deleted
+	bool remove(uint16_t number);
+
+	uint32_t Generation() const { return _Generation; }
+	uint32_t Rebuilds = 0;
+	uint32_t Writes = 0;
+	uint16_t Skipped = 0; // Macro files the last rebuild left out because the index was full
+
+private:
+	bool ensure();
+	bool load();
+	bool save();
+	int8_t indexOf(uint16_t number) const;
+
+	MacroIndexEntry _Entries[MACRO_INDEX_CAPACITY];
+	uint8_t _Count = 0;
+	uint32_t _Generation = 0;
+	bool _Loaded = false;
+	bool _Stale = false; // The index file does not match macros/ any more, see invalidate()
+};
+
+extern MacroIndex _MacroIndex;
+
+// Reads the number of a "macro_NNN" id, false for any other id
+bool parseMacroNumber(const char *macroId, uint16_t &number);
+
+#endif
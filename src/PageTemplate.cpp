@@ -0,0 +1,120 @@
+/*
+Aqua Control Library
+
+Creationdate: 2026-10-18
+Placeholder index for the HTML page templates on SD.
+
+Further information on www.schullebernd.de
+*/
+
+#include "AquaControl.h"
+
+#if defined(USE_WEBSERVER)
+
+// Placeholder names in PageTemplateTag order
+static const char TAG_FW_VERSION[] PROGMEM = "FW_VERSION";
+static const char TAG_TEMP[] PROGMEM = "TEMP";
+static const char *const TAG_NAMES[PageTemplateTagCount] PROGMEM = {TAG_FW_VERSION, TAG_TEMP};
+
+void PageTemplate::addSlot(uint32_t offset, uint8_t length, const char *name)
+{
+	for (uint8_t tag = 0; tag < PageTemplateTagCount; tag++)
+	{
+		if (strcmp_P(name, (PGM_P)pgm_read_ptr(&TAG_NAMES[tag])) == 0)
+		{
+			if (SlotCount < PAGE_TEMPLATE_MAX_SLOTS)
+			{
+				Slots[SlotCount].Offset = offset;
+				Slots[SlotCount].Length = length;
+				Slots[SlotCount].Tag = tag;
+				SlotCount++;
+				PlaceholderBytes += length;
+			}
+			return;
+		}
+	}
+}
+
+void PageTemplate::refresh(File &f, uint8_t *buf, size_t bufSize)
+{
+	size_t size = f.size();
+	time_t lastWrite = f.getLastWrite();
+	if (_Valid && size == _Size && lastWrite == _LastWrite)
+	{
+		return;
+	}
+
+	SlotCount = 0;
+	PlaceholderBytes = 0;
+
+	// Scan for ##NAME## with a small state machine, so markers may span read blocks
+	enum
+	{
+		ScanText,
+		ScanOpen,
+		ScanName,
+		ScanClose
+	} state = ScanText;
+	char name[PAGE_TEMPLATE_MAX_NAME + 1];
+	uint8_t nameLen = 0;
+	uint32_t start = 0;
+	uint32_t pos = 0;
+
+	f.seek(0);
+	int n;
+	while ((n = f.read(buf, bufSize)) > 0)
+	{
+		for (int i = 0; i < n; i++, pos++)
+		{
+			char c = (char)buf[i];
+			switch (state)
+			{
+			case ScanText:
+				if (c == '#')
+					state = ScanOpen;
+				break;
+			case ScanOpen:
+				if (c == '#')
+				{
+					state = ScanName;
+					start = pos - 1;
+					nameLen = 0;
+				}
+				else
+					state = ScanText;
+				break;
+			case ScanName:
+				if (c == '#' && nameLen > 0)
+					state = ScanClose;
+				else if (c == '#')
+					start = pos - 1; // "###" shifts the opening marker
+				else if ((isupper(c) || isdigit(c) || c == '_') && nameLen < PAGE_TEMPLATE_MAX_NAME)
+					name[nameLen++] = c;
+				else
+					state = ScanText;
+				break;
+			case ScanClose:
+				if (c == '#')
+				{
+					name[nameLen] = '\0';
+					addSlot(start, (uint8_t)(pos - start + 1), name);
+					state = ScanText;
+				}
+				else
+					state = ScanText;
+				break;
+			}
+		}
+	}
+
+	_Size = size;
+	_LastWrite = lastWrite;
+	_Valid = true;
+	Serial.print(F("Indexed template "));
+	Serial.print(Path);
+	Serial.print(F(": "));
+	Serial.print(SlotCount);
+	Serial.println(F(" placeholders"));
+}
+
+#endif
@@ -0,0 +1,65 @@
+/*
+Aqua Control Library
+
+Creationdate: 2026-10-18
+Placeholder index for the HTML page templates on SD.
+
+Further information on www.schullebernd.de
+*/
+
+#ifndef __PAGETEMPLATE_H_
+#define __PAGETEMPLATE_H_
+
+#include "AquaControl_config.h"
+#include <Arduino.h>
+#include <FS.h>
+
+/* Maximum number of placeholders indexed per template. Placeholders beyond are sent unchanged. */
+#define PAGE_TEMPLATE_MAX_SLOTS 8
+/* Maximum length of a placeholder name between the ## markers */
+#define PAGE_TEMPLATE_MAX_NAME 16
+
+// Known placeholders (##FW_VERSION##, ##TEMP##)
+enum PageTemplateTag : uint8_t
+{
+	PageTemplateFwVersion = 0,
+	PageTemplateTemp,
+	PageTemplateTagCount
+};
+
+// One placeholder occurrence in the template file
+struct PageTemplateSlot
+{
+	uint32_t Offset; // Byte offset of the leading ##
+	uint8_t Length;	 // Length including both ## markers
+	uint8_t Tag;	 // PageTemplateTag
+};
+
+/* Byte offsets of all placeholders of one template file.
+   The file is scanned once and rescanned only when its size or modification time changes,
+   so serving the page only has to copy the static spans and insert the dynamic values. */
+class PageTemplate
+{
+public:
+	PageTemplate(const char *path) : Path(path) {}
+
+	// Rescans the open file if it changed since the last scan
+	void refresh(File &f, uint8_t *buf, size_t bufSize);
+	// Forces a rescan on the next refresh (e.g. after an upload)
+	void invalidate() { _Valid = false; }
+
+	const char *Path;
+	PageTemplateSlot Slots[PAGE_TEMPLATE_MAX_SLOTS];
+	uint8_t SlotCount = 0;
+	// Sum of all placeholder lengths (subtracted from the file size for the content length)
+	uint32_t PlaceholderBytes = 0;
+
+private:
+	void addSlot(uint32_t offset, uint8_t length, const char *name);
+
+	bool _Valid = false;
+	size_t _Size = 0;
+	time_t _LastWrite = 0;
+};
+
+#endif
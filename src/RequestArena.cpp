@@ -0,0 +1,87 @@
+/*
+Aqua Control Library
+
+Creationdate: 2026-10-18
+Per-request scratch arena for the web handlers.
+
+Further information on www.schullebernd.de
+*/
+
+#include "AquaControl.h"
+
+#if defined(USE_WEBSERVER)
+
+RequestArena _Arena;
+
+void *RequestArena::alloc(size_t size)
+{
+	size_t aligned = (size + 3) & ~((size_t)3);
+	if (aligned > REQUEST_ARENA_SIZE - _Used)
+	{
+		_Failures++;
+		return nullptr;
+	}
+	void *p = &_Buffer[_Used];
+	_Used += aligned;
+	if (_Used > _HighWater)
+	{
+		_HighWater = _Used;
+	}
+	return p;
+}
+
+char *RequestArena::allocString(size_t capacity)
+{
+	char *s = (char *)alloc(capacity + 1);
+	if (s)
+	{
+		s[0] = '\0';
+	}
+	return s;
+}
+
+char *RequestArena::copy(const char *src, size_t len)
+{
+	char *s = (char *)alloc(len + 1);
+	if (s)
+	{
+		memcpy(s, src, len);
+		s[len] = '\0';
+	}
+	return s;
+}
+
+char *RequestArena::format(const char *fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	int len = vsnprintf(nullptr, 0, fmt, args);
+	va_end(args);
+	if (len < 0)
+	{
+		return nullptr;
+	}
+	char *s = (char *)alloc(len + 1);
+	if (s)
+	{
+		va_start(args, fmt);
+		vsnprintf(s, len + 1, fmt, args);
+		va_end(args);
+	}
+	return s;
+}
+
+void RequestArena::rewind(size_t mark)
+{
+	if (mark <= _Used)
+	{
+		_Used = mark;
+	}
+}
+
+void RequestArena::reset()
+{
+	_Used = 0;
+}
+
+#endif
@@ -0,0 +1,51 @@
+/*
+Aqua Control Library
+
+Creationdate: 2026-10-18
+Per-request scratch arena for the web handlers.
+
+Further information on www.schullebernd.de
+*/
+
+#ifndef __REQUESTARENA_H_
+#define __REQUESTARENA_H_
+
+#include "AquaControl_config.h"
+#include <Arduino.h>
+
+/* Fixed, preallocated bump allocator for short-lived handler data (paths, names, file contents).
+   Allocations are never freed individually. The whole arena is reset after each handled request,
+   so handler scratch data never touches the heap and cannot fragment it.
+   Nested loops can release their scratch space early with mark() / rewind(). */
+class RequestArena
+{
+public:
+	// Returns 4 byte aligned memory or nullptr if the arena is exhausted
+	void *alloc(size_t size);
+	// Returns an empty, zero terminated buffer with room for capacity chars (plus terminator)
+	char *allocString(size_t capacity);
+	// Copies len chars of src into the arena and terminates the copy
+	char *copy(const char *src, size_t len);
+	char *copy(const char *src) { return copy(src, strlen(src)); }
+	// printf into the arena, the buffer is sized to fit
+	char *format(const char *fmt, ...);
+
+	size_t mark() const { return _Used; }
+	void rewind(size_t mark);
+	void reset();
+
+	size_t used() const { return _Used; }
+	size_t capacity() const { return REQUEST_ARENA_SIZE; }
+	size_t highWater() const { return _HighWater; }
+	uint32_t failures() const { return _Failures; }
+
+private:
+	alignas(4) uint8_t _Buffer[REQUEST_ARENA_SIZE];
+	size_t _Used = 0;
+	size_t _HighWater = 0;
+	uint32_t _Failures = 0;
+};
+
+extern RequestArena _Arena;
+
+#endif // #ifndef __REQUESTARENA_H_
@@ -0,0 +1,233 @@
+/*
+Aqua Control Library
+
+Creationdate: 2026-10-18
+Resumable response streaming for long web responses.
+
+Further information on www.schullebernd.de
+*/
+
+#include "AquaControl.h"
+
+#if defined(USE_WEBSERVER)
+
+extern "C" ESP8266WebServer _Server;
+
+ResponseJobs _Jobs;
+
+// Helper: Reason phrases of the status codes the jobs and static files use
+static const char *reasonPhrase(int code)
+{
+	switch (code)
+	{
+	case 200:
+		return "OK";
+	case 206:
+		return "Partial Content";
+	case 304:
+		return "Not Modified";
+	case 404:
+		return "Not Found";
+	case 416:
+		return "Range Not Satisfiable";
+	default:
+		return "Status";
+	}
+}
+
+void writeResponseHead(WiFiClient &client, int code, const char *contentType, long contentLength, const char *headers)
+{
+	char line[128];
+	int len = snprintf(line, sizeof(line), "HTTP/1.1 %d %s\r\n", code, reasonPhrase(code));
+	if (contentType)
+		len += snprintf(line + len, sizeof(line) - len, "Content-Type: %s\r\n", contentType);
+	if (contentLength >= 0)
+		len += snprintf(line + len, sizeof(line) - len, "Content-Length: %ld\r\n", contentLength);
+	len += snprintf(line + len, sizeof(line) - len, "Connection: close\r\n");
+
+	// Streamed bodies are written in small pieces, which must not wait for delayed acks
+	client.setNoDelay(true);
+
+	// Assemble the head in one buffer, separate small writes would be held back by Nagle
+	size_t headersLen = headers ? strlen(headers) : 0;
+	size_t arenaMark = _Arena.mark();
+	char *head = (char *)_Arena.alloc(len + headersLen + 3);
+	if (head)
+	{
+		memcpy(head, line, len);
+		memcpy(head + len, headers, headersLen);
+		memcpy(head + len + headersLen, "\r\n", 2);
+		client.write((const uint8_t *)head, len + headersLen + 2);
+	}
+	else
+	{
+		client.write((const uint8_t *)line, len);
+		if (headersLen)
+			client.write((const uint8_t *)headers, headersLen);
+		client.write((const uint8_t *)"\r\n", 2);
+	}
+	_Arena.rewind(arenaMark);
+}
+
+size_t ResponseJob::writable()
+{
+	int available = Client.availableForWrite();
+	if (available <= 0)
+		return 0;
+	return (size_t)available < RESPONSE_JOB_SLICE_BYTES ? (size_t)available : RESPONSE_JOB_SLICE_BYTES;
+}
+
+size_t ResponseJob::sendFile(size_t maxBytes)
+{
+	size_t n = writable();
+	if (maxBytes < n)
+		n = maxBytes;
+	if (n == 0)
+		return 0;
+
+	size_t arenaMark = _Arena.mark();
+	uint8_t stackBuf[128];
+	uint8_t *buf = (uint8_t *)_Arena.alloc(n);
+	if (!buf)
+	{
+		buf = stackBuf;
+		if (n > sizeof(stackBuf))
+			n = sizeof(stackBuf);
+	}
+	size_t sent = 0;
+	int read = Source.read(buf, n);
+	if (read > 0)
+		sent = Client.write(buf, read);
+	if (read <= 0 || sent != (size_t)read)
+		Failed = true;
+	else
+		LastProgress = millis();
+	_Arena.rewind(arenaMark);
+	return sent;
+}
+
+void ResponseJob::print(const char *text)
+{
+	Client.write((const uint8_t *)text, strlen(text));
+	LastProgress = millis();
+}
+
+void ResponseJob::print_P(PGM_P text)
+{
+	Client.write_P(text, strlen_P(text));
+	LastProgress = millis();
+}
+
+ResponseJob *ResponseJobs::start(ResponseJobStep step, uint8_t priority, File source, uint32_t remaining,
+								 uint32_t position, int32_t value)
+{
+	ResponseJob *job = nullptr;
+	for (uint8_t i = 0; i < RESPONSE_JOB_SLOTS; i++)
+	{
+		if (!_Slots[i].active())
+		{
+			job = &_Slots[i];
+			break;
+		}
+	}
+	Started++;
+
+	// All slots busy: produce the response right here, like a plain handler would
+	ResponseJob inlineJob;
+	if (!job)
+	{
+		Inline++;
+		job = &inlineJob;
+	}
+
+	job->Step = step;
+	job->Priority = priority;
+	job->Client = _Server.client();
+	job->Source = source;
+	job->Position = position;
+	job->Remaining = remaining;
+	job->Count = 0;
+	job->Stage = 0;
+	job->Value = value;
+	job->Failed = false;
+	job->LastProgress = millis();
+
+	if (job == &inlineJob)
+	{
+		bool more = true;
+		while (more && !inlineJob.Failed && inlineJob.Client.connected() &&
+			   millis() - inlineJob.LastProgress < RESPONSE_JOB_TIMEOUT_MS)
+		{
+			more = step(inlineJob);
+			yield();
+		}
+		finish(inlineJob, !more && !inlineJob.Failed);
+		return nullptr;
+	}
+	return job;
+}
+
+void ResponseJobs::pump()
+{
+	for (uint8_t priority = ResponseJobInteractive; priority <= ResponseJobBulk; priority++)
+	{
+		for (uint8_t i = 0; i < RESPONSE_JOB_SLOTS; i++)
+		{
+			ResponseJob &job = _Slots[i];
+			if (!job.active() || job.Priority != priority)
+				continue;
+			if (!job.Client.connected())
+			{
+				finish(job, false);
+				continue;
+			}
+
+			uint32_t startMicros = micros();
+			bool more = job.Step(job);
+			uint32_t elapsed = micros() - startMicros;
+			if (elapsed > MaxStepMicros)
+				MaxStepMicros = elapsed;
+
+			if (job.Failed)
+				finish(job, false);
+			else if (!more)
+				finish(job, true);
+			else if (millis() - job.LastProgress > RESPONSE_JOB_TIMEOUT_MS)
+				finish(job, false);
+		}
+	}
+}
+
+void ResponseJobs::noteServiceTime(uint32_t elapsed)
+{
+	if (elapsed > MaxServiceMicros)
+		MaxServiceMicros = elapsed;
+}
+
+uint8_t ResponseJobs::active() const
+{
+	uint8_t count = 0;
+	for (uint8_t i = 0; i < RESPONSE_JOB_SLOTS; i++)
+	{
+		if (_Slots[i].active())
+			count++;
+	}
+	return count;
+}
+
+void ResponseJobs::finish(ResponseJob &job, bool completed)
+{
+	if (completed)
+		Completed++;
+	else
+		Aborted++;
+	if (job.Source)
+		job.Source.close();
+	// lwIP keeps sending data still queued after the close, so do not wait for the acks here
+	job.Client.stop(1);
+	job.Client = WiFiClient();
+	job.Source = File();
+	job.Step = nullptr;
+}
+
+#endif
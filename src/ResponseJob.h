@@ -0,0 +1,99 @@
+/*
+Aqua Control Library
+
+Creationdate: 2026-10-18
+Resumable response streaming for long web responses.
+
+Further information on www.schullebernd.de
+*/
+
+#ifndef __RESPONSEJOB_H_
+#define __RESPONSEJOB_H_
+
+#include "AquaControl_config.h"
+#include <Arduino.h>
+
+#if defined(USE_WEBSERVER)
+
+#include <WiFiClient.h>
+#include <FS.h>
+
+/* Long responses (file bodies, macro scans) are not produced inside handleClient. The handler writes
+   the response head and hands the connection to a job. The job then sends one bounded slice per loop
+   cycle, so the light engine keeps running and the web server is free for the next request at once.
+   Control endpoints are answered synchronously by handleClient, which runs before the jobs in every
+   cycle, so they are never queued behind a download. */
+
+// Priority classes, lower value is pumped first
+enum ResponseJobPriority : uint8_t
+{
+	ResponseJobInteractive = 0, // JSON the UI is waiting for (macro list, diagnostics)
+	ResponseJobBulk				// Static file bodies
+};
+
+struct ResponseJob;
+
+// Produces the next slice of a response. Returns false when the response is complete.
+typedef bool (*ResponseJobStep)(ResponseJob &job);
+
+struct ResponseJob
+{
+	ResponseJobStep Step = nullptr;
+	uint8_t Priority = ResponseJobBulk;
+	WiFiClient Client;
+	File Source;		   // File being sent (file jobs)
+	uint32_t Position = 0; // Step specific cursor (file offset, macro number)
+	uint32_t Remaining = 0; // Step specific (bytes left)
+	uint16_t Count = 0;	   // Step specific (entries sent)
+	uint8_t Stage = 0;	   // Step specific
+	int32_t Value = 0;	   // Step specific, fixed by start() (temperature of the app page)
+	bool Failed = false;
+	uint32_t LastProgress = 0;
+
+	bool active() const { return Step != nullptr; }
+	// Bytes the client takes right now without blocking, capped to one slice
+	size_t writable();
+	// Sends up to maxBytes of Source from its current position, returns the bytes sent
+	size_t sendFile(size_t maxBytes);
+	// Writes a string from RAM or flash (PROGMEM)
+	void print(const char *text);
+	void print_P(PGM_P text);
+};
+
+class ResponseJobs
+{
+public:
+	/* Hands the current client of the web server to a new job. The response head must already be
+	   written with writeResponseHead. If all slots are busy the job runs to completion right away. */
+	ResponseJob *start(ResponseJobStep step, uint8_t priority, File source = File(), uint32_t remaining = 0,
+					   uint32_t position = 0, int32_t value = 0);
+	// Runs one step of every active job, interactive jobs first
+	void pump();
+	// Records the time a loop cycle spent on web work
+	void noteServiceTime(uint32_t elapsed);
+
+	uint8_t active() const;
+
+	uint32_t Started = 0;
+	uint32_t Completed = 0;
+	uint32_t Aborted = 0;
+	uint32_t Inline = 0; // Jobs run synchronously because all slots were busy
+	uint32_t MaxStepMicros = 0;
+	uint32_t MaxServiceMicros = 0;
+
+private:
+	void finish(ResponseJob &job, bool completed);
+
+	ResponseJob _Slots[RESPONSE_JOB_SLOTS];
+};
+
+/* Writes status line, content type, optional content length (-1 omits it, the body then ends with the
+   connection), "Connection: close" and the preformatted header lines ("Name: value\r\n") in one packet. */
+void writeResponseHead(WiFiClient &client, int code, const char *contentType, long contentLength,
+					   const char *headers = nullptr);
+
+extern ResponseJobs _Jobs;
+
+#endif
+
+#endif
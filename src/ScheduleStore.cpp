@@ -0,0 +1,398 @@
+/*
+Aqua Control Library
+
+Creationdate: 2026-10-18
+Binary schedule store, all channel schedules in one versioned file.
+
+Further information on www.schullebernd.de
+*/
+
+#include "AquaControl.h"
+
+#define SCHEDULE_STORE_BLOCK 32 // Records per read or write call
+#define SCHEDULE_JOURNAL_BLOCK 16 // Journal entries per read call
+
+ScheduleStore _ScheduleStore;
+
+uint32_t crc32Update(uint32_t crc, const uint8_t *data, size_t len)
+{
+	crc = ~crc;
+	while (len--)
+	{
+		crc ^= *data++;
+		for (uint8_t k = 0; k < 8; k++)
+		{
+			crc = (crc >> 1) ^ (0xEDB88320UL & (0 - (crc & 1)));
+		}
+	}
+	return ~crc;
+}
+
+// Helper: Packs count targets starting at first into records, returns the CRC over them
+static uint32_t packRecords(const PwmChannel &channel, uint8_t first, uint8_t count, uint32_t *records, uint32_t crc)
+{
+	for (uint8_t i = 0; i < count; i++)
+	{
+		const Target &t = channel.Schedule->Targets[first + i];
+		records[i] = ((uint32_t)t.Time << 8) | t.Value;
+	}
+	return crc32Update(crc, (const uint8_t *)records, count * sizeof(uint32_t));
+}
+
+// Helper: Fills the channel table and returns the CRC of table and records, which is the CRC in the
+// header of a store with this content
+static uint32_t contentCrc(const PwmChannel *channels, uint8_t count, ScheduleStoreChannel *table)
+{
+	uint16_t offset = sizeof(ScheduleStoreHeader) + count * sizeof(ScheduleStoreChannel);
+	for (uint8_t ch = 0; ch < count; ch++)
+	{
+		table[ch].Offset = offset;
+		table[ch].Count = channels[ch].Schedule->Count;
+		table[ch].Reserved = 0;
+		offset += channels[ch].Schedule->Count * sizeof(uint32_t);
+	}
+	uint32_t records[SCHEDULE_STORE_BLOCK];
+	uint32_t crc = crc32Update(0, (const uint8_t *)table, count * sizeof(ScheduleStoreChannel));
+	for (uint8_t ch = 0; ch < count; ch++)
+	{
+		for (uint8_t first = 0; first < channels[ch].Schedule->Count; first += SCHEDULE_STORE_BLOCK)
+		{
+			uint8_t n = min((uint8_t)(channels[ch].Schedule->Count - first), (uint8_t)SCHEDULE_STORE_BLOCK);
+			crc = packRecords(channels[ch], first, n, records, crc);
+		}
+	}
+	return crc;
+}
+
+// Helper: Reads the file in order and fills the channels, the CRC is checked at the end
+static bool readStore(File &file, PwmChannel *channels, uint8_t count, uint32_t &storeCrc, uint8_t &generation)
+{
+	ScheduleStoreHeader header;
+	if (file.read((uint8_t *)&header, sizeof(header)) != sizeof(header) ||
+		header.Magic != SCHEDULE_STORE_MAGIC || header.Format != SCHEDULE_STORE_FORMAT ||
+		header.RecordSize != sizeof(uint32_t) || header.ChannelCount > PWM_CHANNELS ||
+		file.size() != sizeof(header) + header.PayloadLength)
+	{
+		return false;
+	}
+
+	ScheduleStoreChannel table[PWM_CHANNELS];
+	size_t tableSize = header.ChannelCount * sizeof(ScheduleStoreChannel);
+	if ((size_t)file.read((uint8_t *)table, tableSize) != tableSize)
+	{
+		return false;
+	}
+	uint32_t crc = crc32Update(0, (const uint8_t *)table, tableSize);
+
+	uint32_t records[SCHEDULE_STORE_BLOCK];
+	for (uint8_t ch = 0; ch < header.ChannelCount; ch++)
+	{
+		// Records are contiguous, so the whole file is read front to back
+		if (table[ch].Offset != file.position())
+		{
+			return false;
+		}
+		// Channels the UI does not manage and records beyond MAX_TARGET_COUNT_PER_CHANNEL are skipped
+		PwmChannel *channel = ch < count ? &channels[ch] : nullptr;
+		uint8_t remaining = table[ch].Count;
+		uint8_t loaded = 0;
+		while (remaining > 0)
+		{
+			uint8_t n = min(remaining, (uint8_t)SCHEDULE_STORE_BLOCK);
+			size_t bytes = n * sizeof(uint32_t);
+			if ((size_t)file.read((uint8_t *)records, bytes) != bytes)
+			{
+				return false;
+			}
+			crc = crc32Update(crc, (const uint8_t *)records, bytes);
+			for (uint8_t i = 0; i < n && channel && loaded < MAX_TARGET_COUNT_PER_CHANNEL; i++)
+			{
+				channel->Schedule->Targets[loaded].Time = records[i] >> 8;
+				channel->Schedule->Targets[loaded].Value = min((uint8_t)(records[i] & 0xFF), (uint8_t)100);
+				loaded++;
+			}
+			remaining -= n;
+		}
+		if (channel)
+		{
+			channel->Schedule->Count = loaded;
+		}
+	}
+	storeCrc = header.Crc;
+	generation = header.Generation;
+	return crc == header.Crc;
+}
+
+// Helper: Check byte of a journal entry
+static uint8_t journalCheck(ScheduleJournalEntry entry)
+{
+	entry.Check = 0;
+	return (uint8_t)crc32Update(0, (const uint8_t *)&entry, sizeof(entry));
+}
+
+static ScheduleJournalEntry journalEntry(uint8_t op, uint8_t channel, uint32_t time, uint8_t value)
+{
+	ScheduleJournalEntry entry;
+	entry.Op = op;
+	entry.Channel = channel;
+	entry.Value = value;
+	entry.Time = time;
+	entry.Check = journalCheck(entry);
+	return entry;
+}
+
+bool ScheduleStore::load(PwmChannel *channels, uint8_t count)
+{
+	recoverAtomicFile(SCHEDULE_STORE_PATH);
+	File file = SD.open(SCHEDULE_STORE_PATH);
+	if (!file)
+	{
+		return false;
+	}
+	for (uint8_t ch = 0; ch < count; ch++)
+	{
+		channels[ch].Schedule->Count = 0;
+	}
+	bool ok = readStore(file, channels, count, _BaseCrc, _Generation);
+	file.close();
+	if (!ok)
+	{
+		// The store is replaced by the text import or an empty one, keep the damaged file for inspection
+		Serial.println(F("Error: Schedule store is invalid, moved to " SCHEDULE_STORE_BAD_PATH));
+		SD.remove(SCHEDULE_STORE_BAD_PATH);
+		SD.rename(SCHEDULE_STORE_PATH, SCHEDULE_STORE_BAD_PATH);
+		Damaged = true;
+		for (uint8_t ch = 0; ch < count; ch++)
+		{
+			channels[ch].Schedule->Count = 0;
+		}
+		return false;
+	}
+	if (!replay(channels, count))
+	{
+		// Start over with a clean journal, later appends would be lost behind a damaged entry
+		return save(channels, count);
+	}
+	ScheduleStoreChannel table[PWM_CHANNELS];
+	_PersistedCrc = contentCrc(channels, count, table);
+	return true;
+}
+
+// Applies the journal entries in order, false if the journal was damaged or belongs to another store
+bool ScheduleStore::replay(PwmChannel *channels, uint8_t count)
+{
+	_JournalBytes = 0;
+	File file = SD.open(SCHEDULE_JOURNAL_PATH);
+	if (!file)
+	{
+		return true;
+	}
+	ScheduleJournalEntry entries[SCHEDULE_JOURNAL_BLOCK];
+	bool ok = true;
+	bool first = true;
+	while (ok && file.available())
+	{
+		int bytes = file.read((uint8_t *)entries, sizeof(entries));
+		int n = bytes / (int)sizeof(ScheduleJournalEntry);
+		// Trailing bytes of an append cut short end the replay after the complete entries
+		bool torn = bytes <= 0 || bytes % sizeof(ScheduleJournalEntry) != 0;
+		for (int i = 0; ok && i < n; i++)
+		{
+			const ScheduleJournalEntry &entry = entries[i];
+			if (entry.Check != journalCheck(entry))
+			{
+				ok = false;
+			}
+			else if (first)
+			{
+				ok = entry.Op == ScheduleJournalBase && entry.Time == _BaseCrc && entry.Value == _Generation;
+				first = false;
+			}
+			else if (entry.Channel < count)
+			{
+				Target target;
+				target.Time = entry.Time;
+				target.Value = entry.Value;
+				if (entry.Op == ScheduleJournalSet)
+				{
+					channels[entry.Channel].setTarget(target);
+				}
+				else if (entry.Op == ScheduleJournalRemove)
+				{
+					channels[entry.Channel].removeTargetAtTime(target.Time);
+				}
+				Replayed++;
+			}
+			_JournalBytes += sizeof(ScheduleJournalEntry);
+		}
+		ok = ok && !torn;
+	}
+	file.close();
+	if (!ok)
+	{
+		Serial.println(F("Error: Schedule journal is damaged or outdated, applied the valid part"));
+	}
+	return ok;
+}
+
+// Appends entries to the journal in one write, a new journal starts with the entry that ties it to the store
+bool ScheduleStore::append(const ScheduleJournalEntry *entries, uint8_t n)
+{
+	File file = SD.open(SCHEDULE_JOURNAL_PATH, FILE_WRITE);
+	bool ok = file;
+	size_t written = 0;
+	if (ok && _JournalBytes == 0)
+	{
+		ScheduleJournalEntry base = journalEntry(ScheduleJournalBase, 0, _BaseCrc, _Generation);
+		ok = file.write((const uint8_t *)&base, sizeof(base)) == sizeof(base);
+		written += sizeof(base);
+	}
+	size_t bytes = n * sizeof(ScheduleJournalEntry);
+	ok = ok && file.write((const uint8_t *)entries, bytes) == bytes;
+	written += bytes;
+	if (file)
+	{
+		file.close();
+	}
+	if (!ok)
+	{
+		// The journal may end in a torn entry or lack its base entry now, nothing may be appended after
+		// that. The retry writes the whole store, which also removes the journal.
+		Serial.println(F("Error: Couldn't append to " SCHEDULE_JOURNAL_PATH));
+		_Replaced = true;
+		return false;
+	}
+	_JournalBytes += written;
+	Appends++;
+	return true;
+}
+
+void ScheduleStore::noteEdit(uint8_t op, uint8_t channel, uint32_t time, uint8_t value)
+{
+	if (_Queued < SCHEDULE_PERSIST_QUEUE)
+	{
+		_Queue[_Queued++] = journalEntry(op, channel, time, value);
+	}
+	else
+	{
+		// More edits than the queue holds, the store is written instead
+		_Replaced = true;
+	}
+	touch();
+}
+
+void ScheduleStore::noteReplaced()
+{
+	_Replaced = true;
+	touch();
+}
+
+void ScheduleStore::touch()
+{
+	_LastEdit = millis();
+	if (!_Dirty)
+	{
+		_FirstEdit = _LastEdit;
+		_Dirty = true;
+	}
+}
+
+void ScheduleStore::pump(const PwmChannel *channels, uint8_t count)
+{
+	uint32_t now = millis();
+	if (_Dirty && (now - _LastEdit >= SCHEDULE_PERSIST_QUIET_MS || now - _FirstEdit >= SCHEDULE_PERSIST_MAX_DELAY_MS))
+	{
+		flush(channels, count);
+	}
+}
+
+bool ScheduleStore::flush(const PwmChannel *channels, uint8_t count)
+{
+	if (!_Dirty)
+	{
+		return true;
+	}
+	ScheduleStoreChannel table[PWM_CHANNELS];
+	uint32_t crc = contentCrc(channels, count, table);
+	bool ok = true;
+	if (crc == _PersistedCrc)
+	{
+		Skipped++;
+	}
+	else if (_Replaced || _JournalBytes + _Queued * sizeof(ScheduleJournalEntry) >= SCHEDULE_JOURNAL_COMPACT_BYTES)
+	{
+		// Also folds a grown journal into the store
+		ok = save(channels, count);
+	}
+	else
+	{
+		ok = append(_Queue, _Queued);
+		Writes++;
+	}
+	if (!ok)
+	{
+		// Retried once the quiet period has passed again
+		_FirstEdit = _LastEdit = millis();
+		return false;
+	}
+	_PersistedCrc = crc;
+	_Dirty = false;
+	_Replaced = false;
+	_Queued = 0;
+	return true;
+}
+
+bool ScheduleStore::save(const PwmChannel *channels, uint8_t count)
+{
+	ScheduleStoreHeader header;
+	header.Magic = SCHEDULE_STORE_MAGIC;
+	header.Format = SCHEDULE_STORE_FORMAT;
+	header.ChannelCount = count;
+	header.RecordSize = sizeof(uint32_t);
+	header.Generation = _Generation + 1;
+
+	// The CRC goes into the header, so the records are packed twice instead of seeking back
+	ScheduleStoreChannel table[PWM_CHANNELS];
+	header.Crc = contentCrc(channels, count, table);
+	header.PayloadLength = count * sizeof(ScheduleStoreChannel);
+	for (uint8_t ch = 0; ch < count; ch++)
+	{
+		header.PayloadLength += channels[ch].Schedule->Count * sizeof(uint32_t);
+	}
+	uint32_t records[SCHEDULE_STORE_BLOCK];
+
+	AtomicFileWriter file;
+	if (!file.begin(SCHEDULE_STORE_PATH))
+	{
+		return false;
+	}
+	file.write((const uint8_t *)&header, sizeof(header));
+	file.write((const uint8_t *)table, count * sizeof(ScheduleStoreChannel));
+	for (uint8_t ch = 0; ch < count; ch++)
+	{
+		for (uint8_t first = 0; first < channels[ch].Schedule->Count; first += SCHEDULE_STORE_BLOCK)
+		{
+			uint8_t n = min((uint8_t)(channels[ch].Schedule->Count - first), (uint8_t)SCHEDULE_STORE_BLOCK);
+			packRecords(channels[ch], first, n, records, 0);
+			file.write((const uint8_t *)records, n * sizeof(uint32_t));
+		}
+	}
+	if (!file.commit())
+	{
+		return false;
+	}
+
+	// The store holds every edit now. Should the reset come before the journal is gone, the generation in
+	// its base entry no longer matches (the CRC may, after edits that cancel out) and it is dropped at boot.
+	_BaseCrc = header.Crc;
+	_Generation = header.Generation;
+	_PersistedCrc = header.Crc;
+	SD.remove(SCHEDULE_JOURNAL_PATH);
+	if (_JournalBytes > 0)
+	{
+		Compactions++;
+	}
+	_JournalBytes = 0;
+	Writes++;
+	return true;
+}
@@ -0,0 +1,127 @@
+/*
+Aqua Control Library
+
+Creationdate: 2026-10-18
+Binary schedule store, all channel schedules in one versioned file.
+
+Further information on www.schullebernd.de
+*/
+
+#ifndef __SCHEDULESTORE_H_
+#define __SCHEDULESTORE_H_
+
+#include "AquaControl_config.h"
+#include <Arduino.h>
+
+#define SCHEDULE_STORE_PATH "config/schedule.bin"
+#define SCHEDULE_STORE_BAD_PATH "config/schedule.bin.bad" // An invalid store is kept here for inspection
+#define SCHEDULE_STORE_MAGIC 0x43535141UL // "AQSC"
+#define SCHEDULE_STORE_FORMAT 1
+#define SCHEDULE_STORE_CHANNELS (PWM_CHANNELS > 6 ? 6 : PWM_CHANNELS) // Channels managed by the UI
+
+/* File layout (little endian):
+     ScheduleStoreHeader
+     ScheduleStoreChannel[ChannelCount]
+     uint32_t records, time of day in seconds << 8 | value (0-100), per channel in time order
+   Crc covers everything after the header. The channel table holds the file offset of the first record
+   of each channel, so a channel can be read without parsing the ones before it.
+   The file is replaced with AtomicFileWriter, a file at SCHEDULE_STORE_PATH is always complete. */
+typedef struct
+{
+	uint32_t Magic;
+	uint8_t Format;
+	uint8_t ChannelCount;
+	uint8_t RecordSize;
+	uint8_t Generation;		// Counts the writes of the store (wrapping), ties the journal to this write
+	uint32_t PayloadLength; // Bytes after the header
+	uint32_t Crc;
+} ScheduleStoreHeader;
+
+typedef struct
+{
+	uint16_t Offset; // File offset of the first record
+	uint8_t Count;
+	uint8_t Reserved;
+} ScheduleStoreChannel;
+
+#define SCHEDULE_JOURNAL_PATH "config/schedule.jnl"
+
+/* Journal of single target edits since the store was written, replayed on top of it at boot.
+   Every entry is 8 bytes, the first one (ScheduleJournalBase) holds the CRC and, in Value, the
+   generation of the store it belongs to. A journal left behind by an interrupted compaction is
+   recognized and dropped, even if the new store has the same content as the old one. Replay stops at the
+   first entry with a bad check byte (an append cut short by a reset). */
+enum ScheduleJournalOp : uint8_t
+{
+	ScheduleJournalBase = 0xB5,
+	ScheduleJournalSet = 1,	   // Add or replace the target at Time
+	ScheduleJournalRemove = 2, // Remove the target at Time
+};
+
+typedef struct
+{
+	uint8_t Op;
+	uint8_t Channel;
+	uint8_t Value;
+	uint8_t Check; // Low byte of the CRC32 over the entry with Check = 0
+	uint32_t Time;  // Seconds of the day, the store CRC for ScheduleJournalBase
+} ScheduleJournalEntry;
+
+class PwmChannel;
+
+/* Edits never touch the SD card in the request path. They only update the channels in RAM and mark the
+   store dirty, pump() persists them once no edit came for SCHEDULE_PERSIST_QUIET_MS or the first pending
+   edit is SCHEDULE_PERSIST_MAX_DELAY_MS old. Before writing, the CRC of the content is compared with the
+   CRC of what is persisted, so edits that cancel each other out cost no write at all. Pending single
+   target edits are appended to the journal in one write, anything else writes the store. */
+class ScheduleStore
+{
+public:
+	// Loads the schedules of the first count channels and replays the journal,
+	// false if the store is missing or invalid (channels are left empty, an invalid store is moved aside)
+	bool load(PwmChannel *channels, uint8_t count);
+	// Writes the schedules of the first count channels and drops the journal
+	bool save(const PwmChannel *channels, uint8_t count);
+
+	// A single target edit that was applied in RAM, persisted as a journal entry
+	void noteEdit(uint8_t op, uint8_t channel, uint32_t time, uint8_t value);
+	// Targets were replaced in RAM (whole channels), persisted by writing the store
+	void noteReplaced();
+	// Persists pending edits once they have settled, call while nothing else waits for the SD card
+	void pump(const PwmChannel *channels, uint8_t count);
+	// Persists pending edits now (before a restart)
+	bool flush(const PwmChannel *channels, uint8_t count);
+	bool pending() const { return _Dirty; }
+
+	uint32_t JournalBytes() const { return _JournalBytes; }
+	uint32_t Appends = 0;
+	uint32_t Replayed = 0;
+	uint32_t Compactions = 0;
+	uint32_t Writes = 0;	// Flushes that wrote to the SD card
+	uint32_t Skipped = 0;	// Flushes without a write because the content matched the persisted one
+	bool Damaged = false;	// The store was invalid at boot and moved to SCHEDULE_STORE_BAD_PATH
+
+private:
+	bool replay(PwmChannel *channels, uint8_t count);
+	bool append(const ScheduleJournalEntry *entries, uint8_t n);
+	void touch();
+
+	uint32_t _BaseCrc = 0;		// CRC of the store file, ties the journal to it
+	uint8_t _Generation = 0;	// Generation of the store file, ties the journal to it
+	uint32_t _PersistedCrc = 0; // Content CRC of store and journal together
+	uint32_t _JournalBytes = 0;
+
+	bool _Dirty = false;
+	bool _Replaced = false; // Pending edits need a store write
+	uint32_t _FirstEdit = 0;
+	uint32_t _LastEdit = 0;
+	ScheduleJournalEntry _Queue[SCHEDULE_PERSIST_QUEUE];
+	uint8_t _Queued = 0;
+};
+
+extern ScheduleStore _ScheduleStore;
+
+// Bitwise CRC32 (IEEE), small and good enough for a few kilobytes
+uint32_t crc32Update(uint32_t crc, const uint8_t *data, size_t len);
+
+#endif
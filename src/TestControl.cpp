@@ -0,0 +1,320 @@
+/*
+Aqua Control Library
+
+Creationdate: 2026-10-18
+WebSocket control channel for live test mode adjustment with compact binary frames.
+
+Further information on www.schullebernd.de
+*/
+
+#include "AquaControl.h"
+
+#if defined(USE_WEBSERVER) && defined(USE_TEST_CONTROL)
+
+#include <Hash.h>
+#include "WebStrings.h"
+
+#define WS_OPCODE_BINARY 0x2
+#define WS_OPCODE_CLOSE 0x8
+#define WS_OPCODE_PING 0x9
+#define WS_OPCODE_PONG 0xA
+
+extern "C" AquaControl *_aqc;
+
+TestControl _TestControl;
+
+static const char BASE64_CHARS[] PROGMEM = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Helper: Base64 of a short binary value (the 20 byte handshake digest), out needs 4 * ceil(len / 3) + 1 bytes
+static void encodeBase64(const uint8_t *data, size_t len, char *out)
+{
+	size_t o = 0;
+	for (size_t i = 0; i < len; i += 3)
+	{
+		uint32_t block = (uint32_t)data[i] << 16;
+		if (i + 1 < len)
+			block |= (uint32_t)data[i + 1] << 8;
+		if (i + 2 < len)
+			block |= data[i + 2];
+		out[o++] = pgm_read_byte(&BASE64_CHARS[(block >> 18) & 0x3F]);
+		out[o++] = pgm_read_byte(&BASE64_CHARS[(block >> 12) & 0x3F]);
+		out[o++] = (i + 1 < len) ? pgm_read_byte(&BASE64_CHARS[(block >> 6) & 0x3F]) : '=';
+		out[o++] = (i + 2 < len) ? pgm_read_byte(&BASE64_CHARS[block & 0x3F]) : '=';
+	}
+	out[o] = '\0';
+}
+
+TestControl::TestControl() : _Listener(TEST_CONTROL_PORT)
+{
+	_Key[0] = '\0';
+	memset(_PendingValues, 0, sizeof(_PendingValues));
+}
+
+void TestControl::begin()
+{
+	_Listener.begin();
+}
+
+bool TestControl::connected()
+{
+	return _Upgraded && _Client.connected();
+}
+
+void TestControl::pump()
+{
+	if (_Listener.hasClient())
+	{
+		// The newest client wins, e.g. a reloaded page
+		WiFiClient client = _Listener.accept();
+		drop();
+		_Client = client;
+		_Client.setNoDelay(true);
+		_AcceptedAt = millis();
+	}
+	if (!_Client.connected())
+	{
+		if (_Upgraded)
+		{
+			drop();
+		}
+		return;
+	}
+	if (!_Upgraded)
+	{
+		if (millis() - _AcceptedAt > TEST_CONTROL_HANDSHAKE_MS || !handshake())
+		{
+			drop();
+		}
+		return;
+	}
+	receive();
+	apply();
+}
+
+// Reads the upgrade request line by line and answers it once the header is complete.
+// Returns false if the request ended without a Sec-WebSocket-Key.
+bool TestControl::handshake()
+{
+	while (_Client.available())
+	{
+		int c = _Client.read();
+		if (c < 0)
+		{
+			break;
+		}
+		if (c != '\n')
+		{
+			if (_LineLength < TEST_CONTROL_LINE_SIZE - 1)
+			{
+				_Line[_LineLength++] = (char)c;
+			}
+			continue;
+		}
+
+		uint8_t lineLength = _LineLength;
+		if (lineLength > 0 && _Line[lineLength - 1] == '\r')
+		{
+			lineLength--;
+		}
+		_Line[lineLength] = '\0';
+		_LineLength = 0;
+
+		if (lineLength > 0)
+		{
+			if (strncasecmp_P(_Line, WS_KEY_HEADER, strlen_P(WS_KEY_HEADER)) == 0)
+			{
+				const char *value = _Line + strlen_P(WS_KEY_HEADER);
+				while (*value == ' ')
+				{
+					value++;
+				}
+				strncpy(_Key, value, sizeof(_Key) - 1);
+				_Key[sizeof(_Key) - 1] = '\0';
+			}
+			continue;
+		}
+
+		// Empty line: end of the request header
+		if (_Key[0] == '\0')
+		{
+			return false;
+		}
+		char concat[sizeof(_Key) + 40];
+		strcpy(concat, _Key);
+		strcat_P(concat, WS_GUID);
+		uint8_t digest[20];
+		sha1((const uint8_t *)concat, strlen(concat), digest);
+		char accept[32];
+		encodeBase64(digest, sizeof(digest), accept);
+
+		char response[160];
+		int len = snprintf_P(response, sizeof(response), FMT_WS_UPGRADE, accept);
+		_Client.write((const uint8_t *)response, len);
+		_Upgraded = true;
+		Serial.println(F("Test control client connected"));
+		return true;
+	}
+	return true;
+}
+
+// Parses all complete frames in the receive buffer
+void TestControl::receive()
+{
+	int available = _Client.available();
+	if (available > 0 && _RxLength < TEST_CONTROL_RX_SIZE)
+	{
+		int n = _Client.read(_Rx + _RxLength, min((size_t)available, (size_t)(TEST_CONTROL_RX_SIZE - _RxLength)));
+		if (n > 0)
+		{
+			_RxLength += n;
+		}
+	}
+
+	while (_RxLength >= 2)
+	{
+		uint8_t opcode = _Rx[0] & 0x0F;
+		uint8_t len = _Rx[1] & 0x7F;
+		// Client frames are always masked, extended lengths are never needed here
+		if (!(_Rx[1] & 0x80) || len > 125 || 6 + len > TEST_CONTROL_RX_SIZE)
+		{
+			drop();
+			return;
+		}
+		uint8_t total = 6 + len;
+		if (_RxLength < total)
+		{
+			break;
+		}
+		uint8_t *payload = _Rx + 6;
+		for (uint8_t i = 0; i < len; i++)
+		{
+			payload[i] ^= _Rx[2 + (i & 3)];
+		}
+
+		switch (opcode)
+		{
+		case WS_OPCODE_BINARY:
+			parseControl(payload, len);
+			break;
+		case WS_OPCODE_PING:
+			sendFrame(WS_OPCODE_PONG, payload, len);
+			break;
+		case WS_OPCODE_CLOSE:
+			sendFrame(WS_OPCODE_CLOSE, payload, min(len, (uint8_t)2));
+			drop();
+			return;
+		default:
+			// Text, pong and continuation frames are not used
+			break;
+		}
+		memmove(_Rx, _Rx + total, _RxLength - total);
+		_RxLength -= total;
+	}
+}
+
+// Merges one control frame into the pending state, false if it is malformed
+bool TestControl::parseControl(const uint8_t *payload, uint8_t length)
+{
+	if (length < TEST_CONTROL_HEADER_SIZE)
+	{
+		return false;
+	}
+	uint16_t seq = payload[0] | ((uint16_t)payload[1] << 8);
+	uint8_t flags = payload[2];
+	uint8_t mask = payload[3];
+	uint8_t count = 0;
+	for (uint8_t ch = 0; ch < TEST_CONTROL_CHANNELS; ch++)
+	{
+		if (mask & (1 << ch))
+			count++;
+	}
+	if (length != TEST_CONTROL_HEADER_SIZE + count)
+	{
+		return false;
+	}
+	Frames++;
+	// Sequence numbers wrap, so compare by signed distance
+	if (_HaveSeq && (int16_t)(seq - _LastSeq) <= 0)
+	{
+		Stale++;
+		return true;
+	}
+	_HaveSeq = true;
+	_LastSeq = seq;
+
+	const uint8_t *value = payload + TEST_CONTROL_HEADER_SIZE;
+	for (uint8_t ch = 0; ch < TEST_CONTROL_CHANNELS; ch++)
+	{
+		if (mask & (1 << ch))
+		{
+			_PendingValues[ch] = min(*value++, (uint8_t)100);
+		}
+	}
+	_PendingMask |= mask;
+	_PendingFlags = flags;
+	return true;
+}
+
+// Applies the merged values of this cycle and acknowledges the newest sequence number
+void TestControl::apply()
+{
+	if (_PendingMask == 0)
+	{
+		return;
+	}
+
+	// Adjusting a channel implies test mode, as /api/test/start would do
+	if (!_aqc->_PwmChannels[0].TestMode)
+	{
+		for (uint8_t i = 0; i < PWM_CHANNELS; i++)
+		{
+			_aqc->_PwmChannels[i].TestMode = true;
+			_aqc->_PwmChannels[i].TestModeSetTime = _aqc->CurrentSecOfDay;
+		}
+		_aqc->notifyChange(ChangeTestMode);
+	}
+
+	bool instant = (_PendingFlags & TEST_CONTROL_FLAG_INSTANT) != 0;
+	for (uint8_t ch = 0; ch < TEST_CONTROL_CHANNELS && ch < PWM_CHANNELS; ch++)
+	{
+		if (_PendingMask & (1 << ch))
+		{
+			PwmChannel &channel = _aqc->_PwmChannels[ch];
+			channel.TestValue = _PendingValues[ch];
+			channel.TestModeSetTime = _aqc->CurrentSecOfDay;
+			channel.TestInstant = instant;
+		}
+	}
+	_PendingMask = 0;
+	Applied++;
+
+	uint8_t ack[2] = {(uint8_t)(_LastSeq & 0xFF), (uint8_t)(_LastSeq >> 8)};
+	sendFrame(WS_OPCODE_BINARY, ack, sizeof(ack));
+}
+
+// Writes an unmasked, unfragmented frame (server to client) in one write
+void TestControl::sendFrame(uint8_t opcode, const uint8_t *payload, uint8_t length)
+{
+	uint8_t frame[2 + 125];
+	frame[0] = 0x80 | opcode;
+	frame[1] = length;
+	memcpy(frame + 2, payload, length);
+	_Client.write(frame, 2 + length);
+}
+
+void TestControl::drop()
+{
+	if (_Upgraded)
+	{
+		Serial.println(F("Test control client disconnected"));
+	}
+	_Client.stop();
+	_Upgraded = false;
+	_RxLength = 0;
+	_LineLength = 0;
+	_Key[0] = '\0';
+	_HaveSeq = false;
+	_PendingMask = 0;
+}
+
+#endif
@@ -0,0 +1,81 @@
+/*
+Aqua Control Library
+
+Creationdate: 2026-10-18
+WebSocket control channel for live test mode adjustment with compact binary frames.
+
+Further information on www.schullebernd.de
+*/
+
+#ifndef __TESTCONTROL_H_
+#define __TESTCONTROL_H_
+
+#include "AquaControl_config.h"
+#include <Arduino.h>
+
+#if defined(USE_WEBSERVER) && defined(USE_TEST_CONTROL)
+
+#include <ESP8266WiFi.h>
+
+#define TEST_CONTROL_RX_SIZE 64				// Receive buffer, holds several control frames
+#define TEST_CONTROL_LINE_SIZE 80			// Header lines of the upgrade request, longer ones are cut
+#define TEST_CONTROL_HANDSHAKE_MS 2000		// Clients that do not complete the upgrade are dropped
+#define TEST_CONTROL_CHANNELS 8				// Channels addressable by the mask byte
+
+/* Control frame (WebSocket binary message, client to device):
+     byte 0..1  sequence number, little endian, increases per frame (wraps)
+     byte 2     flags, bit 0 = instant apply (jump to the value instead of fading with PWM_STEP)
+     byte 3     channel mask, bit n = channel n
+     byte 4..   one value (0-100 percent) per set mask bit, in channel order
+   The device answers each applied batch with a 2 byte binary message holding the newest sequence number.
+   The UI keeps at most one frame in flight and merges slider moves until the ack arrives. */
+#define TEST_CONTROL_HEADER_SIZE 4
+#define TEST_CONTROL_FLAG_INSTANT 0x01
+
+/* A single WebSocket client (the UI that is in test mode). A new connection replaces the previous one.
+   All frames received within one loop cycle are merged (latest value per channel wins), stale frames
+   (older sequence number) are skipped and the result is applied once. */
+class TestControl
+{
+public:
+	TestControl();
+	void begin();
+	// Accepts a client, completes the upgrade and applies received frames
+	void pump();
+	bool connected();
+
+	uint32_t Frames = 0;	// Control frames received
+	uint32_t Applied = 0;	// Batches applied (several frames of one cycle count once)
+	uint32_t Stale = 0;		// Frames skipped because a newer one had been applied already
+
+private:
+	bool handshake();
+	void receive();
+	void apply();
+	bool parseControl(const uint8_t *payload, uint8_t length);
+	void sendFrame(uint8_t opcode, const uint8_t *payload, uint8_t length);
+	void drop();
+
+	WiFiServer _Listener;
+	WiFiClient _Client;
+	bool _Upgraded = false;
+	uint32_t _AcceptedAt = 0;
+	char _Line[TEST_CONTROL_LINE_SIZE];	// Upgrade request is parsed line by line, only the key is kept
+	uint8_t _LineLength = 0;
+	char _Key[32];
+	uint8_t _Rx[TEST_CONTROL_RX_SIZE];
+	uint8_t _RxLength = 0;
+
+	// Merged state of the frames received in this cycle
+	bool _HaveSeq = false;
+	uint16_t _LastSeq = 0;
+	uint8_t _PendingMask = 0;
+	uint8_t _PendingFlags = 0;
+	uint8_t _PendingValues[TEST_CONTROL_CHANNELS];
+};
+
+extern TestControl _TestControl;
+
+#endif
+
+#endif
@@ -0,0 +1,202 @@
+/*
+Aqua Control Library
+
+Creationdate: 2026-10-18
+Flash resident string table for the JSON API.
+
+Further information on www.schullebernd.de
+*/
+
+#include "AquaControl.h"
+
+#if defined(USE_WEBSERVER)
+
+void appendJson(char *json, size_t size, size_t &len, const char *text)
+{
+	size_t n = strlen(text);
+	if (len + n >= size)
+		n = size - len - 1;
+	memcpy(json + len, text, n);
+	len += n;
+	json[len] = '\0';
+}
+
+void appendJson_P(char *json, size_t size, size_t &len, PGM_P text)
+{
+	size_t n = strlen_P(text);
+	if (len + n >= size)
+		n = size - len - 1;
+	memcpy_P(json + len, text, n);
+	len += n;
+	json[len] = '\0';
+}
+
+// Content types
+const char MIME_JSON[] PROGMEM = "application/json";
+const char MIME_TEXT[] PROGMEM = "text/plain";
+const char MIME_CBOR[] PROGMEM = "application/cbor";
+const char MIME_HTML[] PROGMEM = "text/html";
+const char RESP_EMPTY[] PROGMEM = "";
+
+// Canned responses
+const char RESP_OK[] PROGMEM = "{\"status\":\"ok\"}";
+const char RESP_SUCCESS[] PROGMEM = "{\"success\":true}";
+const char RESP_REBOOTING[] PROGMEM = "{\"status\":\"rebooting\"}";
+const char RESP_TEST_STARTED[] PROGMEM = "{\"status\":\"ok\",\"test_mode\":true}";
+const char RESP_TEST_EXITED[] PROGMEM = "{\"status\":\"ok\",\"test_mode\":false}";
+const char RESP_SCHEDULES_CLEARED[] PROGMEM = "{\"status\":\"ok\",\"message\":\"All schedules cleared\"}";
+const char RESP_APP_NOT_FOUND[] PROGMEM = "app.htm not found on SD card";
+const char RESP_DEFAULT_CHANNELS[] PROGMEM = "{\"channels\":["
+											"{\"name\":\"Blau\",\"color\":\"#2196F3\"},"
+											"{\"name\":\"Weiß\",\"color\":\"#E0E0E0\"},"
+											"{\"name\":\"Rot\",\"color\":\"#F44336\"},"
+											"{\"name\":\"Grün\",\"color\":\"#4CAF50\"},"
+											"{\"name\":\"UV\",\"color\":\"#9C27B0\"},"
+											"{\"name\":\"Mondlicht\",\"color\":\"#FFD700\"}"
+											"]}";
+
+// Error responses
+const char ERR_MISSING_CHANNEL[] PROGMEM = "{\"error\":\"Missing channel\"}";
+const char ERR_MISSING_TIME[] PROGMEM = "{\"error\":\"Missing time\"}";
+const char ERR_MISSING_VALUE[] PROGMEM = "{\"error\":\"Missing value\"}";
+const char ERR_MISSING_ID[] PROGMEM = "{\"error\":\"Missing id\"}";
+const char ERR_MISSING_MACRO_ID[] PROGMEM = "{\"error\":\"Missing macro id\"}";
+const char ERR_MISSING_CHANNELS[] PROGMEM = "{\"error\":\"Missing channels\"}";
+const char ERR_MISSING_PARAMETERS[] PROGMEM = "{\"error\":\"Missing parameters\"}";
+const char ERR_MISSING_TIME_FIELD[] PROGMEM = "{\"error\":\"Missing or invalid time field (hour/minute/second)\"}";
+const char ERR_INVALID_CHANNEL[] PROGMEM = "{\"error\":\"Invalid channel\"}";
+const char ERR_INVALID_CHANNEL_RANGE[] PROGMEM = "{\"error\":\"Invalid channel (must be 0-5)\"}";
+const char ERR_INVALID_ID[] PROGMEM = "{\"error\":\"Invalid id\"}";
+const char ERR_INVALID_DURATION[] PROGMEM = "{\"error\":\"Invalid duration\"}";
+const char ERR_INVALID_TIME_VALUES[] PROGMEM = "{\"error\":\"Invalid time values (hour: 0-23, minute: 0-59, second: 0-59)\"}";
+const char ERR_INVALID_CHANNELS_JSON[] PROGMEM = "{\"error\":\"Invalid JSON: missing 'channels' field\"}";
+const char ERR_NO_MACRO_ACTIVE[] PROGMEM = "{\"error\":\"No macro active\"}";
+const char ERR_MACRO_LIMIT[] PROGMEM = "{\"error\":\"Macro limit reached\"}";
+const char ERR_MACRO_WRITE[] PROGMEM = "{\"error\":\"Failed to write macro file\"}";
+const char ERR_MACRO_INDEX[] PROGMEM = "{\"error\":\"Failed to update the macro index\"}";
+const char ERR_MACRO_TOO_LARGE[] PROGMEM = "{\"error\":\"Macro has more targets than can be played\"}";
+const char ERR_ACTIVATION_FAILED[] PROGMEM = "{\"error\":\"Activation failed\"}";
+const char ERR_MACRO_CONFLICT[] PROGMEM = "{\"error\":\"Macro shares channels with a running macro\"}";
+const char ERR_MACRO_NO_ROOM[] PROGMEM = "{\"error\":\"Too many macros running\"}";
+const char ERR_RTC_SYNC_FAILED[] PROGMEM = "{\"error\":\"RTC sync failed - time not set\"}";
+const char ERR_RTC_NOT_AVAILABLE[] PROGMEM = "{\"error\":\"RTC not available\"}";
+const char ERR_TEMP_FILE[] PROGMEM = "{\"error\":\"Failed to open temp file\"}";
+const char ERR_FINALIZE_CONFIG[] PROGMEM = "{\"error\":\"Failed to finalize config file\"}";
+const char ERR_UPLOAD_NO_PATH[] PROGMEM = "{\"success\":false,\"error\":\"No path specified\"}";
+const char ERR_UPLOAD_FAILED[] PROGMEM = "{\"success\":false,\"error\":\"File upload failed\"}";
+const char ERR_UPLOAD_UNREADABLE[] PROGMEM = "{\"success\":false,\"error\":\"File created but cannot be read\"}";
+const char ERR_TOO_MANY_SUBSCRIBERS[] PROGMEM = "{\"error\":\"Too many event subscribers\"}";
+const char ERR_MISSING_OPS[] PROGMEM = "{\"error\":\"Missing ops\"}";
+const char ERR_OUT_OF_MEMORY[] PROGMEM = "{\"error\":\"Out of memory\"}";
+const char ERR_SCHEDULE_EXPORT[] PROGMEM = "{\"error\":\"Schedule export failed\"}";
+const char FMT_BATCH_ERROR[] PROGMEM = "{\"error\":\"Invalid operation\",\"index\":%u}";
+const char KEY_BOOTSTRAP_STATUS[] PROGMEM = "{\"status\":";
+const char KEY_BOOTSTRAP_CONFIG[] PROGMEM = ",\"config\":";
+const char KEY_BOOTSTRAP_SCHEDULES[] PROGMEM = ",\"schedules\":";
+const char KEY_BOOTSTRAP_MACROS[] PROGMEM = ",\"macros\":";
+const char FMT_BATCH_APPLIED[] PROGMEM = "{\"success\":true,\"applied\":%u,\"channels\":%u}";
+
+// JSON key fragments for streamed responses
+const char KEY_TEST_MODE[] PROGMEM = "{\"test_mode\":";
+const char KEY_TIME[] PROGMEM = ",\"time\":\"";
+const char KEY_CURRENT_SECONDS[] PROGMEM = "\",\"current_seconds\":";
+const char KEY_TIME_SOURCE[] PROGMEM = ",\"time_source\":\"";
+const char KEY_RTC_PRESENT_TRUE[] PROGMEM = ",\"rtc_present\":true";
+const char KEY_RTC_PRESENT_FALSE[] PROGMEM = ",\"rtc_present\":false";
+const char KEY_TIME_VALID[] PROGMEM = ",\"time_valid\":";
+const char KEY_NEEDS_TIME_SYNC[] PROGMEM = ",\"needs_time_sync\":";
+const char KEY_LAST_SYNC_TS[] PROGMEM = ",\"last_sync_ts\":";
+const char KEY_TEMPERATURE[] PROGMEM = ",\"temperature\":";
+const char KEY_TEMPERATURE_NONE[] PROGMEM = ",\"temperature\":0.0";
+const char KEY_UPTIME[] PROGMEM = ",\"wifi_connected\":true,\"sd_card_ok\":true,\"uptime\":";
+const char KEY_SCHEDULE_DAMAGED[] PROGMEM = ",\"schedule_store_damaged\":true";
+const char KEY_MACRO_ACTIVE[] PROGMEM = ",\"macro_active\":true,\"macro_expires_in\":";
+const char KEY_MACRO_INACTIVE[] PROGMEM = ",\"macro_active\":false";
+const char KEY_MACRO_ID[] PROGMEM = ",\"macro_id\":\"";
+const char KEY_MACRO_COUNT[] PROGMEM = ",\"macro_count\":";
+const char KEY_SCHEDULES[] PROGMEM = "{\"schedules\":[";
+const char KEY_MACROS[] PROGMEM = "{\"macros\":[";
+const char KEY_ID[] PROGMEM = "{\"id\":\"";
+const char KEY_NAME[] PROGMEM = "\",\"name\":\"";
+const char KEY_DURATION[] PROGMEM = "\",\"duration\":";
+const char KEY_FAVORITE[] PROGMEM = ",\"favorite\":true";
+const char KEY_CHANNELS[] PROGMEM = ",\"channels\":[";
+const char KEY_SAVED_ID[] PROGMEM = "{\"status\":\"ok\",\"id\":\"";
+const char KEY_FREE_HEAP[] PROGMEM = "{\"free_heap\":";
+const char KEY_MAX_FREE_BLOCK[] PROGMEM = ",\"max_free_block\":";
+const char KEY_HEAP_FRAGMENTATION[] PROGMEM = ",\"heap_fragmentation\":";
+const char KEY_UPTIME_MS[] PROGMEM = ",\"uptime_ms\":";
+const char KEY_VCC[] PROGMEM = ",\"vcc_voltage_mv\":";
+const char KEY_CPU_FREQ[] PROGMEM = ",\"cpu_freq_mhz\":";
+const char KEY_ARENA_CAPACITY[] PROGMEM = ",\"arena\":{\"capacity\":";
+const char KEY_HIGH_WATER[] PROGMEM = ",\"high_water\":";
+const char KEY_FAILURES[] PROGMEM = ",\"failures\":";
+const char KEY_DEBUG_MACROS[] PROGMEM = ",\"macros\":{";
+const char KEY_LOOP_STACK_FREE[] PROGMEM = ",\"loop_stack_free_min\":";
+const char KEY_SCOPE_NAME[] PROGMEM = "{\"name\":\"";
+const char KEY_UPLOAD_PATH[] PROGMEM = "{\"success\":true,\"path\":\"";
+const char KEY_SIZE[] PROGMEM = "\",\"size\":";
+const char KEY_TIME_SET[] PROGMEM = "{\"status\":\"ok\",\"time\":\"";
+const char KEY_NOT_FOUND[] PROGMEM = "File Not Found\n\nURI: ";
+const char KEY_NOT_FOUND_METHOD[] PROGMEM = "\nMethod: ";
+
+// printf formats
+const char FMT_CHANNEL_TARGETS[] PROGMEM = "{\"channel\":%u,\"targets\":[";
+const char FMT_TARGET[] PROGMEM = "{\"time\":%lu,\"value\":%u,\"isControl\":true}";
+const char FMT_SCHEDULE_SAVED[] PROGMEM = "{\"status\":\"ok\",\"channel\":%u,\"target_count\":%u}";
+const char FMT_MACRO_REINDEXED[] PROGMEM = "{\"status\":\"ok\",\"count\":%u,\"skipped\":%u}";
+const char FMT_MACRO_ACTIVATED[] PROGMEM = "{\"status\":\"ok\",\"expires_in\":%lu}";
+const char FMT_NOT_FOUND_ARGS[] PROGMEM = "\nArguments: %d\n";
+const char FMT_TEMPLATE_TEMP[] PROGMEM = "Aktuelle Wassertemperatur %s &deg;C<br/>";
+const char FMT_ETAG[] PROGMEM = "W/\"%lx-%lx%s\"";
+const char FMT_CACHE_MAX_AGE[] PROGMEM = "max-age=%lu";
+const char FMT_HTTP_DATE[] PROGMEM = "%s, %02d %s %04d %02d:%02d:%02d GMT";
+const char FMT_CONTENT_RANGE[] PROGMEM = "bytes %lu-%lu/%lu";
+const char FMT_CONTENT_RANGE_UNSATISFIED[] PROGMEM = "bytes */%lu";
+const char FMT_ASSET_CACHE[] PROGMEM = ",\"asset_cache\":{\"mounted\":%s,\"pinned\":%u,\"hits\":%lu,\"misses\":%lu}";
+const char FMT_RESPONSE_JOBS[] PROGMEM = ",\"jobs\":{\"active\":%u,\"started\":%lu,\"completed\":%lu,\"aborted\":%lu,\"inline\":%lu,\"max_step_us\":%lu,\"max_service_us\":%lu}";
+const char FMT_STATUS_ETAG[] PROGMEM = "\"s%lx\"";
+const char FMT_VERSION_ETAG[] PROGMEM = "\"%lx-%c%lu\"";
+const char FMT_TARGET_LINE[] PROGMEM = "%02lu:%02lu;%u\r\n";
+const char FMT_TARGET_LINE_SECONDS[] PROGMEM = "%02lu:%02lu:%02lu;%u\r\n";
+const char FMT_SCHEDULE_EXPORT_NAME[] PROGMEM = "attachment; filename=\"ledch_%02u.cfg\"";
+const char FMT_EVENT_STREAM[] PROGMEM = ",\"events\":{\"subscribers\":%u,\"sent\":%lu,\"dropped\":%lu}";
+const char FMT_HTTP_STATS[] PROGMEM = ",\"http\":{\"keep_alive\":%s,\"requests\":%lu,\"reused\":%lu}";
+const char FMT_HEAP_TRACKER[] PROGMEM = ",\"heap_tracker\":{\"live\":%lu,\"peak\":%lu,\"allocs\":%lu,\"frees\":%lu,\"largest\":%lu,\"scopes\":[";
+const char FMT_HEAP_SCOPE[] PROGMEM = "\",\"allocs\":%lu,\"frees\":%lu,\"bytes\":%lu,\"largest\":%lu,\"retained\":%ld,\"peak\":%lu}";
+const char FMT_MACRO_INDEX[] PROGMEM = ",\"macro_index\":{\"count\":%u,\"generation\":%lu,\"rebuilds\":%lu,\"writes\":%lu,\"skipped\":%u}";
+const char FMT_MACRO_CACHE[] PROGMEM = ",\"macro_cache\":{\"slots\":%u,\"used\":%u,\"pinned\":%u,\"hits\":%lu,\"misses\":%lu}";
+const char FMT_SCHEDULE_STORE[] PROGMEM = ",\"schedule_store\":{\"pending\":%s,\"damaged\":%s,\"journal_bytes\":%lu,\"appends\":%lu,\"replayed\":%lu,\"compactions\":%lu,\"writes\":%lu,\"skipped\":%lu}";
+
+// Server-Sent Events (/api/events)
+const char EVT_RETRY[] PROGMEM = "retry: 3000\n\n";
+const char EVT_STATUS[] PROGMEM = "event: status\ndata: ";
+const char EVT_END[] PROGMEM = "\n\n";
+const char EVT_MACRO_INACTIVE[] PROGMEM = "event: macro\ndata: {\"macro_active\":false}\n\n";
+const char EVT_OUTPUTS[] PROGMEM = "event: outputs\ndata: {\"outputs\":{";
+const char EVT_OUTPUTS_END[] PROGMEM = "}}\n\n";
+const char EVT_HEARTBEAT[] PROGMEM = ":\n\n";
+const char FMT_EVT_MACRO_ACTIVE[] PROGMEM = "event: macro\ndata: {\"macro_active\":true,\"macro_expires_in\":%lu,\"macro_id\":\"%s\",\"macro_count\":%u}\n\n";
+const char FMT_EVT_TEST[] PROGMEM = "event: test\ndata: {\"test_mode\":%s}\n\n";
+const char FMT_EVT_TEMPERATURE[] PROGMEM = "event: temperature\ndata: {\"temperature\":%s}\n\n";
+const char FMT_EVT_OUTPUT[] PROGMEM = "\"%u\":%u";
+
+// Test control channel (WebSocket upgrade)
+const char WS_KEY_HEADER[] PROGMEM = "Sec-WebSocket-Key:";
+const char WS_GUID[] PROGMEM = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+const char FMT_WS_UPGRADE[] PROGMEM = "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Accept: %s\r\n\r\n";
+const char FMT_TEST_CONTROL[] PROGMEM = ",\"test_control\":{\"connected\":%s,\"frames\":%lu,\"applied\":%lu,\"stale\":%lu}";
+
+// CBOR map keys (same names as in the JSON responses)
+const char CBOR_KEY_CHANNEL[] PROGMEM = "channel";
+const char CBOR_KEY_CHANNELS[] PROGMEM = "channels";
+const char CBOR_KEY_TARGETS[] PROGMEM = "targets";
+const char CBOR_KEY_TIME[] PROGMEM = "time";
+const char CBOR_KEY_VALUE[] PROGMEM = "value";
+const char CBOR_KEY_IS_CONTROL[] PROGMEM = "isControl";
+const char CBOR_KEY_SCHEDULES[] PROGMEM = "schedules";
+const char CBOR_KEY_ID[] PROGMEM = "id";
+const char CBOR_KEY_NAME[] PROGMEM = "name";
+const char CBOR_KEY_DURATION[] PROGMEM = "duration";
+
+#endif
@@ -0,0 +1,187 @@
+/*
+Aqua Control Library
+
+Creationdate: 2026-10-18
+Flash resident string table for the JSON API.
+
+Further information on www.schullebernd.de
+*/
+
+#ifndef __WEBSTRINGS_H_
+#define __WEBSTRINGS_H_
+
+#include <Arduino.h>
+
+/* All literal API keys and canned responses live in flash (PROGMEM) instead of DRAM.
+   They must only be passed to the *_P functions (send_P, sendContent_P, sprintf_P, strlen_P, ...),
+   never to functions that expect a RAM pointer. Single punctuation characters stay inline. */
+
+// Bounded appends for JSON built in a fixed buffer, len tracks the used length and the result is cut
+// at size - 1. appendJson takes a RAM string, appendJson_P one of the flash strings below.
+void appendJson(char *json, size_t size, size_t &len, const char *text);
+void appendJson_P(char *json, size_t size, size_t &len, PGM_P text);
+
+// Content types
+extern const char MIME_JSON[] PROGMEM;
+extern const char MIME_TEXT[] PROGMEM;
+extern const char MIME_HTML[] PROGMEM;
+extern const char MIME_CBOR[] PROGMEM;
+extern const char RESP_EMPTY[] PROGMEM;
+
+// Canned responses
+extern const char RESP_OK[] PROGMEM;
+extern const char RESP_SUCCESS[] PROGMEM;
+extern const char RESP_REBOOTING[] PROGMEM;
+extern const char RESP_TEST_STARTED[] PROGMEM;
+extern const char RESP_TEST_EXITED[] PROGMEM;
+extern const char RESP_SCHEDULES_CLEARED[] PROGMEM;
+extern const char RESP_APP_NOT_FOUND[] PROGMEM;
+extern const char RESP_DEFAULT_CHANNELS[] PROGMEM;
+
+// Error responses
+extern const char ERR_MISSING_CHANNEL[] PROGMEM;
+extern const char ERR_MISSING_TIME[] PROGMEM;
+extern const char ERR_MISSING_VALUE[] PROGMEM;
+extern const char ERR_MISSING_ID[] PROGMEM;
+extern const char ERR_MISSING_MACRO_ID[] PROGMEM;
+extern const char ERR_MISSING_CHANNELS[] PROGMEM;
+extern const char ERR_MISSING_PARAMETERS[] PROGMEM;
+extern const char ERR_MISSING_TIME_FIELD[] PROGMEM;
+extern const char ERR_INVALID_CHANNEL[] PROGMEM;
+extern const char ERR_INVALID_CHANNEL_RANGE[] PROGMEM;
+extern const char ERR_INVALID_ID[] PROGMEM;
+extern const char ERR_INVALID_DURATION[] PROGMEM;
+extern const char ERR_INVALID_TIME_VALUES[] PROGMEM;
+extern const char ERR_INVALID_CHANNELS_JSON[] PROGMEM;
+extern const char ERR_NO_MACRO_ACTIVE[] PROGMEM;
+extern const char ERR_MACRO_LIMIT[] PROGMEM;
+extern const char ERR_MACRO_WRITE[] PROGMEM;
+extern const char ERR_MACRO_INDEX[] PROGMEM;
+extern const char ERR_MACRO_TOO_LARGE[] PROGMEM;
+extern const char ERR_ACTIVATION_FAILED[] PROGMEM;
+extern const char ERR_MACRO_CONFLICT[] PROGMEM;
+extern const char ERR_MACRO_NO_ROOM[] PROGMEM;
+extern const char ERR_RTC_SYNC_FAILED[] PROGMEM;
+extern const char ERR_RTC_NOT_AVAILABLE[] PROGMEM;
+extern const char ERR_TEMP_FILE[] PROGMEM;
+extern const char ERR_FINALIZE_CONFIG[] PROGMEM;
+extern const char ERR_UPLOAD_NO_PATH[] PROGMEM;
+extern const char ERR_UPLOAD_FAILED[] PROGMEM;
+extern const char ERR_UPLOAD_UNREADABLE[] PROGMEM;
+extern const char ERR_TOO_MANY_SUBSCRIBERS[] PROGMEM;
+extern const char ERR_MISSING_OPS[] PROGMEM;
+extern const char ERR_OUT_OF_MEMORY[] PROGMEM;
+extern const char ERR_SCHEDULE_EXPORT[] PROGMEM;
+extern const char FMT_BATCH_ERROR[] PROGMEM;
+extern const char FMT_BATCH_APPLIED[] PROGMEM;
+extern const char KEY_BOOTSTRAP_STATUS[] PROGMEM;
+extern const char KEY_BOOTSTRAP_CONFIG[] PROGMEM;
+extern const char KEY_BOOTSTRAP_SCHEDULES[] PROGMEM;
+extern const char KEY_BOOTSTRAP_MACROS[] PROGMEM;
+
+// JSON key fragments for streamed responses
+extern const char KEY_TEST_MODE[] PROGMEM;
+extern const char KEY_TIME[] PROGMEM;
+extern const char KEY_CURRENT_SECONDS[] PROGMEM;
+extern const char KEY_TIME_SOURCE[] PROGMEM;
+extern const char KEY_RTC_PRESENT_TRUE[] PROGMEM;
+extern const char KEY_RTC_PRESENT_FALSE[] PROGMEM;
+extern const char KEY_TIME_VALID[] PROGMEM;
+extern const char KEY_NEEDS_TIME_SYNC[] PROGMEM;
+extern const char KEY_LAST_SYNC_TS[] PROGMEM;
+extern const char KEY_TEMPERATURE[] PROGMEM;
+extern const char KEY_TEMPERATURE_NONE[] PROGMEM;
+extern const char KEY_UPTIME[] PROGMEM;
+extern const char KEY_SCHEDULE_DAMAGED[] PROGMEM;
+extern const char KEY_MACRO_ACTIVE[] PROGMEM;
+extern const char KEY_MACRO_INACTIVE[] PROGMEM;
+extern const char KEY_MACRO_ID[] PROGMEM;
+extern const char KEY_MACRO_COUNT[] PROGMEM;
+extern const char KEY_SCHEDULES[] PROGMEM;
+extern const char KEY_MACROS[] PROGMEM;
+extern const char KEY_ID[] PROGMEM;
+extern const char KEY_NAME[] PROGMEM;
+extern const char KEY_DURATION[] PROGMEM;
+extern const char KEY_FAVORITE[] PROGMEM;
+extern const char KEY_CHANNELS[] PROGMEM;
+extern const char KEY_SAVED_ID[] PROGMEM;
+extern const char KEY_FREE_HEAP[] PROGMEM;
+extern const char KEY_MAX_FREE_BLOCK[] PROGMEM;
+extern const char KEY_HEAP_FRAGMENTATION[] PROGMEM;
+extern const char KEY_UPTIME_MS[] PROGMEM;
+extern const char KEY_VCC[] PROGMEM;
+extern const char KEY_CPU_FREQ[] PROGMEM;
+extern const char KEY_ARENA_CAPACITY[] PROGMEM;
+extern const char KEY_HIGH_WATER[] PROGMEM;
+extern const char KEY_FAILURES[] PROGMEM;
+extern const char KEY_DEBUG_MACROS[] PROGMEM;
+extern const char KEY_LOOP_STACK_FREE[] PROGMEM;
+extern const char KEY_SCOPE_NAME[] PROGMEM;
+extern const char KEY_UPLOAD_PATH[] PROGMEM;
+extern const char KEY_SIZE[] PROGMEM;
+extern const char KEY_TIME_SET[] PROGMEM;
+extern const char KEY_NOT_FOUND[] PROGMEM;
+extern const char KEY_NOT_FOUND_METHOD[] PROGMEM;
+
+// printf formats
+extern const char FMT_CHANNEL_TARGETS[] PROGMEM;
+extern const char FMT_TARGET[] PROGMEM;
+extern const char FMT_SCHEDULE_SAVED[] PROGMEM;
+extern const char FMT_MACRO_REINDEXED[] PROGMEM;
+extern const char FMT_MACRO_ACTIVATED[] PROGMEM;
+extern const char FMT_NOT_FOUND_ARGS[] PROGMEM;
+extern const char FMT_TEMPLATE_TEMP[] PROGMEM;
+extern const char FMT_ETAG[] PROGMEM;
+extern const char FMT_CACHE_MAX_AGE[] PROGMEM;
+extern const char FMT_HTTP_DATE[] PROGMEM;
+extern const char FMT_CONTENT_RANGE[] PROGMEM;
+extern const char FMT_CONTENT_RANGE_UNSATISFIED[] PROGMEM;
+extern const char FMT_ASSET_CACHE[] PROGMEM;
+extern const char FMT_EVENT_STREAM[] PROGMEM;
+extern const char FMT_STATUS_ETAG[] PROGMEM;
+extern const char FMT_VERSION_ETAG[] PROGMEM;
+// Longest line of FMT_TARGET_LINE(_SECONDS), target times are within 00:00 and 24:00
+#define TARGET_LINE_LENGTH (sizeof("24:00:00;255\r\n") - 1)
+extern const char FMT_TARGET_LINE[] PROGMEM;
+extern const char FMT_TARGET_LINE_SECONDS[] PROGMEM;
+extern const char FMT_SCHEDULE_EXPORT_NAME[] PROGMEM;
+extern const char FMT_RESPONSE_JOBS[] PROGMEM;
+extern const char FMT_HTTP_STATS[] PROGMEM;
+extern const char FMT_HEAP_TRACKER[] PROGMEM;
+extern const char FMT_HEAP_SCOPE[] PROGMEM;
+extern const char FMT_MACRO_INDEX[] PROGMEM;
+extern const char FMT_MACRO_CACHE[] PROGMEM;
+extern const char FMT_SCHEDULE_STORE[] PROGMEM;
+
+// Server-Sent Events (/api/events)
+extern const char EVT_RETRY[] PROGMEM;
+extern const char EVT_STATUS[] PROGMEM;
+extern const char EVT_END[] PROGMEM;
+extern const char EVT_MACRO_INACTIVE[] PROGMEM;
+extern const char EVT_OUTPUTS[] PROGMEM;
+extern const char EVT_OUTPUTS_END[] PROGMEM;
+extern const char EVT_HEARTBEAT[] PROGMEM;
+extern const char FMT_EVT_MACRO_ACTIVE[] PROGMEM;
+extern const char FMT_EVT_TEST[] PROGMEM;
+extern const char FMT_EVT_TEMPERATURE[] PROGMEM;
+extern const char FMT_EVT_OUTPUT[] PROGMEM;
+
+// Test control channel (WebSocket upgrade)
+extern const char WS_KEY_HEADER[] PROGMEM;
+extern const char WS_GUID[] PROGMEM;
+extern const char FMT_WS_UPGRADE[] PROGMEM;
+extern const char FMT_TEST_CONTROL[] PROGMEM;
+
+// CBOR map keys (same names as in the JSON responses)
+extern const char CBOR_KEY_CHANNEL[] PROGMEM;
+extern const char CBOR_KEY_CHANNELS[] PROGMEM;
+extern const char CBOR_KEY_TARGETS[] PROGMEM;
+extern const char CBOR_KEY_TIME[] PROGMEM;
+extern const char CBOR_KEY_VALUE[] PROGMEM;
+extern const char CBOR_KEY_IS_CONTROL[] PROGMEM;
+extern const char CBOR_KEY_SCHEDULES[] PROGMEM;
+extern const char CBOR_KEY_ID[] PROGMEM;
+extern const char CBOR_KEY_NAME[] PROGMEM;
+extern const char CBOR_KEY_DURATION[] PROGMEM;
+
+#endif // #ifndef __WEBSTRINGS_H_
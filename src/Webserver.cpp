@@ -12,6 +12,7 @@ Copyright 2017
 #include "AquaControl.h"
 
 #if defined(USE_WEBSERVER)
+#include "WebStrings.h"
 
 extern "C" ESP8266WebServer _Server;
 extern "C" AquaControl *_aqc;
@@ -20,110 +21,480 @@ extern DS3232RTC RTC;
 extern time_t getRTCTime();
 #endif
 
+// Emission helpers for the flash string table (see WebStrings.h)
+// Sends a complete JSON response whose body lives in flash
+static void sendJson_P(int code, PGM_P json)
+{
+	_Server.send_P(code, MIME_JSON, json);
+}
+
+// Sends a complete JSON response from a RAM buffer
+static void sendJson(int code, const char *json, size_t len)
+{
+	_Server.send(code, "application/json", json, len);
+}
+
+static void sendJson(int code, const char *json)
+{
+	sendJson(code, json, strlen(json));
+}
+
+// Starts a chunked JSON response, the body follows with sendContent / sendContent_P
+static void beginJsonStream()
+{
+	_Server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+	_Server.send_P(200, MIME_JSON, RESP_EMPTY);
+}
+
+#define CBOR_CHUNK_SIZE 256 // Bytes encoded before they are sent as one chunk
+
+// Content negotiation: the client takes the CBOR encoding of the same schema (Accept: application/cbor)
+static bool wantsCbor()
+{
+	return strstr(_Server.header("Accept").c_str(), "application/cbor") != nullptr;
+}
+
+static void sendCborChunk(const uint8_t *data, size_t len)
+{
+	_Server.sendContent((const char *)data, len);
+}
+
+// Starts a chunked CBOR response, the body follows through a CborWriter on sendCborChunk
+static void beginCborStream()
+{
+	_Server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+	_Server.send_P(200, MIME_CBOR, RESP_EMPTY);
+}
+
+// Request counters for /api/debug. A request from the same remote port as the previous one
+// arrived on a kept-alive connection.
+static uint32_t _HttpRequests = 0;
+static uint32_t _HttpReusedRequests = 0;
+static IPAddress _HttpLastIP;
+static uint16_t _HttpLastPort = 0;
+
+void noteHttpRequest(WiFiClient *client)
+{
+	_HttpRequests++;
+	if (client->remotePort() == _HttpLastPort && client->remoteIP() == _HttpLastIP)
+	{
+		_HttpReusedRequests++;
+	}
+	_HttpLastIP = client->remoteIP();
+	_HttpLastPort = client->remotePort();
+}
+
+// Helper: Appends "Name: value\r\n" to a header block for writeResponseHead
+static void addHeader(char *block, size_t size, const char *name, const char *value)
+{
+	size_t len = strlen(block);
+	snprintf(block + len, size - len, "%s: %s\r\n", name, value);
+}
+
+// Job step: sends the next slice of a file body (Remaining bytes left)
+static bool stepFileBody(ResponseJob &job)
+{
+	job.Remaining -= job.sendFile(job.Remaining);
+	return job.Remaining > 0;
+}
+
+// Helper: Opens a web asset, the flash mirror first and SD as fallback. lastWrite is the modification
+// time of the SD file in both cases, fromFlash tells which one was opened.
+static File openAsset(const char *path, time_t &lastWrite, bool &fromFlash)
+{
+	fromFlash = false;
+#if defined(USE_FLASH_ASSET_CACHE)
+	File cached = _AssetCache.open(path, lastWrite);
+	if (cached)
+	{
+		fromFlash = true;
+		return cached;
+	}
+#endif
+	File f = SD.open(path, FILE_READ);
+	lastWrite = f ? f.getLastWrite() : 0;
+	return f;
+}
+
+// Helper: Counts a request for a web asset in the flash mirror statistics, once per request
+static void countAsset(const char *path, bool fromFlash)
+{
+#if defined(USE_FLASH_ASSET_CACHE)
+	if (!_AssetCache.Mounted || !_AssetCache.covers(path))
+	{
+		return;
+	}
+	if (fromFlash)
+	{
+		_AssetCache.Hits++;
+	}
+	else
+	{
+		_AssetCache.Misses++;
+	}
+#endif
+}
+
+// Placeholder index of the SPA page, rebuilt when app.htm changes
+static PageTemplate _AppTemplate("app.htm");
+
+// Helper: Renders the value of a page placeholder into buf (or returns a constant). The temperature is
+// passed in tenths of a degree, so the values sent match the content length computed up front.
+static const char *renderPlaceholder(uint8_t tag, int32_t temperature, char *buf, size_t size)
+{
+	switch (tag)
+	{
+	case PageTemplateFwVersion:
+		return AQC_BUILD;
+#if defined(USE_DS18B20_TEMP_SENSOR)
+	case PageTemplateTemp:
+	{
+		char tempBuf[16];
+		dtostrf(temperature / 10.0, 1, 1, tempBuf);
+		snprintf_P(buf, size, FMT_TEMPLATE_TEMP, tempBuf);
+		return buf;
+	}
+#endif
+	default:
+		return "";
+	}
+}
+
+// Job step: copies the static spans of app.htm and inserts the placeholder values in between
+// (Stage is the next placeholder, Position the file offset, Value the temperature of renderPlaceholder)
+static bool stepAppPage(ResponseJob &job)
+{
+	uint32_t end = (job.Stage < _AppTemplate.SlotCount) ? _AppTemplate.Slots[job.Stage].Offset : job.Source.size();
+	if (job.Position < end)
+	{
+		job.Position += job.sendFile(end - job.Position);
+		return true;
+	}
+	if (job.Stage >= _AppTemplate.SlotCount)
+	{
+		return false;
+	}
+	if (job.writable() < 64)
+	{
+		return true;
+	}
+	const PageTemplateSlot &slot = _AppTemplate.Slots[job.Stage];
+	char buf[64];
+	job.print(renderPlaceholder(slot.Tag, job.Value, buf, sizeof(buf)));
+	job.Position = slot.Offset + slot.Length;
+	job.Source.seek(job.Position);
+	job.Stage++;
+	return true;
+}
+
 void handleRoot()
 {
 	// Serve the new SPA UI (app.htm)
-	File myFile = SD.open(F("app.htm"));
+	time_t lastWrite;
+	bool fromFlash;
+	File myFile = openAsset(_AppTemplate.Path, lastWrite, fromFlash);
+	countAsset(_AppTemplate.Path, fromFlash);
 	if (!myFile)
 	{
-		_Server.send(404, "text/plain", "app.htm not found on SD card");
+		_Server.send_P(404, MIME_TEXT, RESP_APP_NOT_FOUND);
 		Serial.println(F("error opening app.htm"));
 		return;
 	}
 
-	_Server.setContentLength(CONTENT_LENGTH_UNKNOWN);
-	_Server.send(200, "text/html", "");
-	while (myFile.available())
+	// Make sure the placeholder offsets match the file on SD
+	size_t arenaMark = _Arena.mark();
+	uint8_t *scanBuf = (uint8_t *)_Arena.alloc(STATIC_STREAM_BLOCK_SIZE);
+	if (scanBuf)
 	{
-		String sLine = myFile.readStringUntil(10);
-		sLine.replace("##FW_VERSION##", AQC_BUILD);
+		_AppTemplate.refresh(myFile, scanBuf, STATIC_STREAM_BLOCK_SIZE);
+	}
+	else
+	{
+		uint8_t stackBuf[128];
+		_AppTemplate.refresh(myFile, stackBuf, sizeof(stackBuf));
+	}
+	_Arena.rewind(arenaMark);
+
+	// The placeholder values are rendered once here for the content length and again while streaming,
+	// the temperature is taken now so both match and the connection can be kept alive
+	int32_t temperature = 0;
 #if defined(USE_DS18B20_TEMP_SENSOR)
-		char tempBuf[60];
-		dtostrf(_aqc->_Temperature._TemperatureInCelsius, 1, 1, tempBuf);
-		char fullTemp[100];
-		sprintf(fullTemp, "Aktuelle Wassertemperatur %s &deg;C<br/>", tempBuf);
-		sLine.replace("##TEMP##", fullTemp);
-#else
-		sLine.replace("##TEMP##", "");
+	temperature = lround(_aqc->_Temperature._TemperatureInCelsius * 10);
 #endif
-		_Server.sendContent(sLine);
+	long length = (long)myFile.size() - (long)_AppTemplate.PlaceholderBytes;
+	for (uint8_t i = 0; i < _AppTemplate.SlotCount; i++)
+	{
+		char buf[64];
+		length += strlen(renderPlaceholder(_AppTemplate.Slots[i].Tag, temperature, buf, sizeof(buf)));
+	}
+	WiFiClient &client = _Server.client();
+	writeResponseHead(client, 200, "text/html", length);
+	if (_Server.method() == HTTP_HEAD)
+	{
+		myFile.close();
+		return;
 	}
 
-	// close the file:
-	myFile.close();
+	myFile.seek(0);
+	_Jobs.start(stepAppPage, ResponseJobBulk, myFile, 0, 0, temperature);
 }
 
-void handleNotFound()
+// Helper: Case sensitive suffix check on plain C strings
+static bool endsWith(const char *str, const char *suffix)
 {
-	// Try to serve a static file from SD based on the requested URI
-	String uri = _Server.uri();
-	String path = uri;
-	// Strip query string if present
-	int qPos = path.indexOf('?');
-	if (qPos != -1)
+	size_t len = strlen(str);
+	size_t suffixLen = strlen(suffix);
+	return len >= suffixLen && strcmp(str + len - suffixLen, suffix) == 0;
+}
+
+// === Static file serving ===
+
+// Helper: Minimal content-type detection by file extension
+static const char *contentTypeFor(const char *path)
+{
+	if (endsWith(path, ".htm") || endsWith(path, ".html"))
+		return "text/html";
+	else if (endsWith(path, ".css"))
+		return "text/css";
+	else if (endsWith(path, ".js"))
+		return "application/javascript";
+	else if (endsWith(path, ".json"))
+		return "application/json";
+	else if (endsWith(path, ".png"))
+		return "image/png";
+	else if (endsWith(path, ".jpg") || endsWith(path, ".jpeg"))
+		return "image/jpeg";
+	else if (endsWith(path, ".gif"))
+		return "image/gif";
+	return "application/octet-stream";
+}
+
+// Helper: Formats a timestamp as RFC 1123 date ("Sun, 06 Nov 1994 08:49:37 GMT")
+static void formatHttpDate(char *dest, time_t t)
+{
+	static const char dayNames[] PROGMEM = "SunMonTueWedThuFriSat";
+	static const char monthNames[] PROGMEM = "JanFebMarAprMayJunJulAugSepOctNovDec";
+	char dayName[4];
+	char monthName[4];
+	memcpy_P(dayName, dayNames + (weekday(t) - 1) * 3, 3);
+	memcpy_P(monthName, monthNames + (month(t) - 1) * 3, 3);
+	dayName[3] = '\0';
+	monthName[3] = '\0';
+	sprintf_P(dest, FMT_HTTP_DATE, dayName, day(t), monthName, year(t), hour(t), minute(t), second(t));
+}
+
+// Helper: Parses a single "bytes=first-last" range against the file size.
+// Returns false if the header is not a single byte range (the full file is sent then).
+// An unsatisfiable range is reported with first > last.
+static bool parseRange(const char *header, size_t size, size_t &first, size_t &last)
+{
+	if (strncmp(header, "bytes=", 6) != 0 || strchr(header, ',') != nullptr)
 	{
-		path = path.substring(0, qPos);
+		return false;
 	}
-	// Remove leading '/'
-	if (path.startsWith("/"))
+	const char *spec = header + 6;
+	char *end;
+	if (*spec == '-')
+	{
+		// Suffix range: the last N bytes
+		unsigned long suffix = strtoul(spec + 1, &end, 10);
+		if (end == spec + 1)
+			return false;
+		if (suffix > size)
+			suffix = size;
+		first = size - suffix;
+		last = size - 1;
+		if (suffix == 0)
+			first = size;
+		return true;
+	}
+	first = strtoul(spec, &end, 10);
+	if (end == spec || *end != '-')
+		return false;
+	spec = end + 1;
+	last = size - 1;
+	if (*spec != '\0')
+	{
+		unsigned long requestedLast = strtoul(spec, &end, 10);
+		if (end == spec)
+			return false;
+		if (requestedLast < last)
+			last = requestedLast;
+	}
+	if (first >= size)
 	{
-		path = path.substring(1);
+		first = size;
+		last = size - 1;
 	}
+	return true;
+}
 
-	if (path.length() > 0)
+// Serves a file from SD with validators, optional gzip variant and range support.
+// Returns false if the file does not exist.
+static bool serveStaticFile(const char *path)
+{
+	// Prefer a precompressed sibling ("<path>.gz") when the client accepts gzip
+	File f;
+	bool gzipped = false;
+	time_t lastWrite = 0;
+	bool fromFlash = false;
+	if (strstr(_Server.header("Accept-Encoding").c_str(), "gzip") != nullptr)
+	{
+		char *gzPath = _Arena.format("%s.gz", path);
+		if (gzPath)
+		{
+			f = openAsset(gzPath, lastWrite, fromFlash);
+			gzipped = (bool)f;
+		}
+	}
+	if (!f)
 	{
-		File f = SD.open(path, FILE_READ);
-		if (f)
+		f = openAsset(path, lastWrite, fromFlash);
+	}
+	if (!f || f.isDirectory())
+	{
+		return false;
+	}
+	countAsset(path, fromFlash);
+
+	// Weak validator from size and modification time of the SD file (a flash copy has the same size),
+	// the gzip variant gets its own tag
+	size_t size = f.size();
+	char etag[32];
+	sprintf_P(etag, FMT_ETAG, (unsigned long)size, (unsigned long)lastWrite, gzipped ? "-gz" : "");
+
+	char headers[320];
+	headers[0] = '\0';
+	addHeader(headers, sizeof(headers), "ETag", etag);
+	if (STATIC_CACHE_MAX_AGE > 0)
+	{
+		char cacheControl[24];
+		sprintf_P(cacheControl, FMT_CACHE_MAX_AGE, (unsigned long)STATIC_CACHE_MAX_AGE);
+		addHeader(headers, sizeof(headers), "Cache-Control", cacheControl);
+	}
+	else
+	{
+		addHeader(headers, sizeof(headers), "Cache-Control", "no-cache");
+	}
+	// The response differs per Accept-Encoding if a gzip variant exists
+	if (gzipped)
+	{
+		addHeader(headers, sizeof(headers), "Vary", "Accept-Encoding");
+	}
+
+	// Revalidation: the client already has this exact version
+	WiFiClient &client = _Server.client();
+	if (strcmp(_Server.header("If-None-Match").c_str(), etag) == 0)
+	{
+		f.close();
+		writeResponseHead(client, 304, nullptr, -1, headers);
+		return true;
+	}
+
+	if (lastWrite > 0)
+	{
+		char httpDate[32];
+		formatHttpDate(httpDate, lastWrite);
+		addHeader(headers, sizeof(headers), "Last-Modified", httpDate);
+	}
+	addHeader(headers, sizeof(headers), "Accept-Ranges", "bytes");
+	if (gzipped)
+	{
+		addHeader(headers, sizeof(headers), "Content-Encoding", "gzip");
+	}
+
+	// Single byte range requests are answered with 206, everything else with the full file
+	int code = 200;
+	size_t first = 0;
+	size_t last = size - 1;
+	if (size > 0 && parseRange(_Server.header("Range").c_str(), size, first, last))
+	{
+		char contentRange[48];
+		if (first > last)
 		{
-			// Minimal content-type detection
-			String ct = "application/octet-stream";
-			if (uri.endsWith(".htm") || uri.endsWith(".html"))
-				ct = "text/html";
-			else if (uri.endsWith(".css"))
-				ct = "text/css";
-			else if (uri.endsWith(".js"))
-				ct = "application/javascript";
-			else if (uri.endsWith(".json"))
-				ct = "application/json";
-			else if (uri.endsWith(".png"))
-				ct = "image/png";
-			else if (uri.endsWith(".jpg") || uri.endsWith(".jpeg"))
-				ct = "image/jpeg";
-			else if (uri.endsWith(".gif"))
-				ct = "image/gif";
-
-			_Server.streamFile(f, ct);
 			f.close();
-			return;
+			sprintf_P(contentRange, FMT_CONTENT_RANGE_UNSATISFIED, (unsigned long)size);
+			addHeader(headers, sizeof(headers), "Content-Range", contentRange);
+			writeResponseHead(client, 416, nullptr, 0, headers);
+			return true;
 		}
+		sprintf_P(contentRange, FMT_CONTENT_RANGE, (unsigned long)first, (unsigned long)last, (unsigned long)size);
+		addHeader(headers, sizeof(headers), "Content-Range", contentRange);
+		code = 206;
+	}
+	size_t remaining = (size > 0) ? (last - first + 1) : 0;
+
+	writeResponseHead(client, code, contentTypeFor(path), (long)remaining, headers);
+	if (_Server.method() == HTTP_HEAD || remaining == 0)
+	{
+		f.close();
+		return true;
+	}
+
+	// The body is sent by a job, one slice per loop cycle
+	f.seek(first);
+	_Jobs.start(stepFileBody, ResponseJobBulk, f, remaining);
+	return true;
+}
+
+void handleNotFound()
+{
+	HEAP_SCOPE(HeapScopeWeb);
+	// Try to serve a static file from SD based on the requested URI
+	// The path is copied into the request arena instead of slicing Strings
+	const String &uri = _Server.uri();
+	const char *start = uri.c_str();
+	// Remove leading '/'
+	if (*start == '/')
+	{
+		start++;
+	}
+	// Strip query string if present
+	const char *query = strchr(start, '?');
+	char *path = _Arena.copy(start, query ? (size_t)(query - start) : strlen(start));
+
+	if (path && path[0] != '\0' && serveStaticFile(path))
+	{
+		return;
 	}
 
-	// Fallback: diagnostic 404
-	String message = "File Not Found\n\n";
-	message += "URI: ";
-	message += _Server.uri();
-	message += "\nMethod: ";
-	message += (_Server.method() == HTTP_GET) ? "GET" : "POST";
-	message += "\nArguments: ";
-	message += _Server.args();
-	message += "\n";
+	// Fallback: diagnostic 404 (streamed, no String concatenation)
+	_Server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+	_Server.send_P(404, MIME_TEXT, RESP_EMPTY);
+	_Server.sendContent_P(KEY_NOT_FOUND);
+	_Server.sendContent(uri);
+	_Server.sendContent_P(KEY_NOT_FOUND_METHOD);
+	_Server.sendContent((_Server.method() == HTTP_GET) ? "GET" : "POST");
+	char line[24];
+	sprintf_P(line, FMT_NOT_FOUND_ARGS, _Server.args());
+	_Server.sendContent(line);
 	for (uint8_t i = 0; i < _Server.args(); i++)
 	{
-		message += " " + _Server.argName(i) + ": " + _Server.arg(i) + "\n";
+		_Server.sendContent(" ");
+		_Server.sendContent(_Server.argName(i));
+		_Server.sendContent(": ");
+		_Server.sendContent(_Server.arg(i));
+		_Server.sendContent("\n");
 	}
-	_Server.send(404, "text/plain", message);
 }
 
 // === JSON API Endpoints ===
 
 // Helper: Parse time string "HH:MM" or "MM:SS" or seconds to seconds
+long parseTimeToSeconds(const char *timeStr);
+
 long parseTimeToSeconds(String timeStr)
 {
-	if (timeStr.indexOf(':') != -1)
+	return parseTimeToSeconds(timeStr.c_str());
+}
+
+long parseTimeToSeconds(const char *timeStr)
+{
+	const char *colon = strchr(timeStr, ':');
+	if (colon)
 	{
-		int8_t index = timeStr.indexOf(':');
-		int8_t first = timeStr.substring(0, index).toInt();
-		int8_t second = timeStr.substring(index + 1).toInt();
+		int first = atoi(timeStr);
+		int second = atoi(colon + 1);
 		// Assume HH:MM for values >= 24, otherwise MM:SS
 		if (first >= 24)
 		{
@@ -136,34 +507,33 @@ long parseTimeToSeconds(String timeStr)
 	}
 	else
 	{
-		return timeStr.toInt();
+		return atol(timeStr);
 	}
 }
 
 // API: GET /api/status
-void handleApiStatus()
+size_t formatStatusJson(char *json, size_t size)
 {
-	// Stream JSON using char buffers - NO String objects to avoid heap crashes
-	_Server.setContentLength(CONTENT_LENGTH_UNKNOWN);
-	_Server.send(200, "application/json", "");
-
+	// Build JSON in a fixed buffer - NO String objects to avoid heap crashes
+	size_t len = 0;
+	json[0] = '\0';
 	char buf[16];
 
-	_Server.sendContent("{\"test_mode\":");
-	_Server.sendContent(_aqc->_PwmChannels[0].TestMode ? "true" : "false");
+	appendJson_P(json, size, len, KEY_TEST_MODE);
+	appendJson(json, size, len, _aqc->_PwmChannels[0].TestMode ? "true" : "false");
 
 	// Current time (HH:MM:SS format)
 	// NOTE: RTC stores local time (not UTC). Ensure RTC is set to your timezone.
-	_Server.sendContent(",\"time\":\"");
+	appendJson_P(json, size, len, KEY_TIME);
 	sprintf(buf, "%02d:%02d:%02d", hour(), minute(), second());
-	_Server.sendContent(buf);
+	appendJson(json, size, len, buf);
 
-	_Server.sendContent("\",\"current_seconds\":");
+	appendJson_P(json, size, len, KEY_CURRENT_SECONDS);
 	sprintf(buf, "%lu", (unsigned long)_aqc->CurrentSecOfDay);
-	_Server.sendContent(buf);
+	appendJson(json, size, len, buf);
 
 	// Add time sync status fields
-	_Server.sendContent(",\"time_source\":\"");
+	appendJson_P(json, size, len, KEY_TIME_SOURCE);
 	const char *source = "unknown";
 	if (_aqc->_LastTimeSyncSource == TimeSyncSource::Ntp)
 		source = "ntp";
@@ -171,13 +541,13 @@ void handleApiStatus()
 		source = "rtc";
 	else if (_aqc->_LastTimeSyncSource == TimeSyncSource::Api)
 		source = "api";
-	_Server.sendContent(source);
-	_Server.sendContent("\"");
+	appendJson(json, size, len, source);
+	appendJson(json, size, len, "\"");
 
 #if defined(USE_RTC_DS3231)
-	_Server.sendContent(",\"rtc_present\":true");
+	appendJson_P(json, size, len, KEY_RTC_PRESENT_TRUE);
 #else
-	_Server.sendContent(",\"rtc_present\":false");
+	appendJson_P(json, size, len, KEY_RTC_PRESENT_FALSE);
 #endif
 
 	// Time is valid if we have a sync source other than Unknown
@@ -186,49 +556,170 @@ void handleApiStatus()
 #if defined(USE_NTP)
 	needsSync = _aqc->_NtpSyncFailed;
 #endif
-	_Server.sendContent(",\"time_valid\":");
-	_Server.sendContent(timeValid ? "true" : "false");
-	_Server.sendContent(",\"needs_time_sync\":");
-	_Server.sendContent(needsSync ? "true" : "false");
+	appendJson_P(json, size, len, KEY_TIME_VALID);
+	appendJson(json, size, len, timeValid ? "true" : "false");
+	appendJson_P(json, size, len, KEY_NEEDS_TIME_SYNC);
+	appendJson(json, size, len, needsSync ? "true" : "false");
 
 	// Last sync timestamp (for diagnostics)
-	_Server.sendContent(",\"last_sync_ts\":");
+	appendJson_P(json, size, len, KEY_LAST_SYNC_TS);
 	sprintf(buf, "%lu", (unsigned long)_aqc->_LastTimeSync);
-	_Server.sendContent(buf);
+	appendJson(json, size, len, buf);
 
 #if defined(USE_DS18B20_TEMP_SENSOR)
-	_Server.sendContent(",\"temperature\":");
+	appendJson_P(json, size, len, KEY_TEMPERATURE);
 	dtostrf(_aqc->_Temperature._TemperatureInCelsius, 1, 1, buf);
-	_Server.sendContent(buf);
+	appendJson(json, size, len, buf);
 #else
-	_Server.sendContent(",\"temperature\":0.0");
+	appendJson_P(json, size, len, KEY_TEMPERATURE_NONE);
 #endif
 
-	_Server.sendContent(",\"wifi_connected\":true,\"sd_card_ok\":true,\"uptime\":");
+	appendJson_P(json, size, len, KEY_UPTIME);
 	sprintf(buf, "%lu", millis() / 1000);
-	_Server.sendContent(buf);
+	appendJson(json, size, len, buf);
+
+	// Only present after the schedule store was found invalid at boot (see ScheduleStore::Damaged)
+	if (_ScheduleStore.Damaged)
+	{
+		appendJson_P(json, size, len, KEY_SCHEDULE_DAMAGED);
+	}
 
 	// Add macro state to status response
 #if defined(USE_WEBSERVER)
-	if (_aqc->isMacroActive())
+	// With several macros running the one that ends last is reported, macro_count tells how many run
+	const MacroOverlay *macro = _aqc->activeMacro();
+	if (macro)
 	{
-		uint32_t remaining = _aqc->getMacroTimeRemaining();
-		_Server.sendContent(",\"macro_active\":true,\"macro_expires_in\":");
+		uint32_t remaining = _aqc->getMacroTimeRemaining(*macro);
+		appendJson_P(json, size, len, KEY_MACRO_ACTIVE);
 		sprintf(buf, "%lu", (unsigned long)remaining);
-		_Server.sendContent(buf);
-		_Server.sendContent(",\"macro_id\":\"");
-		_Server.sendContent(_aqc->_activeMacro.macroId);
-		_Server.sendContent("\"");
+		appendJson(json, size, len, buf);
+		appendJson_P(json, size, len, KEY_MACRO_ID);
+		appendJson(json, size, len, macro->MacroId);
+		appendJson(json, size, len, "\"");
+		appendJson_P(json, size, len, KEY_MACRO_COUNT);
+		sprintf(buf, "%u", (unsigned int)_aqc->activeMacroCount());
+		appendJson(json, size, len, buf);
 	}
 	else
 	{
-		_Server.sendContent(",\"macro_active\":false");
+		appendJson_P(json, size, len, KEY_MACRO_INACTIVE);
 	}
 #else
-	_Server.sendContent(",\"macro_active\":false");
+	appendJson_P(json, size, len, KEY_MACRO_INACTIVE);
 #endif
 
-	_Server.sendContent("}");
+	appendJson(json, size, len, "}");
+	return len;
+}
+
+const StatusSnapshot &currentStatus()
+{
+	StatusSnapshot &status = _aqc->_Status;
+	time_t current = now();
+	if (!status.Dirty && status.BuiltAt == current)
+	{
+		return status;
+	}
+
+	// The version covers everything that is served, clock values included. A 304 therefore only answers
+	// a client that already has this exact body (polled within the same second as an earlier request).
+	char json[STATUS_JSON_SIZE];
+	size_t len = formatStatusJson(json, sizeof(json));
+	if (len != status.Length || memcmp(json, status.Json, len) != 0)
+	{
+		// A version of a previous boot must not match, so the counter starts at a boot dependent value
+		if (status.Length == 0)
+		{
+			status.Version = micros();
+		}
+		memcpy(status.Json, json, len + 1);
+		status.Length = len;
+		status.Version++;
+	}
+	status.BuiltAt = current;
+	status.Dirty = false;
+	return status;
+}
+
+// API: GET /api/status - copies out the snapshot, 304 if the client has the current version
+void handleApiStatus()
+{
+	const StatusSnapshot &status = currentStatus();
+	char etag[16];
+	sprintf_P(etag, FMT_STATUS_ETAG, (unsigned long)status.Version);
+	_Server.sendHeader("ETag", etag);
+	_Server.sendHeader("Cache-Control", "no-cache");
+	if (strcmp(_Server.header("If-None-Match").c_str(), etag) == 0)
+	{
+		_Server.send(304);
+		return;
+	}
+	sendJson(200, status.Json, status.Length);
+}
+
+#if defined(USE_SERVER_SENT_EVENTS)
+// API: GET /api/events - Server-Sent Events: a status snapshot, then changes as they happen
+void handleApiEvents()
+{
+	if (_Events.subscribers() >= EVENT_STREAM_MAX_SUBSCRIBERS)
+	{
+		sendJson_P(503, ERR_TOO_MANY_SUBSCRIBERS);
+		return;
+	}
+	WiFiClient &client = _Server.client();
+	writeResponseHead(client, 200, "text/event-stream", -1, "Cache-Control: no-cache\r\n");
+	client.write_P(EVT_RETRY, strlen_P(EVT_RETRY));
+	_Events.subscribe(client);
+}
+#endif
+
+// Sends the validator headers of a versioned response and answers 304 if the client has that version.
+// Versions restart with every boot, so the tag also contains a boot dependent value.
+static bool respondNotModified(char kind, uint32_t version)
+{
+	static uint32_t bootTag = 0;
+	if (bootTag == 0)
+	{
+		bootTag = micros() | 1;
+	}
+	// Each representation needs its own tag
+	if (wantsCbor())
+	{
+		kind = toupper(kind);
+	}
+	char etag[32];
+	sprintf_P(etag, FMT_VERSION_ETAG, (unsigned long)bootTag, kind, (unsigned long)version);
+	_Server.sendHeader("ETag", etag);
+	_Server.sendHeader("Cache-Control", "no-cache");
+	_Server.sendHeader("Vary", "Accept");
+	if (strcmp(_Server.header("If-None-Match").c_str(), etag) == 0)
+	{
+		_Server.send(304);
+		return true;
+	}
+	return false;
+}
+
+// Helper: Writes {"channel":N,"targets":[{"time":T,"value":V,"isControl":true},...]} as CBOR
+static void writeCborChannel(CborWriter &cbor, uint8_t ch)
+{
+	const PwmChannel &channel = _aqc->_PwmChannels[ch];
+	cbor.map(2);
+	cbor.key(CBOR_KEY_CHANNEL);
+	cbor.uint(ch);
+	cbor.key(CBOR_KEY_TARGETS);
+	cbor.array(channel.Schedule->Count);
+	for (uint8_t i = 0; i < channel.Schedule->Count; i++)
+	{
+		cbor.map(3);
+		cbor.key(CBOR_KEY_TIME);
+		cbor.uint((uint32_t)channel.Schedule->Targets[i].Time);
+		cbor.key(CBOR_KEY_VALUE);
+		cbor.uint(channel.Schedule->Targets[i].Value);
+		cbor.key(CBOR_KEY_IS_CONTROL);
+		cbor.boolean(true);
+	}
 }
 
 // API: GET /api/schedule/get?channel=N
@@ -239,25 +730,37 @@ void handleApiScheduleGet()
 	uint8_t channel = channelStr.toInt();
 	if (channel >= 6)
 	{
-		_Server.send(400, "application/json", "{\"error\":\"Invalid channel (must be 0-5)\"}");
+		sendJson_P(400, ERR_INVALID_CHANNEL_RANGE);
+		return;
+	}
+	if (respondNotModified('c', _aqc->_PwmChannels[channel].Version))
+	{
+		return;
+	}
+	if (wantsCbor())
+	{
+		uint8_t buf[CBOR_CHUNK_SIZE];
+		CborWriter cbor(buf, sizeof(buf), sendCborChunk);
+		beginCborStream();
+		writeCborChannel(cbor, channel);
+		cbor.flush();
 		return;
 	}
 
 	// Stream JSON to avoid large String allocations on ESP8266
-	_Server.setContentLength(CONTENT_LENGTH_UNKNOWN);
-	_Server.send(200, "application/json", "");
+	beginJsonStream();
 
 	char buf[48];
-	sprintf(buf, "{\"channel\":%u,\"targets\":[", channel);
+	sprintf_P(buf, FMT_CHANNEL_TARGETS, channel);
 	_Server.sendContent(buf);
 
-	for (uint8_t i = 0; i < _aqc->_PwmChannels[channel].TargetCount; i++)
+	for (uint8_t i = 0; i < _aqc->_PwmChannels[channel].Schedule->Count; i++)
 	{
 		if (i > 0)
 			_Server.sendContent(",");
-		sprintf(buf, "{\"time\":%lu,\"value\":%u,\"isControl\":true}",
-				(unsigned long)_aqc->_PwmChannels[channel].Targets[i].Time,
-				(unsigned int)_aqc->_PwmChannels[channel].Targets[i].Value);
+		sprintf_P(buf, FMT_TARGET,
+				(unsigned long)_aqc->_PwmChannels[channel].Schedule->Targets[i].Time,
+				(unsigned int)_aqc->_PwmChannels[channel].Schedule->Targets[i].Value);
 		_Server.sendContent(buf);
 	}
 	_Server.sendContent("]}");
@@ -266,27 +769,52 @@ void handleApiScheduleGet()
 // API: GET /api/schedule/all
 void handleApiScheduleAll()
 {
+	// Channel versions only increase, so their sum changes with every change of any channel
+	uint32_t version = 0;
+	for (uint8_t ch = 0; ch < 6; ch++)
+	{
+		version += _aqc->_PwmChannels[ch].Version;
+	}
+	if (respondNotModified('a', version))
+	{
+		return;
+	}
+	if (wantsCbor())
+	{
+		uint8_t buf[CBOR_CHUNK_SIZE];
+		CborWriter cbor(buf, sizeof(buf), sendCborChunk);
+		beginCborStream();
+		cbor.map(1);
+		cbor.key(CBOR_KEY_SCHEDULES);
+		cbor.array(6);
+		for (uint8_t ch = 0; ch < 6; ch++)
+		{
+			writeCborChannel(cbor, ch);
+		}
+		cbor.flush();
+		return;
+	}
+
 	// Stream schedules to reduce RAM usage and avoid fragmentation
-	_Server.setContentLength(CONTENT_LENGTH_UNKNOWN);
-	_Server.send(200, "application/json", "");
+	beginJsonStream();
 
-	_Server.sendContent("{\"schedules\":[");
+	_Server.sendContent_P(KEY_SCHEDULES);
 
 	char buf[48];
 	for (uint8_t ch = 0; ch < 6; ch++)
 	{
 		if (ch > 0)
 			_Server.sendContent(",");
-		sprintf(buf, "{\"channel\":%u,\"targets\":[", ch);
+		sprintf_P(buf, FMT_CHANNEL_TARGETS, ch);
 		_Server.sendContent(buf);
 
-		for (uint8_t i = 0; i < _aqc->_PwmChannels[ch].TargetCount; i++)
+		for (uint8_t i = 0; i < _aqc->_PwmChannels[ch].Schedule->Count; i++)
 		{
 			if (i > 0)
 				_Server.sendContent(",");
-			sprintf(buf, "{\"time\":%lu,\"value\":%u,\"isControl\":true}",
-					(unsigned long)_aqc->_PwmChannels[ch].Targets[i].Time,
-					(unsigned int)_aqc->_PwmChannels[ch].Targets[i].Value);
+			sprintf_P(buf, FMT_TARGET,
+					(unsigned long)_aqc->_PwmChannels[ch].Schedule->Targets[i].Time,
+					(unsigned int)_aqc->_PwmChannels[ch].Schedule->Targets[i].Value);
 			_Server.sendContent(buf);
 		}
 
@@ -321,7 +849,7 @@ void handleApiScheduleSave()
 	int channelIdx = body.indexOf("\"channel\":");
 	if (channelIdx == -1)
 	{
-		_Server.send(400, "application/json", "{\"error\":\"Missing channel\"}");
+		sendJson_P(400, ERR_MISSING_CHANNEL);
 		return;
 	}
 	int channelStart = channelIdx + 10;
@@ -334,15 +862,12 @@ void handleApiScheduleSave()
 
 	if (channel >= 6)
 	{
-		_Server.send(400, "application/json", "{\"error\":\"Invalid channel\"}");
+		sendJson_P(400, ERR_INVALID_CHANNEL);
 		return;
 	}
 
-	// Clear existing targets
-	for (uint8_t t = 0; t < MAX_TARGET_COUNT_PER_CHANNEL; t++)
-	{
-		_aqc->_PwmChannels[channel].removeTargetAt(0);
-	}
+	// The new targets are collected in the spare snapshot, the channel plays the old ones until it is published
+	ScheduleSnapshot *schedule = _aqc->editSchedule(channel, false);
 
 	// Parse targets array
 	int targetsIdx = body.indexOf("\"targets\":[");
@@ -397,7 +922,7 @@ void handleApiScheduleSave()
 					Target t;
 					t.Time = targetTime;
 					t.Value = finalValue;
-					_aqc->_PwmChannels[channel].addTarget(t);
+					schedule->add(t);
 				}
 			}
 
@@ -405,21 +930,69 @@ void handleApiScheduleSave()
 		}
 	}
 
-	// Persist to SD card
-	_aqc->writeLedConfig(channel);
+	// Publish and persist to SD card
+	_aqc->publishSchedule(channel);
+	_aqc->scheduleChanged();
 	_aqc->_IsFirstCycle = true;
 
 	char buf[64];
-	sprintf(buf, "{\"status\":\"ok\",\"channel\":%u,\"target_count\":%u}",
-			channel, _aqc->_PwmChannels[channel].TargetCount);
+	sprintf_P(buf, FMT_SCHEDULE_SAVED,
+			channel, _aqc->_PwmChannels[channel].Schedule->Count);
 
 	Serial.print(F("Schedule saved for channel "));
 	Serial.print(channel);
 	Serial.print(F(": "));
-	Serial.print(_aqc->_PwmChannels[channel].TargetCount);
+	Serial.print(_aqc->_PwmChannels[channel].Schedule->Count);
 	Serial.println(F(" targets"));
 
-	_Server.send(200, "application/json", buf);
+	sendJson(200, buf);
+}
+
+// Helper: One line of the text schedule format (config/ledch_NN.cfg), seconds only when set
+static int formatTargetLine(char *buf, size_t size, const Target &target)
+{
+	unsigned long time = target.Time;
+	if (time % 60)
+	{
+		return snprintf_P(buf, size, FMT_TARGET_LINE_SECONDS, time / 3600, (time / 60) % 60, time % 60, target.Value);
+	}
+	return snprintf_P(buf, size, FMT_TARGET_LINE, time / 3600, (time / 60) % 60, target.Value);
+}
+
+// API: GET /api/schedule/export?channel=N - The schedule of a channel in the text format of config/ledch_NN.cfg
+void handleApiScheduleExport()
+{
+	uint8_t channel = _Server.arg("channel").toInt();
+	if (channel >= SCHEDULE_STORE_CHANNELS)
+	{
+		sendJson_P(400, ERR_INVALID_CHANNEL_RANGE);
+		return;
+	}
+	PwmChannel &pwmChannel = _aqc->_PwmChannels[channel];
+	size_t size = pwmChannel.Schedule->Count * TARGET_LINE_LENGTH + 1;
+	char *text = (char *)_Arena.alloc(size);
+	if (!text)
+	{
+		sendJson_P(507, ERR_OUT_OF_MEMORY);
+		return;
+	}
+	size_t len = 0;
+	text[0] = '\0';
+	for (uint8_t t = 0; t < pwmChannel.Schedule->Count; t++)
+	{
+		int n = formatTargetLine(text + len, size - len, pwmChannel.Schedule->Targets[t]);
+		if (n < 0 || (size_t)n >= size - len)
+		{
+			// A time outside of the day, the line would not fit into TARGET_LINE_LENGTH
+			sendJson_P(500, ERR_SCHEDULE_EXPORT);
+			return;
+		}
+		len += n;
+	}
+	char disposition[40];
+	snprintf_P(disposition, sizeof(disposition), FMT_SCHEDULE_EXPORT_NAME, channel);
+	_Server.sendHeader("Content-Disposition", disposition);
+	_Server.send(200, "text/plain", text, len);
 }
 
 // API: POST /api/schedule/clear - Clears all schedules from all channels
@@ -430,38 +1003,17 @@ void handleApiScheduleClear()
 	// Clear all targets from all 6 visible channels
 	for (uint8_t channel = 0; channel < 6; channel++)
 	{
-		// Remove all targets from this channel
-		while (_aqc->_PwmChannels[channel].TargetCount > 0)
-		{
-			_aqc->_PwmChannels[channel].removeTargetAt(0);
-		}
-
-		// Also clear the SD card config file for this channel
-		char sTempFilename[30];
-		String sPwmFilename = "config/ledch_";
-		sPwmFilename += (channel <= 9 ? (String("0") + String(channel)) : String(channel));
-		sPwmFilename += ".cfg";
-		sPwmFilename.toCharArray(sTempFilename, 30);
-
-		if (SD.exists(sTempFilename))
-		{
-			if (SD.remove(sTempFilename))
-			{
-				Serial.print(F("Deleted config file: "));
-				Serial.println(sPwmFilename);
-			}
-			else
-			{
-				Serial.print(F("Failed to delete: "));
-				Serial.println(sPwmFilename);
-			}
-		}
+		// An empty snapshot replaces the targets of this channel
+		_aqc->editSchedule(channel, false);
+		_aqc->publishSchedule(channel);
 	}
+	// The (now empty) schedule store is written once the edits have settled
+	_ScheduleStore.noteReplaced();
 
 	_aqc->_IsFirstCycle = true;
 	Serial.println(F("✅ All schedules cleared"));
 
-	_Server.send(200, "application/json", "{\"status\":\"ok\",\"message\":\"All schedules cleared\"}");
+	sendJson_P(200, RESP_SCHEDULES_CLEARED);
 }
 
 // API: POST /api/schedule/target/add
@@ -481,7 +1033,7 @@ void handleApiTargetAdd()
 		int channelIdx = body.indexOf("\"channel\":");
 		if (channelIdx == -1)
 		{
-			_Server.send(400, "application/json", "{\"error\":\"Missing channel\"}");
+			sendJson_P(400, ERR_MISSING_CHANNEL);
 			return;
 		}
 		int channelStart = channelIdx + 10;
@@ -494,7 +1046,7 @@ void handleApiTargetAdd()
 		int timeIdx = body.indexOf("\"time\":");
 		if (timeIdx == -1)
 		{
-			_Server.send(400, "application/json", "{\"error\":\"Missing time\"}");
+			sendJson_P(400, ERR_MISSING_TIME);
 			return;
 		}
 		int timeStart = timeIdx + 7;
@@ -512,7 +1064,7 @@ void handleApiTargetAdd()
 		int valueIdx = body.indexOf("\"value\":");
 		if (valueIdx == -1)
 		{
-			_Server.send(400, "application/json", "{\"error\":\"Missing value\"}");
+			sendJson_P(400, ERR_MISSING_VALUE);
 			return;
 		}
 		int valueStart = valueIdx + 8;
@@ -530,7 +1082,7 @@ void handleApiTargetAdd()
 		// Fallback to query arguments
 		if (!_Server.hasArg("channel") || !_Server.hasArg("time") || !_Server.hasArg("value"))
 		{
-			_Server.send(400, "application/json", "{\"error\":\"Missing parameters\"}");
+			sendJson_P(400, ERR_MISSING_PARAMETERS);
 			return;
 		}
 		channel = _Server.arg("channel").toInt();
@@ -543,28 +1095,15 @@ void handleApiTargetAdd()
 
 	if (channel >= 6)
 	{
-		_Server.send(400, "application/json", "{\"error\":\"Invalid channel\"}");
+		sendJson_P(400, ERR_INVALID_CHANNEL);
 		return;
 	}
 
-	// Remove existing target at same time if present
-	for (uint8_t i = 0; i < _aqc->_PwmChannels[channel].TargetCount; i++)
-	{
-		if (_aqc->_PwmChannels[channel].Targets[i].Time == targetTime)
-		{
-			_aqc->_PwmChannels[channel].removeTargetAt(i);
-			break;
-		}
-	}
-
-	// Add new target
+	// Add new target, replacing an existing one at the same time. It is journaled once the edits have settled.
 	Target t;
 	t.Time = targetTime;
 	t.Value = finalValue;
-	_aqc->_PwmChannels[channel].addTarget(t);
-
-	// Persist to SD
-	_aqc->writeLedConfig(channel);
+	_aqc->setScheduleTarget(channel, t);
 	_aqc->_IsFirstCycle = true;
 
 	Serial.print(F("Added target: ch="));
@@ -574,7 +1113,7 @@ void handleApiTargetAdd()
 	Serial.print(F(", value="));
 	Serial.println(finalValue);
 
-	_Server.send(200, "application/json", "{\"success\":true}");
+	sendJson_P(200, RESP_SUCCESS);
 }
 
 // API: POST /api/schedule/target/delete
@@ -586,7 +1125,7 @@ void handleApiTargetDelete()
 	int channelIdx = body.indexOf("\"channel\":");
 	if (channelIdx == -1)
 	{
-		_Server.send(400, "application/json", "{\"error\":\"Missing channel\"}");
+		sendJson_P(400, ERR_MISSING_CHANNEL);
 		return;
 	}
 	int channelStart = channelIdx + 10;
@@ -599,7 +1138,7 @@ void handleApiTargetDelete()
 	int timeIdx = body.indexOf("\"time\":");
 	if (timeIdx == -1)
 	{
-		_Server.send(400, "application/json", "{\"error\":\"Missing time\"}");
+		sendJson_P(400, ERR_MISSING_TIME);
 		return;
 	}
 	int timeStart = timeIdx + 7;
@@ -612,21 +1151,256 @@ void handleApiTargetDelete()
 		timeStr = timeStr.substring(1, timeStr.length() - 1);
 	long targetTime = parseTimeToSeconds(timeStr);
 
-	// Find and remove target
-	for (uint8_t i = 0; i < _aqc->_PwmChannels[channel].TargetCount; i++)
+	if (channel >= 6)
+	{
+		sendJson_P(400, ERR_INVALID_CHANNEL);
+		return;
+	}
+
+	// Remove the target, it is journaled once the edits have settled
+	_aqc->removeScheduleTarget(channel, targetTime);
+	_aqc->_IsFirstCycle = true;
+
+	sendJson_P(200, RESP_OK);
+}
+
+// Staged copy of one channel for /api/schedule/batch, targets packed as (seconds of day << 8) | value
+// so a plain comparison keeps them in time order
+struct BatchChannel
+{
+	uint32_t Packed[MAX_TARGET_COUNT_PER_CHANNEL];
+	uint8_t Count;
+	bool Touched;
+};
+
+// Helper: Copies the value of "key" from a flat JSON object into out (without quotes), false if missing
+static bool batchField(const char *obj, const char *key, char *out, size_t size)
+{
+	char pattern[16];
+	snprintf(pattern, sizeof(pattern), "\"%s\"", key);
+	const char *p = strstr(obj, pattern);
+	if (!p)
+	{
+		return false;
+	}
+	p += strlen(pattern);
+	while (*p == ' ' || *p == ':')
+	{
+		p++;
+	}
+	if (*p == '"')
+	{
+		p++;
+	}
+	size_t len = strcspn(p, "\",}");
+	if (len == 0 || len >= size)
+	{
+		return false;
+	}
+	memcpy(out, p, len);
+	out[len] = '\0';
+	return true;
+}
+
+// Helper: Index of the staged target at time, -1 if there is none
+static int8_t findStaged(const BatchChannel &stage, long time)
+{
+	for (uint8_t i = 0; i < stage.Count; i++)
+	{
+		if ((long)(stage.Packed[i] >> 8) == time)
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+static bool removeStaged(BatchChannel &stage, long time)
+{
+	int8_t pos = findStaged(stage, time);
+	if (pos < 0)
+	{
+		return false;
+	}
+	memmove(&stage.Packed[pos], &stage.Packed[pos + 1], (stage.Count - pos - 1) * sizeof(uint32_t));
+	stage.Count--;
+	return true;
+}
+
+// Inserts in time order, a target at the same time is replaced (like /api/schedule/target/add)
+static bool insertStaged(BatchChannel &stage, long time, uint8_t value)
+{
+	removeStaged(stage, time);
+	if (stage.Count >= MAX_TARGET_COUNT_PER_CHANNEL)
+	{
+		return false;
+	}
+	uint32_t packed = ((uint32_t)time << 8) | value;
+	uint8_t pos = 0;
+	while (pos < stage.Count && stage.Packed[pos] < packed)
+	{
+		pos++;
+	}
+	memmove(&stage.Packed[pos + 1], &stage.Packed[pos], (stage.Count - pos) * sizeof(uint32_t));
+	stage.Packed[pos] = packed;
+	stage.Count++;
+	return true;
+}
+
+// Helper: Validates one batch operation and applies it to the staged channels
+static bool applyBatchOp(const char *obj, BatchChannel *stages)
+{
+	char op[8];
+	char field[16];
+	if (!batchField(obj, "op", op, sizeof(op)) || !batchField(obj, "channel", field, sizeof(field)))
+	{
+		return false;
+	}
+	long channel = atol(field);
+	if (channel < 0 || channel >= 6 || !batchField(obj, "time", field, sizeof(field)))
+	{
+		return false;
+	}
+	long time = parseTimeToSeconds(field);
+	if (time < 0 || time > 86400)
+	{
+		return false;
+	}
+
+	BatchChannel &stage = stages[channel];
+	if (!stage.Touched)
 	{
-		if (_aqc->_PwmChannels[channel].Targets[i].Time == targetTime)
+		const PwmChannel &live = _aqc->_PwmChannels[channel];
+		for (uint8_t i = 0; i < live.Schedule->Count; i++)
+		{
+			stage.Packed[i] = ((uint32_t)live.Schedule->Targets[i].Time << 8) | live.Schedule->Targets[i].Value;
+		}
+		stage.Count = live.Schedule->Count;
+		stage.Touched = true;
+	}
+
+	if (strcmp(op, "delete") == 0)
+	{
+		return removeStaged(stage, time);
+	}
+
+	long value = -1;
+	if (batchField(obj, "value", field, sizeof(field)))
+	{
+		value = max(0L, min(100L, atol(field)));
+	}
+	if (strcmp(op, "add") == 0)
+	{
+		return value >= 0 && insertStaged(stage, time, (uint8_t)value);
+	}
+	if (strcmp(op, "move") == 0)
+	{
+		// Moves the target at "from" to "time", keeping its value unless a new one is given
+		if (!batchField(obj, "from", field, sizeof(field)))
+		{
+			return false;
+		}
+		int8_t pos = findStaged(stage, parseTimeToSeconds(field));
+		if (pos < 0)
+		{
+			return false;
+		}
+		if (value < 0)
+		{
+			value = stage.Packed[pos] & 0xFF;
+		}
+		removeStaged(stage, stage.Packed[pos] >> 8);
+		return insertStaged(stage, time, (uint8_t)value);
+	}
+	return false;
+}
+
+// API: POST /api/schedule/batch - an ordered list of target operations across channels, e.g.
+// {"ops":[{"op":"add","channel":0,"time":3600,"value":50},{"op":"move","channel":0,"from":3600,"time":"01:30"},
+//         {"op":"delete","channel":1,"time":7200}]}
+// All operations are applied to a staged copy first. If one fails nothing changes, otherwise every
+// touched channel is replaced, persisted once and the outputs are refreshed once.
+void handleApiScheduleBatch()
+{
+	String body = _Server.arg("plain");
+	char *p = body.length() > 0 ? strstr(&body[0], "\"ops\"") : nullptr;
+	if (p)
+	{
+		p = strchr(p, '[');
+	}
+	if (!p)
+	{
+		sendJson_P(400, ERR_MISSING_OPS);
+		return;
+	}
+
+	BatchChannel *stages = (BatchChannel *)_Arena.alloc(sizeof(BatchChannel) * 6);
+	if (!stages)
+	{
+		sendJson_P(500, ERR_OUT_OF_MEMORY);
+		return;
+	}
+	for (uint8_t ch = 0; ch < 6; ch++)
+	{
+		stages[ch].Count = 0;
+		stages[ch].Touched = false;
+	}
+
+	char buf[64];
+	uint16_t index = 0;
+	while (true)
+	{
+		char *obj = p + strcspn(p, "{]");
+		if (*obj != '{')
 		{
-			_aqc->_PwmChannels[channel].removeTargetAt(i);
 			break;
 		}
+		char *end = strchr(obj, '}');
+		if (end)
+		{
+			*end = '\0';
+		}
+		if (!end || !applyBatchOp(obj, stages))
+		{
+			sprintf_P(buf, FMT_BATCH_ERROR, index);
+			sendJson(400, buf);
+			return;
+		}
+		p = end + 1;
+		index++;
 	}
 
-	// Persist to SD
-	_aqc->writeLedConfig(channel);
-	_aqc->_IsFirstCycle = true;
+	uint8_t touched = 0;
+	for (uint8_t ch = 0; ch < 6; ch++)
+	{
+		if (!stages[ch].Touched)
+		{
+			continue;
+		}
+		ScheduleSnapshot *schedule = _aqc->editSchedule(ch, false);
+		for (uint8_t i = 0; i < stages[ch].Count; i++)
+		{
+			schedule->Targets[i].Time = stages[ch].Packed[i] >> 8;
+			schedule->Targets[i].Value = stages[ch].Packed[i] & 0xFF;
+		}
+		schedule->Count = stages[ch].Count;
+		_aqc->publishSchedule(ch);
+		_aqc->scheduleChanged();
+		touched++;
+	}
+	if (touched > 0)
+	{
+		_aqc->_IsFirstCycle = true;
+	}
+
+	Serial.print(F("Schedule batch: "));
+	Serial.print(index);
+	Serial.print(F(" ops, "));
+	Serial.print(touched);
+	Serial.println(F(" channels"));
 
-	_Server.send(200, "application/json", "{\"status\":\"ok\"}");
+	sprintf_P(buf, FMT_BATCH_APPLIED, index, touched);
+	sendJson(200, buf);
 }
 
 // API: POST /api/test/start
@@ -636,9 +1410,11 @@ void handleApiTestStart()
 	{
 		_aqc->_PwmChannels[i].TestMode = true;
 		_aqc->_PwmChannels[i].TestModeSetTime = _aqc->CurrentSecOfDay;
+		_aqc->_PwmChannels[i].TestInstant = false;
 	}
 	Serial.println(F("Test mode STARTED"));
-	_Server.send(200, "application/json", "{\"status\":\"ok\",\"test_mode\":true}");
+	_aqc->notifyChange(ChangeTestMode);
+	sendJson_P(200, RESP_TEST_STARTED);
 }
 
 // API: POST /api/test/update
@@ -705,7 +1481,7 @@ void handleApiTestUpdate()
 		}
 	}
 
-	_Server.send(200, "application/json", "{\"status\":\"ok\"}");
+	sendJson_P(200, RESP_OK);
 }
 
 // API: POST /api/test/exit
@@ -714,251 +1490,262 @@ void handleApiTestExit()
 	for (uint8_t i = 0; i < 6; i++)
 	{
 		_aqc->_PwmChannels[i].TestMode = false;
+		_aqc->_PwmChannels[i].TestInstant = false;
 	}
 	Serial.println(F("Test mode EXITED"));
-	_Server.send(200, "application/json", "{\"status\":\"ok\",\"test_mode\":false}");
+	_aqc->notifyChange(ChangeTestMode);
+	sendJson_P(200, RESP_TEST_EXITED);
 }
 
-// Forward declaration
-uint32_t computeMacroDurationFromFiles(const String &macroId);
-
-// Helper: Save macro metadata (name + duration) to JSON file
-bool saveMacroMetadata(const String &macroId, const String &name, uint32_t duration)
+// Helper: Load macro name and duration from the macro index or the trailer of the macro file
+// Returns true if the macro was found, false otherwise
+// outName points into the index, the request arena or at macroId, it is valid until the request ends
+bool loadMacroMetadata(const char *macroId, const char *&outName, uint32_t &outDuration)
 {
-	char metadataPath[50];
-	sprintf(metadataPath, "macros/%s.json", macroId.c_str());
-
-	// Delete old metadata if exists
-	if (SD.exists(metadataPath))
+	const MacroIndexEntry *entry = _MacroIndex.find(macroId);
+	if (entry)
 	{
-		SD.remove(metadataPath);
+		outName = entry->Name;
+		outDuration = entry->Duration;
+		return true;
 	}
 
-	// Create new metadata file
-	File metaFile = SD.open(metadataPath, FILE_WRITE);
-	if (!metaFile)
+	// Macros with an id the index does not cover (not macro_NNN)
+	outName = macroId;
+	outDuration = 0;
+	MacroReader reader;
+	if (!reader.open(macroId))
 	{
-		Serial.print(F("Error: Couldn't create metadata file "));
-		Serial.println(metadataPath);
 		return false;
 	}
-
-	// Write JSON metadata (stream to avoid heap fragmentation)
-	metaFile.print("{\"name\":\"");
-	metaFile.print(name);
-	metaFile.print("\",\"duration\":");
-	metaFile.print(duration);
-	metaFile.print("}");
-	metaFile.close();
-
-	Serial.print(F("✅ Metadata saved: "));
-	Serial.println(metadataPath);
+	outDuration = reader.info().Duration;
+	char *name = _Arena.allocString(MACRO_NAME_LENGTH);
+	if (name)
+	{
+		strcpy(name, reader.info().Name);
+		outName = name;
+	}
+	reader.close();
 	return true;
 }
 
-// Helper: Load macro metadata from JSON file
-// Returns true if metadata found, false otherwise
-bool loadMacroMetadata(const String &macroId, String &outName, uint32_t &outDuration)
+// Helper: Compute macro duration and name (wrapper using metadata)
+// Returns duration in seconds and sets name via parameter (see loadMacroMetadata for its lifetime)
+uint32_t computeMacroDuration(const char *macroId, const char *&outName)
 {
-	char metadataPath[50];
-	sprintf(metadataPath, "macros/%s.json", macroId.c_str());
+	uint32_t duration = 0;
+	loadMacroMetadata(macroId, outName, duration);
+	return duration;
+}
 
-	if (!SD.exists(metadataPath))
+// API: GET /api/macro/list
+// Job step: sends the entries of the macro index (Position is the next entry)
+static bool stepMacroList(ResponseJob &job)
+{
+	while (job.Position < _MacroIndex.count())
 	{
-		// Fallback: compute duration from files, use ID as name
-		outName = macroId;
-		outDuration = computeMacroDurationFromFiles(macroId);
-		return false;
-	}
+		if (job.writable() < 128)
+		{
+			return true; // Resume when the client has read more
+		}
+		const MacroIndexEntry &entry = _MacroIndex.entry(job.Position);
+		if (job.Position++ > 0)
+			job.print(",");
+		job.LastProgress = millis();
+
+		char buf[16];
+		sprintf(buf, "macro_%03u", entry.Number);
+		job.print_P(KEY_ID);
+		job.print(buf);
+		job.print_P(KEY_NAME);
+		job.print(entry.Name);
+		job.print_P(KEY_DURATION);
+		sprintf(buf, "%lu", (unsigned long)entry.Duration);
+		job.print(buf);
+		if (entry.Flags & MacroFavorite)
+			job.print_P(KEY_FAVORITE);
+		job.print("}");
+	}
+	job.print("]}");
+	return false;
+}
 
-	File metaFile = SD.open(metadataPath);
-	if (!metaFile)
-	{
-		outName = macroId;
-		outDuration = computeMacroDurationFromFiles(macroId);
-		return false;
-	}
+void handleApiMacroList()
+{
+	// List all macros from the index, long lists are sent as a job across loop cycles
+	WiFiClient &client = _Server.client();
+	writeResponseHead(client, 200, "application/json", -1);
+	client.write_P(KEY_MACROS, strlen_P(KEY_MACROS));
+	_Jobs.start(stepMacroList, ResponseJobInteractive);
+}
 
-	// Parse JSON manually (avoid ArduinoJson to save RAM)
-	String json = "";
-	while (metaFile.available())
-	{
-		json += (char)metaFile.read();
-	}
-	metaFile.close();
+static File openChannelConfig()
+{
+	return SD.open(F("config/channels.cfg"), FILE_READ);
+}
 
-	// Extract name
-	int nameIdx = json.indexOf("\"name\":\"");
-	if (nameIdx != -1)
+// Sections of /api/bootstrap, in response order
+enum BootstrapStage : uint8_t
+{
+	BootstrapStatus,
+	BootstrapConfig,
+	BootstrapSchedules,
+	BootstrapMacros
+};
+
+// Job step: {"status":<status>,"config":<channel config>,"schedules":<all schedules>,"macros":<macro list>}
+// Each section is the body of the single endpoint. Status and schedules come from RAM, the channel
+// config file is streamed and the macro list continues with stepMacroList.
+static bool stepBootstrap(ResponseJob &job)
+{
+	switch (job.Stage)
 	{
-		int nameStart = nameIdx + 8;
-		int nameEnd = json.indexOf("\"", nameStart);
-		if (nameEnd != -1)
+	case BootstrapStatus:
+	{
+		const StatusSnapshot &status = currentStatus();
+		if (job.writable() < status.Length + 64u)
 		{
-			outName = json.substring(nameStart, nameEnd);
+			return true;
+		}
+		job.print_P(KEY_BOOTSTRAP_STATUS);
+		job.print(status.Json);
+		job.print_P(KEY_BOOTSTRAP_CONFIG);
+		job.Source = openChannelConfig();
+		if (job.Source)
+		{
+			job.Remaining = job.Source.size();
 		}
 		else
 		{
-			outName = macroId;
+			job.print_P(RESP_DEFAULT_CHANNELS);
+			job.Remaining = 0;
 		}
+		job.Stage = BootstrapConfig;
+		return true;
 	}
-	else
-	{
-		outName = macroId;
-	}
-
-	// Extract duration
-	int durIdx = json.indexOf("\"duration\":");
-	if (durIdx != -1)
-	{
-		int durStart = durIdx + 11;
-		int durEnd = json.indexOf("}", durStart);
-		if (durEnd == -1)
+	case BootstrapConfig:
+		if (job.Remaining > 0)
 		{
-			durEnd = json.length();
+			job.Remaining -= job.sendFile(job.Remaining);
+			return true;
 		}
-		String durStr = json.substring(durStart, durEnd);
-		durStr.trim();
-		outDuration = durStr.toInt();
-	}
-	else
-	{
-		outDuration = computeMacroDurationFromFiles(macroId);
-	}
-
-	return true;
-}
-
-// Helper: Compute macro duration from stored channel files (fallback when no metadata)
-// Returns duration in seconds (0 if no macro files found)
-uint32_t computeMacroDurationFromFiles(const String &macroId)
-{
-	uint32_t maxTime = 0;
-	bool foundAnyFile = false;
-
-	// Scan all 16 channels to find max target time
-	for (uint8_t ch = 0; ch < PWM_CHANNELS; ch++)
-	{
-		char sTempFilename[50];
-		sprintf(sTempFilename, "macros/%s_ch%02d.cfg", macroId.c_str(), ch);
-
-		if (SD.exists(sTempFilename))
+		if (job.Source)
+		{
+			job.Source.close();
+		}
+		job.print_P(KEY_BOOTSTRAP_SCHEDULES);
+		job.print_P(KEY_SCHEDULES);
+		job.Position = 0; // Channel
+		job.Count = 0;	  // Target of the channel
+		job.Stage = BootstrapSchedules;
+		return true;
+	case BootstrapSchedules:
+	{
+		char buf[64];
+		while (job.Position < 6)
 		{
-			foundAnyFile = true;
-			File macroFile = SD.open(sTempFilename);
-			if (macroFile)
+			if (job.writable() < sizeof(buf))
+			{
+				return true;
+			}
+			const PwmChannel &channel = _aqc->_PwmChannels[job.Position];
+			// Remaining flags that the head of the current channel has been sent
+			if (job.Remaining == 0)
+			{
+				if (job.Position > 0)
+					job.print(",");
+				sprintf_P(buf, FMT_CHANNEL_TARGETS, (unsigned int)job.Position);
+				job.print(buf);
+				job.Remaining = 1;
+				job.Count = 0;
+			}
+			else if (job.Count < channel.Schedule->Count)
+			{
+				if (job.Count > 0)
+					job.print(",");
+				sprintf_P(buf, FMT_TARGET, (unsigned long)channel.Schedule->Targets[job.Count].Time,
+						  (unsigned int)channel.Schedule->Targets[job.Count].Value);
+				job.print(buf);
+				job.Count++;
+			}
+			else
 			{
-				// Use char buffer instead of String to avoid heap fragmentation
-				char lineBuf[64];
-				while (macroFile.available())
-				{
-					int len = macroFile.readBytesUntil('\n', lineBuf, sizeof(lineBuf) - 1);
-					if (len == 0)
-						continue;
-					lineBuf[len] = '\0';
-
-					// Strip CR if present
-					if (len > 0 && lineBuf[len - 1] == '\r')
-					{
-						lineBuf[len - 1] = '\0';
-						len--;
-					}
-
-					// Skip empty lines or comments
-					if (len == 0 || (lineBuf[0] == '/' && lineBuf[1] == '/'))
-						continue;
-
-					// Find semicolon separator
-					char *semi = strchr(lineBuf, ';');
-					if (!semi)
-						continue;
-
-					// Parse time from start to semicolon
-					long timeVal = 0;
-					char *colon = strchr(lineBuf, ':');
-					if (colon && colon < semi)
-					{
-						// MM:SS format
-						*colon = '\0';
-						timeVal = atoi(lineBuf) * 60 + atoi(colon + 1);
-					}
-					else
-					{
-						// Seconds format
-						timeVal = atoi(lineBuf);
-					}
-
-					if ((uint32_t)timeVal > maxTime)
-					{
-						maxTime = (uint32_t)timeVal;
-					}
-				}
-				macroFile.close();
+				job.print("]}");
+				job.Position++;
+				job.Remaining = 0;
 			}
 		}
+		job.print("]}");
+		job.print_P(KEY_BOOTSTRAP_MACROS);
+		job.print_P(KEY_MACROS);
+		job.Position = 0; // First index entry for stepMacroList
+		job.Count = 0;
+		job.Stage = BootstrapMacros;
+		return true;
+	}
+	case BootstrapMacros:
+		if (stepMacroList(job))
+		{
+			return true;
+		}
+		job.print("}");
+		return false;
 	}
-
-	return foundAnyFile ? maxTime : 0;
+	return false;
 }
 
-// Helper: Compute macro duration and name (wrapper using metadata)
-// Returns duration in seconds and sets name via parameter
-uint32_t computeMacroDuration(const String &macroId, String &outName)
+// API: GET /api/bootstrap - everything the UI loads on startup in one response
+void handleApiBootstrap()
 {
-	uint32_t duration = 0;
-	loadMacroMetadata(macroId, outName, duration);
-	return duration;
+	WiFiClient &client = _Server.client();
+	writeResponseHead(client, 200, "application/json", -1, "Cache-Control: no-cache\r\n");
+	_Jobs.start(stepBootstrap, ResponseJobInteractive);
 }
 
-// API: GET /api/macro/list
-void handleApiMacroList()
+// Helper: /api/macro/get as CBOR, same schema as the JSON response
+static void sendMacroCbor(const char *macroId, const char *macroName, uint32_t duration)
 {
-	// List all macro files from macros/ directory
-	_Server.setContentLength(CONTENT_LENGTH_UNKNOWN);
-	_Server.send(200, "application/json", "");
-
-	_Server.sendContent("{\"macros\":[");
-
-	// Enumerate macro files: check for pattern macros/macro_NNN_ch00.cfg
-	// This identifies all macros by checking the first channel file
-	bool firstMacro = true;
-	for (uint16_t macroNum = 1; macroNum <= 999; macroNum++)
+	MacroReader reader;
+	bool open = reader.open(macroId);
+	uint8_t buf[CBOR_CHUNK_SIZE];
+	CborWriter cbor(buf, sizeof(buf), sendCborChunk);
+	beginCborStream();
+	cbor.map(4);
+	cbor.key(CBOR_KEY_ID);
+	cbor.text(macroId);
+	cbor.key(CBOR_KEY_NAME);
+	cbor.text(macroName);
+	cbor.key(CBOR_KEY_DURATION);
+	cbor.uint(duration);
+	cbor.key(CBOR_KEY_CHANNELS);
+	cbor.array(6);
+	for (uint8_t ch = 0; ch < 6; ch++)
 	{
-		char sTempFilename[50];
-		String sMacroPath = "macros/macro_";
-		sMacroPath += (macroNum <= 9 ? "00" : (macroNum <= 99 ? "0" : ""));
-		sMacroPath += String(macroNum);
-		sMacroPath += "_ch00.cfg";
-		sMacroPath.toCharArray(sTempFilename, 50);
-
-		if (SD.exists(sTempFilename))
+		cbor.map(2);
+		cbor.key(CBOR_KEY_CHANNEL);
+		cbor.uint(ch);
+		cbor.key(CBOR_KEY_TARGETS);
+		if (!open || !reader.channel(ch))
 		{
-			if (!firstMacro)
-				_Server.sendContent(",");
-			firstMacro = false;
-
-			// Build macro ID (e.g., "macro_001")
-			String macroIdStr = sMacroPath.substring(7, sMacroPath.indexOf("_ch"));
-
-			// Compute duration and get name
-			String macroName;
-			uint32_t duration = computeMacroDuration(macroIdStr, macroName);
-
-			// Send JSON with id, name, and duration
-			// Use _Server.sendContent() to avoid buffer size concerns
-			_Server.sendContent("{\"id\":\"");
-			_Server.sendContent(macroIdStr);
-			_Server.sendContent("\",\"name\":\"");
-			_Server.sendContent(macroName);
-			_Server.sendContent("\",\"duration\":");
-			char durBuf[16];
-			sprintf(durBuf, "%lu", (unsigned long)duration);
-			_Server.sendContent(durBuf);
-			_Server.sendContent("}");
+			cbor.array(0);
+			continue;
+		}
+		cbor.array(reader.info().Counts[ch]);
+		uint32_t time;
+		uint8_t value;
+		while (reader.next(time, value))
+		{
+			cbor.map(3);
+			cbor.key(CBOR_KEY_TIME);
+			cbor.uint(time);
+			cbor.key(CBOR_KEY_VALUE);
+			cbor.uint(value);
+			cbor.key(CBOR_KEY_IS_CONTROL);
+			cbor.boolean(true);
 		}
 	}
-
-	_Server.sendContent("]}");
+	reader.close();
+	cbor.flush();
 }
 
 // API: GET /api/macro/get?id=xxx
@@ -971,105 +1758,68 @@ void handleApiMacroGet()
 
 	if (macroId.length() == 0)
 	{
-		_Server.send(400, "application/json", "{\"error\":\"Missing macro id\"}");
+		sendJson_P(400, ERR_MISSING_MACRO_ID);
+		return;
+	}
+	// The index entry changes its version whenever the macro is saved again (or rebuilt after an upload)
+	const MacroIndexEntry *entry = _MacroIndex.find(macroId.c_str());
+	if (entry && respondNotModified('m', entry->Version))
+	{
 		return;
 	}
-
-	// Try to load macro targets for all 6 channels
-	_Server.setContentLength(CONTENT_LENGTH_UNKNOWN);
-	_Server.send(200, "application/json", "");
 
 	// Compute duration and name
-	String macroName;
-	uint32_t duration = computeMacroDuration(macroId, macroName);
+	const char *macroName;
+	uint32_t duration = computeMacroDuration(macroId.c_str(), macroName);
+	if (wantsCbor())
+	{
+		sendMacroCbor(macroId.c_str(), macroName, duration);
+		return;
+	}
+
+	// Try to load macro targets for all 6 channels
+	beginJsonStream();
 
-	_Server.sendContent("{\"id\":\"");
+	_Server.sendContent_P(KEY_ID);
 	_Server.sendContent(macroId);
-	_Server.sendContent("\",\"name\":\"");
+	_Server.sendContent_P(KEY_NAME);
 	_Server.sendContent(macroName);
-	_Server.sendContent("\",\"duration\":");
+	_Server.sendContent_P(KEY_DURATION);
 	char durBuf[16];
 	sprintf(durBuf, "%lu", (unsigned long)duration);
 	_Server.sendContent(durBuf);
-	_Server.sendContent(",\"channels\":[");
+	_Server.sendContent_P(KEY_CHANNELS);
 
+	// All channels come from the one macro file, a missing macro has empty channels
+	MacroReader reader;
+	bool open = reader.open(macroId.c_str());
 	char buf[48]; // Buffer for formatting JSON within the loop
 	for (uint8_t ch = 0; ch < 6; ch++)
 	{
 		if (ch > 0)
 			_Server.sendContent(",");
 
-		sprintf(buf, "{\"channel\":%u,\"targets\":[", ch);
+		sprintf_P(buf, FMT_CHANNEL_TARGETS, ch);
 		_Server.sendContent(buf);
 
-		// Try to read macro file (use consistent format with save: %02d for leading zeros)
-		char sTempFilename[50];
-		sprintf(sTempFilename, "macros/%s_ch%02d.cfg", macroId.c_str(), ch);
-
-		Serial.print(F("  Trying to open: "));
-		Serial.print(sTempFilename);
-
-		File macroFile = SD.open(sTempFilename);
-		if (macroFile)
+		if (open && reader.channel(ch))
 		{
-			Serial.print(F(" ✓ (size="));
-			Serial.print(macroFile.size());
-			Serial.println(F(" bytes)"));
 			uint8_t targetCount = 0;
-			bool targetFirst = true;
-			while (macroFile.available())
+			uint32_t time;
+			uint8_t value;
+			while (reader.next(time, value))
 			{
-				String sLine = macroFile.readStringUntil(10);
-				if (sLine.length() > 0 && sLine.charAt(sLine.length() - 1) == 13)
-				{
-					sLine = sLine.substring(0, sLine.length() - 1);
-				}
-				if (sLine.length() == 0 || sLine.startsWith("//"))
-					continue;
-
-				int semiIdx = sLine.indexOf(';');
-				if (semiIdx == -1)
-					continue;
-
-				String timeStr = sLine.substring(0, semiIdx);
-				String valueStr = sLine.substring(semiIdx + 1);
-
-				int colonIdx = timeStr.indexOf(':');
-				long timeVal = 0;
-				if (colonIdx != -1)
-				{
-					int mins = timeStr.substring(0, colonIdx).toInt();
-					int secs = timeStr.substring(colonIdx + 1).toInt();
-					timeVal = (mins * 60) + secs;
-				}
-				else
-				{
-					timeVal = timeStr.toInt();
-				}
-
-				int value = valueStr.toInt();
-				value = max(0, min(100, value));
-
-				if (!targetFirst)
+				if (targetCount > 0)
 					_Server.sendContent(",");
-				targetFirst = false;
-
-				sprintf(buf, "{\"time\":%ld,\"value\":%d,\"isControl\":true}", timeVal, value);
+				sprintf_P(buf, FMT_TARGET, (unsigned long)time, (unsigned int)value);
 				_Server.sendContent(buf);
 				targetCount++;
 			}
-			macroFile.close();
-			Serial.print(F("    Loaded "));
-			Serial.print(targetCount);
-			Serial.println(F(" targets"));
-		}
-		else
-		{
-			Serial.println(F(" ✗ NOT FOUND"));
 		}
 
 		_Server.sendContent("]}");
 	}
+	reader.close();
 
 	_Server.sendContent("]}");
 }
@@ -1095,13 +1845,17 @@ void handleApiMacroSave()
 
 	// Determine macro ID: use requested ID if it exists (edit mode), otherwise generate new one
 	String macroId;
-	char sTempFilename[50];
 
 	if (requestedMacroId.length() > 0 && requestedMacroId.startsWith("macro_"))
 	{
-		// Edit mode: use the provided ID if it exists
-		sprintf(sTempFilename, "macros/%s_ch00.cfg", requestedMacroId.c_str());
-		if (SD.exists(sTempFilename))
+		// Edit mode: use the provided ID if it exists. Only macro_NNN ids are listed by the index.
+		uint16_t requestedNum;
+		if (!parseMacroNumber(requestedMacroId.c_str(), requestedNum))
+		{
+			sendJson_P(400, ERR_INVALID_ID);
+			return;
+		}
+		if (_MacroIndex.find(requestedNum))
 		{
 			macroId = requestedMacroId;
 			Serial.print(F("📝 Editing existing macro: "));
@@ -1109,7 +1863,12 @@ void handleApiMacroSave()
 		}
 		else
 		{
-			// Requested ID doesn't exist - treat as new macro with that ID
+			// Requested ID doesn't exist - treat as new macro with that ID, if the index has room for it
+			if (_MacroIndex.count() >= MACRO_INDEX_CAPACITY)
+			{
+				sendJson_P(507, ERR_MACRO_LIMIT);
+				return;
+			}
 			macroId = requestedMacroId;
 			Serial.print(F("➕ Creating new macro with requested ID: "));
 			Serial.println(macroId);
@@ -1117,22 +1876,15 @@ void handleApiMacroSave()
 	}
 	else
 	{
-		// Create mode: find next available macro_NNN slot
-		uint16_t macroNum = 1;
-		char normalizedMacroId[16];
-
-		while (macroNum <= 999)
+		// Create mode: take the lowest macro_NNN slot the index has not in use
+		uint16_t macroNum = _MacroIndex.nextFreeNumber();
+		if (macroNum == 0)
 		{
-			sprintf(normalizedMacroId, "macro_%03d", macroNum);
-			sprintf(sTempFilename, "macros/%s_ch00.cfg", normalizedMacroId);
-
-			if (!SD.exists(sTempFilename))
-			{
-				break; // Found an available slot
-			}
-			macroNum++;
+			sendJson_P(507, ERR_MACRO_LIMIT);
+			return;
 		}
-
+		char normalizedMacroId[16];
+		sprintf(normalizedMacroId, "macro_%03u", macroNum);
 		macroId = normalizedMacroId;
 		Serial.print(F("➕ Creating new macro: "));
 		Serial.println(macroId);
@@ -1181,7 +1933,7 @@ void handleApiMacroSave()
 	int channelsIdx = body.indexOf("\"channels\":[");
 	if (channelsIdx == -1)
 	{
-		_Server.send(400, "application/json", "{\"error\":\"Missing channels\"}");
+		sendJson_P(400, ERR_MISSING_CHANNELS);
 		return;
 	}
 
@@ -1202,7 +1954,15 @@ void handleApiMacroSave()
 	arrayEnd--; // Move back to the position of the final ]
 	String channelsStr = body.substring(arrayStart, arrayEnd);
 
-	// Save each channel's targets
+	// Collect the targets of all channels first, the macro file holds them in channel order
+	uint32_t *records = (uint32_t *)_Arena.alloc(6 * MAX_TARGET_COUNT_PER_CHANNEL * sizeof(uint32_t));
+	if (!records)
+	{
+		sendJson_P(500, ERR_OUT_OF_MEMORY);
+		return;
+	}
+	uint8_t counts[6] = {0};
+	uint16_t channelMask = 0;
 	unsigned int pos = 0;
 
 	while (pos < channelsStr.length())
@@ -1262,9 +2022,8 @@ void handleApiMacroSave()
 			}
 			targetsEnd--; // Move back to the ] itself
 
-			// Create temp channel to store targets
-			PwmChannel tempChannel;
-			tempChannel.TargetCount = 0;
+			// Collect the targets sorted by time
+			ScheduleSnapshot sorted;
 
 			Serial.print(F("    Parsing targets from position "));
 			Serial.print(targetsStart);
@@ -1273,7 +2032,7 @@ void handleApiMacroSave()
 
 			// Parse target objects directly from channelsStr to reduce String allocations
 			unsigned int tPos = targetsStart;
-			while (tPos < (unsigned int)targetsEnd && tempChannel.TargetCount < MAX_TARGET_COUNT_PER_CHANNEL)
+			while (tPos < (unsigned int)targetsEnd && sorted.Count < MAX_TARGET_COUNT_PER_CHANNEL)
 			{
 				int tObjStart = channelsStr.indexOf('{', tPos);
 				if (tObjStart == -1 || tObjStart >= targetsEnd)
@@ -1315,7 +2074,7 @@ void handleApiMacroSave()
 					Target t;
 					t.Time = timeVal;
 					t.Value = (uint8_t)val;
-					tempChannel.addTarget(t);
+					sorted.add(t);
 
 					Serial.print(F("      Added target: time="));
 					Serial.print(timeVal);
@@ -1333,75 +2092,71 @@ void handleApiMacroSave()
 				tPos = tObjEnd + 1;
 			}
 
-			// Write macro file for this channel
+			// Keep the sorted targets of this channel until the file is written
+			uint32_t *channelRecords = records + channel * MAX_TARGET_COUNT_PER_CHANNEL;
+			for (uint8_t t = 0; t < sorted.Count; t++)
 			{
-				// Format macro path without String concatenation to avoid heap fragmentation
-				char sTempMacroPath[50];
-				sprintf(sTempMacroPath, "macros/%s_ch%02d.cfg", macroId.c_str(), channel);
-
-				Serial.print(F("  💾 Writing: "));
-				Serial.print(sTempMacroPath);
-				Serial.print(F(" ("));
-				Serial.print(tempChannel.TargetCount);
-				Serial.print(F(" targets)"));
-
-				// Delete old file if it exists
-				if (SD.exists(sTempMacroPath))
-				{
-					if (!SD.remove(sTempMacroPath))
-					{
-						Serial.print(F("Error: Couldn't remove old macro file "));
-						Serial.println(sTempMacroPath);
-						continue;
-					}
-				}
-
-				// Create new file
-				File configFile = SD.open(sTempMacroPath, FILE_WRITE);
-				if (!configFile)
-				{
-					Serial.print(F("Error: Couldn't create macro file "));
-					Serial.println(sTempMacroPath);
-					continue;
-				}
-
-				// Write all targets to file (same format as schedules)
-				for (uint8_t t = 0; t < tempChannel.TargetCount; t++)
-				{
-					Target tTarget = tempChannel.Targets[t];
-
-					// Format time as MM:SS for macro (duration-based, not 24h)
-					uint8_t iMin = tTarget.Time / 60;
-					uint8_t iSec = tTarget.Time % 60;
-
-					char timeBuf[8];
-					sprintf(timeBuf, "%02d:%02d", iMin, iSec);
-					configFile.print(timeBuf);
-
-					configFile.write(';');
-					char valueBuf[4];
-					sprintf(valueBuf, "%u", (unsigned int)tTarget.Value);
-					configFile.print(valueBuf);
-
-					configFile.write(13);
-					configFile.write(10);
-				}
-
-				configFile.close();
-				Serial.println(F(" ✓"));
+				channelRecords[t] = ((uint32_t)sorted.Targets[t].Time << 8) | sorted.Targets[t].Value;
 			}
+			counts[channel] = sorted.Count;
+			channelMask |= 1 << channel;
 		}
 
 		pos = objEnd + 1;
 	}
 
-	// Save metadata file with name and duration
-	if (macroDuration == 0)
+	// Macros are played from a cache slot, one that does not fit could be saved but never started
+	if (macroCacheRecords(counts, 6) > MACRO_CACHE_RECORDS)
+	{
+		Serial.print(F("Error: Macro has more targets than a cache slot holds: "));
+		Serial.println(macroId);
+		sendJson_P(413, ERR_MACRO_TOO_LARGE);
+		return;
+	}
+
+	// One file with name, duration and all channels, swapped in atomically
+	MacroWriter writer;
+	bool written = writer.begin(macroId.c_str());
+	for (uint8_t ch = 0; written && ch < 6; ch++)
+	{
+		if (!(channelMask & (1 << ch)))
+		{
+			continue;
+		}
+		writer.addChannel(ch);
+		const uint32_t *channelRecords = records + ch * MAX_TARGET_COUNT_PER_CHANNEL;
+		for (uint8_t t = 0; t < counts[ch]; t++)
+		{
+			writer.add(ch, channelRecords[t] >> 8, channelRecords[t] & 0xFF);
+		}
+	}
+	// Without a duration from the client the latest target time is taken
+	if (!written || !writer.commit(macroName.c_str(), macroDuration))
 	{
-		// Compute duration from saved files if not provided
-		macroDuration = computeMacroDurationFromFiles(macroId);
+		Serial.print(F("Error: Couldn't write macro "));
+		Serial.println(macroId);
+		sendJson_P(500, ERR_MACRO_WRITE);
+		return;
+	}
+	macroDuration = writer.info().Duration;
+	uint16_t macroNum;
+	parseMacroNumber(macroId.c_str(), macroNum); // Both modes end up with a valid macro_NNN
+	if (!_MacroIndex.put(macroNum, macroName.c_str(), macroDuration, channelMask))
+	{
+		Serial.print(F("Error: Couldn't add macro to the index: "));
+		Serial.println(macroId);
+		bool listed = _MacroIndex.find(macroNum) != nullptr;
+		// The file changed anyway, the rebuild gives its entry a new version
+		_MacroIndex.invalidate();
+		if (!listed)
+		{
+			sendJson_P(507, ERR_MACRO_LIMIT);
+			return;
+		}
+		sendJson_P(500, ERR_MACRO_INDEX);
+		return;
 	}
-	saveMacroMetadata(macroId, macroName, macroDuration);
+	_MacroCache.warm(); // A saved favorite is parsed again right away
 
 	Serial.print(F("✅ Macro saved: "));
 	Serial.print(macroName);
@@ -1413,13 +2168,12 @@ void handleApiMacroSave()
 	uint32_t duration = macroDuration;
 
 	// Build response with name (stream to avoid buffer limits)
-	_Server.setContentLength(CONTENT_LENGTH_UNKNOWN);
-	_Server.send(200, "application/json", "");
-	_Server.sendContent("{\"status\":\"ok\",\"id\":\"");
+	beginJsonStream();
+	_Server.sendContent_P(KEY_SAVED_ID);
 	_Server.sendContent(macroId);
-	_Server.sendContent("\",\"name\":\"");
+	_Server.sendContent_P(KEY_NAME);
 	_Server.sendContent(macroName);
-	_Server.sendContent("\",\"duration\":");
+	_Server.sendContent_P(KEY_DURATION);
 	char durBuf[16];
 	sprintf(durBuf, "%lu", (unsigned long)duration);
 	_Server.sendContent(durBuf);
@@ -1435,7 +2189,7 @@ void handleApiMacroActivate()
 	int idIdx = body.indexOf("\"id\":");
 	if (idIdx == -1)
 	{
-		_Server.send(400, "application/json", "{\"error\":\"Missing id\"}");
+		sendJson_P(400, ERR_MISSING_ID);
 		return;
 	}
 
@@ -1465,23 +2219,24 @@ void handleApiMacroActivate()
 	// If duration is zero or missing, compute from macro files
 	if (duration == 0)
 	{
-		String macroName;
-		duration = computeMacroDuration(macroId, macroName);
+		const char *macroName;
+		duration = computeMacroDuration(macroId.c_str(), macroName);
 		if (duration == 0)
 		{
-			_Server.send(400, "application/json", "{\"error\":\"Invalid duration\"}");
+			sendJson_P(400, ERR_INVALID_DURATION);
 			Serial.println(F("❌ Macro activation failed: duration is 0"));
 			return;
 		}
 	}
 
 	// Activate macro
-	if (_aqc->activateMacro(macroId, duration))
+	MacroActivation result = _aqc->activateMacro(macroId, duration);
+	if (result == MacroActivated)
 	{
 		// Build JSON response
 		char response[100];
-		sprintf(response, "{\"status\":\"ok\",\"expires_in\":%lu}", (unsigned long)duration);
-		_Server.send(200, "application/json", response);
+		sprintf_P(response, FMT_MACRO_ACTIVATED, (unsigned long)duration);
+		sendJson(200, response);
 
 		Serial.print(F("🎬 Macro activated: "));
 		Serial.print(macroId);
@@ -1489,24 +2244,52 @@ void handleApiMacroActivate()
 		Serial.print(duration);
 		Serial.println(F("s"));
 	}
+	else if (result == MacroConflict)
+	{
+		sendJson_P(409, ERR_MACRO_CONFLICT);
+	}
+	else if (result == MacroNoRoom)
+	{
+		sendJson_P(409, ERR_MACRO_NO_ROOM);
+	}
 	else
 	{
-		_Server.send(500, "application/json", "{\"error\":\"Activation failed\"}");
+		sendJson_P(500, ERR_ACTIVATION_FAILED);
 	}
 }
 
-// API: POST /api/macro/stop
+// API: POST /api/macro/stop - stops the macro of {"id":...}, all running macros without a body
 void handleApiMacroStop()
 {
-	if (_aqc->isMacroActive())
+	String body = _Server.arg("plain");
+	int idIdx = body.indexOf("\"id\":");
+	bool stopped = false;
+	if (idIdx != -1)
+	{
+		int idStart = idIdx + 5;
+		int idEnd = body.indexOf(',', idStart);
+		if (idEnd == -1)
+			idEnd = body.indexOf('}', idStart);
+		String macroId = body.substring(idStart, idEnd);
+		macroId.trim();
+		if (macroId.startsWith("\""))
+			macroId = macroId.substring(1, macroId.length() - 1);
+		stopped = _aqc->stopMacro(macroId.c_str());
+	}
+	else if (_aqc->isMacroActive())
 	{
 		_aqc->restoreSchedule();
-		_Server.send(200, "application/json", "{\"status\":\"ok\"}");
+		stopped = true;
+	}
+
+	if (stopped)
+	{
+		sendJson_P(200, RESP_OK);
 		Serial.println(F("🛑 Macro stopped manually"));
 	}
 	else
 	{
-		_Server.send(400, "application/json", "{\"error\":\"No macro active\"}");
+		sendJson_P(400, ERR_NO_MACRO_ACTIVE);
 	}
 }
 
@@ -1519,7 +2302,7 @@ void handleApiMacroDelete()
 	int idIdx = body.indexOf("\"id\":");
 	if (idIdx == -1)
 	{
-		_Server.send(400, "application/json", "{\"error\":\"Missing id\"}");
+		sendJson_P(400, ERR_MISSING_ID);
 		return;
 	}
 
@@ -1534,58 +2317,147 @@ void handleApiMacroDelete()
 
 	if (macroId.length() == 0)
 	{
-		_Server.send(400, "application/json", "{\"error\":\"Invalid id\"}");
+		sendJson_P(400, ERR_INVALID_ID);
 		return;
 	}
 
-	// Delete macro files for all channels
-	for (uint8_t ch = 0; ch < 6; ch++)
-	{
-		char sTempFilename[50];
-		String sMacroPath = "macros/";
-		sMacroPath += macroId;
-		sMacroPath += "_ch";
-		sMacroPath += (ch <= 9 ? (String("0") + String(ch)) : String(ch));
-		sMacroPath += ".cfg";
-		sMacroPath.toCharArray(sTempFilename, 50);
+	// A running macro plays from RAM and would outlive its file, it ends with it
+	_aqc->stopMacro(macroId.c_str());
 
-		if (SD.exists(sTempFilename))
-		{
-			if (SD.remove(sTempFilename))
-			{
-				Serial.print(F("Deleted macro file: "));
-				Serial.println(sMacroPath);
-			}
-		}
+	// Drop the index entry first, a file left behind by a reset is picked up by the next rebuild
+	uint16_t macroNum;
+	if (parseMacroNumber(macroId.c_str(), macroNum))
+	{
+		_MacroIndex.remove(macroNum);
+		_MacroCache.drop(macroNum);
 	}
 
-	// Delete metadata file
-	char metadataPath[50];
-	sprintf(metadataPath, "macros/%s.json", macroId.c_str());
-	if (SD.exists(metadataPath))
+	// Delete the macro file
+	char macroPath[ATOMIC_FILE_MAX_PATH];
+	macroFilePath(macroPath, sizeof(macroPath), macroId.c_str());
+	if (SD.remove(macroPath))
 	{
-		if (SD.remove(metadataPath))
-		{
-			Serial.print(F("Deleted metadata file: "));
-			Serial.println(metadataPath);
-		}
+		Serial.print(F("Deleted macro file: "));
+		Serial.println(macroPath);
 	}
 
 	Serial.print(F("🗑️  Macro deleted: "));
 	Serial.println(macroId);
 
-	_Server.send(200, "application/json", "{\"status\":\"ok\"}");
+	sendJson_P(200, RESP_OK);
+}
+
+// API: POST /api/macro/reindex - rebuilds the macro index from the files in macros/
+void handleApiMacroReindex()
+{
+	_MacroIndex.rebuild();
+	_MacroCache.warm();
+	char response[64];
+	sprintf_P(response, FMT_MACRO_REINDEXED, _MacroIndex.count(), _MacroIndex.Skipped);
+	sendJson(200, response);
+}
+
+// API: POST /api/macro/favorite - {"id":"macro_NNN","favorite":true|false}
+// Favorites stay parsed in RAM (macro cache) and switch without SD access
+void handleApiMacroFavorite()
+{
+	String body = _Server.arg("plain");
+	char macroId[16] = "";
+	int idIdx = body.indexOf("\"id\":\"");
+	if (idIdx != -1)
+	{
+		int idStart = idIdx + 6;
+		int idEnd = body.indexOf('"', idStart);
+		if (idEnd != -1)
+		{
+			body.substring(idStart, idEnd).toCharArray(macroId, sizeof(macroId));
+		}
+	}
+	uint16_t macroNum;
+	if (!parseMacroNumber(macroId, macroNum) || !_MacroIndex.find(macroNum))
+	{
+		sendJson_P(400, ERR_INVALID_ID);
+		return;
+	}
+	bool favorite = body.indexOf("\"favorite\":true") != -1;
+	if (!_MacroIndex.setFavorite(macroNum, favorite))
+	{
+		sendJson_P(500, ERR_MACRO_WRITE);
+		return;
+	}
+	if (favorite)
+	{
+		_MacroCache.warm();
+	}
+	sendJson_P(200, RESP_OK);
 }
 
 // API: POST /api/reboot
 void handleApiReboot()
 {
 	Serial.println(F("Reboot requested via API"));
-	_Server.send(200, "application/json", "{\"status\":\"rebooting\"}");
+	sendJson_P(200, RESP_REBOOTING);
+	_aqc->flushSchedules();
 	delay(500); // Give time for response to be sent
 	ESP.restart();
 }
 
+// Job step: sends the file size and target counts of one macro of the index per call (Position is the next entry)
+static bool stepDebugMacros(ResponseJob &job)
+{
+	if (job.Position < _MacroIndex.count())
+	{
+		if (job.writable() < 128)
+		{
+			return true;
+		}
+		const MacroIndexEntry &entry = _MacroIndex.entry(job.Position);
+		if (job.Position++ > 0)
+			job.print(",");
+		job.LastProgress = millis();
+
+		char macroId[20];
+		sprintf(macroId, "macro_%03u", entry.Number);
+
+		job.print("\"");
+		job.print(macroId);
+		job.print("\":{");
+
+		// File size and the targets per channel, as stored in the (checked) macro file
+		MacroReader reader;
+		if (reader.open(macroId))
+		{
+			const MacroFileTrailer &info = reader.info();
+			uint32_t fileSize = sizeof(MacroFileTrailer);
+			for (uint8_t ch = 0; ch < MACRO_FILE_CHANNELS; ch++)
+			{
+				fileSize += info.Counts[ch] * sizeof(uint32_t);
+			}
+			char buf[24];
+			sprintf(buf, "\"bytes\":%lu", (unsigned long)fileSize);
+			job.print(buf);
+			for (uint8_t ch = 0; ch < MACRO_FILE_CHANNELS; ch++)
+			{
+				if (info.ChannelMask & (1 << ch))
+				{
+					sprintf(buf, ",\"ch%02d\":%u", ch, (unsigned int)info.Counts[ch]);
+					job.print(buf);
+				}
+			}
+			reader.close();
+		}
+		else
+		{
+			job.print("\"valid\":false");
+		}
+
+		job.print("}");
+		return true; // One macro file per slice
+	}
+	job.print("}}"); // Close macros object AND main JSON object
+	return false;
+}
+
 // API: GET /api/debug - Returns heap/memory diagnostics
 void handleApiDebug()
 {
@@ -1596,87 +2468,158 @@ void handleApiDebug()
 		fragmentation = 100.0 * (1.0 - (float)maxFreeBlock / (float)freeHeap);
 
 	// Stream JSON using char buffers - NO String objects
-	_Server.setContentLength(CONTENT_LENGTH_UNKNOWN);
-	_Server.send(200, "application/json", "");
+	// The head and the fixed part are written directly, the macro scan continues as a job
+	WiFiClient &client = _Server.client();
+	writeResponseHead(client, 200, "application/json", -1);
 
 	char buf[16];
 
-	_Server.sendContent("{\"free_heap\":");
+	client.print(FPSTR(KEY_FREE_HEAP));
 	sprintf(buf, "%lu", (unsigned long)freeHeap);
-	_Server.sendContent(buf);
+	client.print(buf);
 
-	_Server.sendContent(",\"max_free_block\":");
+	client.print(FPSTR(KEY_MAX_FREE_BLOCK));
 	sprintf(buf, "%lu", (unsigned long)maxFreeBlock);
-	_Server.sendContent(buf);
+	client.print(buf);
 
-	_Server.sendContent(",\"heap_fragmentation\":");
+	client.print(FPSTR(KEY_HEAP_FRAGMENTATION));
 	dtostrf(fragmentation, 1, 1, buf);
-	_Server.sendContent(buf);
+	client.print(buf);
 
-	_Server.sendContent(",\"uptime_ms\":");
+	client.print(FPSTR(KEY_UPTIME_MS));
 	sprintf(buf, "%lu", millis());
-	_Server.sendContent(buf);
+	client.print(buf);
 
-	_Server.sendContent(",\"vcc_voltage_mv\":");
+	client.print(FPSTR(KEY_VCC));
 	sprintf(buf, "%u", ESP.getVcc());
-	_Server.sendContent(buf);
+	client.print(buf);
 
-	_Server.sendContent(",\"cpu_freq_mhz\":");
+	client.print(FPSTR(KEY_CPU_FREQ));
 	sprintf(buf, "%u", ESP.getCpuFreqMHz());
-	_Server.sendContent(buf);
+	client.print(buf);
+
+	// Request arena usage (high water mark tells whether REQUEST_ARENA_SIZE fits the handlers)
+	client.print(FPSTR(KEY_ARENA_CAPACITY));
+	sprintf(buf, "%u", (unsigned int)_Arena.capacity());
+	client.print(buf);
+	client.print(FPSTR(KEY_HIGH_WATER));
+	sprintf(buf, "%u", (unsigned int)_Arena.highWater());
+	client.print(buf);
+	client.print(FPSTR(KEY_FAILURES));
+	sprintf(buf, "%lu", (unsigned long)_Arena.failures());
+	client.print(buf);
+	client.print("}");
+
+#if defined(USE_FLASH_ASSET_CACHE)
+	// Flash mirror of the web assets
+	{
+		char line[80];
+		sprintf_P(line, FMT_ASSET_CACHE, _AssetCache.Mounted ? "true" : "false", (unsigned long)_AssetCache.Hits,
+				  (unsigned long)_AssetCache.Misses);
+		client.print(line);
+	}
+#endif
 
-	// Add macro file diagnostics
-	_Server.sendContent(",\"macros\":{");
+	// Connection reuse
+	{
+		char line[80];
+		sprintf_P(line, FMT_HTTP_STATS,
+#if defined(USE_HTTP_KEEPALIVE)
+				  "true",
+#else
+				  "false",
+#endif
+				  (unsigned long)_HttpRequests, (unsigned long)_HttpReusedRequests);
+		client.print(line);
+	}
 
-	bool firstMacro = true;
-	for (uint16_t macroNum = 1; macroNum <= 999; macroNum++)
+#if defined(USE_SERVER_SENT_EVENTS)
+	{
+		char line[80];
+		sprintf_P(line, FMT_EVENT_STREAM, _Events.subscribers(), (unsigned long)_Events.Sent, (unsigned long)_Events.Dropped);
+		client.print(line);
+	}
+#endif
+	// Macro index
 	{
-		char sTempFilename[50];
-		sprintf(sTempFilename, "macros/macro_%03d_ch00.cfg", macroNum);
+		char line[128];
+		sprintf_P(line, FMT_MACRO_INDEX, _MacroIndex.count(), (unsigned long)_MacroIndex.Generation(),
+				  (unsigned long)_MacroIndex.Rebuilds, (unsigned long)_MacroIndex.Writes, _MacroIndex.Skipped);
+		client.print(line);
+	}
 
-		if (SD.exists(sTempFilename))
-		{
-			if (!firstMacro)
-				_Server.sendContent(",");
-			firstMacro = false;
+	// Macro cache
+	{
+		char line[128];
+		sprintf_P(line, FMT_MACRO_CACHE, (unsigned int)MACRO_CACHE_SLOTS, _MacroCache.used(), _MacroCache.pinned(),
+				  (unsigned long)_MacroCache.Hits, (unsigned long)_MacroCache.Misses);
+		client.print(line);
+	}
 
-			// Found a macro - check all 6 channels
-			char macroId[20];
-			sprintf(macroId, "macro_%03d", macroNum);
+	// Schedule journal
+	{
+		char line[224];
+		sprintf_P(line, FMT_SCHEDULE_STORE, _ScheduleStore.pending() ? "true" : "false",
+				  _ScheduleStore.Damaged ? "true" : "false", (unsigned long)_ScheduleStore.JournalBytes(),
+				  (unsigned long)_ScheduleStore.Appends, (unsigned long)_ScheduleStore.Replayed,
+				  (unsigned long)_ScheduleStore.Compactions, (unsigned long)_ScheduleStore.Writes,
+				  (unsigned long)_ScheduleStore.Skipped);
+		client.print(line);
+	}
 
-			_Server.sendContent("\"");
-			_Server.sendContent(macroId);
-			_Server.sendContent("\":{");
+#if defined(USE_TEST_CONTROL)
+	{
+		char line[112];
+		sprintf_P(line, FMT_TEST_CONTROL, _TestControl.connected() ? "true" : "false", (unsigned long)_TestControl.Frames,
+				  (unsigned long)_TestControl.Applied, (unsigned long)_TestControl.Stale);
+		client.print(line);
+	}
+#endif
 
-			bool firstChannel = true;
-			uint32_t totalSize = 0;
-			for (uint8_t ch = 0; ch < 6; ch++)
-			{
-				sprintf(sTempFilename, "macros/%s_ch%02d.cfg", macroId, ch);
-				if (SD.exists(sTempFilename))
-				{
-					File f = SD.open(sTempFilename);
-					if (f)
-					{
-						uint32_t fileSize = f.size();
-						totalSize += fileSize;
-						f.close();
-
-						if (!firstChannel)
-							_Server.sendContent(",");
-						firstChannel = false;
-
-						sprintf(buf, "\"ch%02d\":%lu", ch, (unsigned long)fileSize);
-						_Server.sendContent(buf);
-					}
-				}
-			}
+	// Response jobs and the worst time a loop cycle spent on web work
+	{
+		char line[160];
+		sprintf_P(line, FMT_RESPONSE_JOBS, _Jobs.active(), (unsigned long)_Jobs.Started, (unsigned long)_Jobs.Completed,
+				  (unsigned long)_Jobs.Aborted, (unsigned long)_Jobs.Inline, (unsigned long)_Jobs.MaxStepMicros,
+				  (unsigned long)_Jobs.MaxServiceMicros);
+		client.print(line);
+	}
 
-			_Server.sendContent("}");
+	// Lowest free stack of the loop (cont) since boot
+	client.print(FPSTR(KEY_LOOP_STACK_FREE));
+	sprintf(buf, "%lu", (unsigned long)ESP.getFreeContStack());
+	client.print(buf);
+
+#if defined(USE_HEAP_TRACKER)
+	// Allocation attribution per subsystem scope and web route
+	{
+		char line[128];
+		sprintf_P(line, FMT_HEAP_TRACKER, (unsigned long)_HeapTracker.liveBytes(), (unsigned long)_HeapTracker.peakBytes(),
+				  (unsigned long)_HeapTracker.AllocCount, (unsigned long)_HeapTracker.FreeCount, (unsigned long)_HeapTracker.LargestBlock);
+		client.print(line);
+		for (uint8_t i = 0; i < _HeapTracker.ScopeCount; i++)
+		{
+			const HeapScopeStats &scope = _HeapTracker.Scopes[i];
+			if (i > 0)
+				client.print(",");
+			client.print(FPSTR(KEY_SCOPE_NAME));
+			if (i >= HeapScopeFirstRoute && scope.Method == HTTP_GET)
+				client.print("GET ");
+			else if (i >= HeapScopeFirstRoute && scope.Method == HTTP_POST)
+				client.print("POST ");
+			client.print(FPSTR(scope.Name));
+			sprintf_P(line, FMT_HEAP_SCOPE, (unsigned long)scope.AllocCount, (unsigned long)scope.FreeCount,
+					  (unsigned long)scope.AllocBytes, (unsigned long)scope.LargestBlock, (long)scope.Retained,
+					  (unsigned long)scope.Peak);
+			client.print(line);
 		}
+		client.print("]}");
 	}
+#endif
 
-	_Server.sendContent("}}"); // Close macros object AND main JSON object
+	// Add macro file diagnostics
+	client.print(FPSTR(KEY_DEBUG_MACROS));
+	_Jobs.start(stepDebugMacros, ResponseJobInteractive);
 
 	// Also log to serial
 	Serial.print(F("DEBUG: Free="));
@@ -1690,8 +2633,20 @@ void handleApiDebug()
 
 // File upload handler - receives file chunks
 // Note: Global variables are safe here because ESP8266WebServer is single-threaded
-static File _uploadFile;		// Persists across upload chunks
-static String _uploadPath = ""; // Stores target path from form data
+static File _uploadFile;	   // Persists across upload chunks
+static char _uploadPath[64] = ""; // Stores target path from form data (fixed buffer, no heap)
+
+// Helper: Copy the "path" form argument without leading slash into dest
+static void copyUploadPathArg(char *dest, size_t size)
+{
+	const char *path = _Server.arg("path").c_str();
+	if (*path == '/')
+	{
+		path++;
+	}
+	strncpy(dest, path, size - 1);
+	dest[size - 1] = '\0';
+}
 
 void handleUpload()
 {
@@ -1700,37 +2655,53 @@ void handleUpload()
 	if (upload.status == UPLOAD_FILE_START)
 	{
 		// Get the target path from form data
-		_uploadPath = _Server.arg("path");
+		copyUploadPathArg(_uploadPath, sizeof(_uploadPath));
 
-		if (_uploadPath.length() == 0)
+		if (_uploadPath[0] == '\0')
 		{
 			Serial.println(F("Upload error: No path specified"));
 			return;
 		}
 
-		// Remove leading slash if present
-		if (_uploadPath.startsWith("/"))
-		{
-			_uploadPath = _uploadPath.substring(1);
-		}
-
 		Serial.print(F("📤 Upload started: "));
 		Serial.println(_uploadPath);
 
 		// Delete existing file if present
-		if (SD.exists(_uploadPath.c_str()))
+		if (SD.exists(_uploadPath))
 		{
-			SD.remove(_uploadPath.c_str());
+			SD.remove(_uploadPath);
 			Serial.print(F("  Removed existing file: "));
 			Serial.println(_uploadPath);
 		}
 
+		// A precompressed sibling of a replaced file would shadow the new content
+		if (!endsWith(_uploadPath, ".gz"))
+		{
+			char *gzPath = _Arena.format("%s.gz", _uploadPath);
+			if (gzPath && SD.exists(gzPath))
+			{
+				SD.remove(gzPath);
+				Serial.print(F("  Removed stale gzip variant: "));
+				Serial.println(gzPath);
+			}
+#if defined(USE_FLASH_ASSET_CACHE)
+			if (gzPath)
+			{
+				_AssetCache.remove(gzPath);
+			}
+#endif
+		}
+#if defined(USE_FLASH_ASSET_CACHE)
+		// Never serve the old flash copy while the new file is being written
+		_AssetCache.remove(_uploadPath);
+#endif
+
 		// Note: SD library doesn't support mkdir, so directories must exist
 		// Users should manually create directory structure on SD card before upload
 		// or use the web interface to create necessary folders
 
 		// Open file for writing
-		_uploadFile = SD.open(_uploadPath.c_str(), FILE_WRITE);
+		_uploadFile = SD.open(_uploadPath, FILE_WRITE);
 		if (!_uploadFile)
 		{
 			Serial.print(F("❌ Failed to open file for writing: "));
@@ -1773,6 +2744,28 @@ void handleUpload()
 			Serial.print(F(" ("));
 			Serial.print(upload.totalSize);
 			Serial.println(F(" bytes)"));
+			if (strcmp(_uploadPath, _AppTemplate.Path) == 0)
+			{
+				_AppTemplate.invalidate();
+			}
+			if (strncmp(_uploadPath[0] == '/' ? _uploadPath + 1 : _uploadPath, "macros/", 7) == 0)
+			{
+				_MacroIndex.invalidate();
+			}
+			// A text schedule (config/ledch_NN.cfg) is imported into the schedule store right away
+			unsigned int importChannel;
+			char importName[8];
+			if (sscanf(_uploadPath[0] == '/' ? _uploadPath + 1 : _uploadPath, "config/ledch_%2u.%3s", &importChannel, importName) == 2 &&
+				strcmp(importName, "cfg") == 0 && importChannel < SCHEDULE_STORE_CHANNELS && _aqc->importLedConfig(importChannel))
+			{
+				_aqc->scheduleChanged();
+				_aqc->_IsFirstCycle = true;
+				Serial.print(F("  Imported schedule of channel "));
+				Serial.println(importChannel);
+			}
+#if defined(USE_FLASH_ASSET_CACHE)
+			_AssetCache.mirror(_uploadPath);
+#endif
 		}
 		else
 		{
@@ -1786,7 +2779,7 @@ void handleUpload()
 			_uploadFile.close();
 		}
 		Serial.println(F("❌ Upload aborted"));
-		_uploadPath = "";
+		_uploadPath[0] = '\0';
 	}
 }
 
@@ -1794,41 +2787,36 @@ void handleUpload()
 void handleUploadComplete()
 {
 	// Use the path stored during upload process (more reliable than re-reading form data)
-	String targetPath = _uploadPath;
+	const char *targetPath = _uploadPath;
 
-	if (targetPath.length() == 0)
+	if (targetPath[0] == '\0')
 	{
 		// Fallback to form data if upload path wasn't set
-		targetPath = _Server.arg("path");
-		if (targetPath.startsWith("/"))
-		{
-			targetPath = targetPath.substring(1);
-		}
+		copyUploadPathArg(_uploadPath, sizeof(_uploadPath));
 	}
 
-	if (targetPath.length() == 0)
+	if (targetPath[0] == '\0')
 	{
-		_Server.send(400, "application/json", "{\"success\":false,\"error\":\"No path specified\"}");
+		sendJson_P(400, ERR_UPLOAD_NO_PATH);
 		Serial.println(F("❌ Upload failed: No path specified"));
 		return;
 	}
 
 	// Verify file was created successfully
-	if (SD.exists(targetPath.c_str()))
+	if (SD.exists(targetPath))
 	{
-		File f = SD.open(targetPath.c_str(), FILE_READ);
+		File f = SD.open(targetPath, FILE_READ);
 		if (f)
 		{
 			size_t fileSize = f.size();
 			f.close();
 
 			// Send success response with minimal String usage
-			_Server.setContentLength(CONTENT_LENGTH_UNKNOWN);
-			_Server.send(200, "application/json", "");
+			beginJsonStream();
 
-			_Server.sendContent("{\"success\":true,\"path\":\"");
+			_Server.sendContent_P(KEY_UPLOAD_PATH);
 			_Server.sendContent(targetPath);
-			_Server.sendContent("\",\"size\":");
+			_Server.sendContent_P(KEY_SIZE);
 
 			char buf[16];
 			snprintf(buf, sizeof(buf), "%u", (unsigned int)fileSize);
@@ -1843,19 +2831,19 @@ void handleUploadComplete()
 		}
 		else
 		{
-			_Server.send(500, "application/json", "{\"success\":false,\"error\":\"File created but cannot be read\"}");
+			sendJson_P(500, ERR_UPLOAD_UNREADABLE);
 			Serial.println(F("❌ File created but cannot be read"));
 		}
 	}
 	else
 	{
-		_Server.send(500, "application/json", "{\"success\":false,\"error\":\"File upload failed\"}");
+		sendJson_P(500, ERR_UPLOAD_FAILED);
 		Serial.print(F("❌ Upload failed: File not found after upload: "));
 		Serial.println(targetPath);
 	}
 
 	// Reset upload state
-	_uploadPath = "";
+	_uploadPath[0] = '\0';
 }
 
 // API: POST /api/time/set
@@ -1886,14 +2874,14 @@ void handleApiTimeSet()
 
 	if (hour == -1 || minute == -1 || second == -1)
 	{
-		_Server.send(400, "application/json", "{\"error\":\"Missing or invalid time field (hour/minute/second)\"}");
+		sendJson_P(400, ERR_MISSING_TIME_FIELD);
 		return;
 	}
 
 	// Validate ranges
 	if (hour < 0 || hour > 23 || minute < 0 || minute > 59 || second < 0 || second > 59)
 	{
-		_Server.send(400, "application/json", "{\"error\":\"Invalid time values (hour: 0-23, minute: 0-59, second: 0-59)\"}");
+		sendJson_P(400, ERR_INVALID_TIME_VALUES);
 		return;
 	}
 
@@ -1916,21 +2904,21 @@ void handleApiTimeSet()
 	{
 		Serial.print(F("ERROR: RTC sync failed, timeStatus="));
 		Serial.println(timeStatus());
-		_Server.send(500, "application/json", "{\"error\":\"RTC sync failed - time not set\"}");
+		sendJson_P(500, ERR_RTC_SYNC_FAILED);
 		return;
 	}
 
 	// Update time sync tracking
 	_aqc->_LastTimeSync = now();
 	_aqc->_LastTimeSyncSource = TimeSyncSource::Api;
+	_aqc->notifyChange(ChangeTimeSync);
 	_aqc->_NtpSyncFailed = false; // Clear the flag since browser provided time
 
 	// Stream JSON response with updated time
-	_Server.setContentLength(CONTENT_LENGTH_UNKNOWN);
-	_Server.send(200, "application/json", "");
+	beginJsonStream();
 
 	char buf[16];
-	_Server.sendContent("{\"status\":\"ok\",\"time\":\"");
+	_Server.sendContent_P(KEY_TIME_SET);
 	sprintf(buf, "%02d:%02d:%02d", hour, minute, second);
 	_Server.sendContent(buf);
 	_Server.sendContent("\"}");
@@ -1943,7 +2931,7 @@ void handleApiTimeSet()
 	Serial.println(second);
 	Serial.println(F("Time sync source: API"));
 #else
-	_Server.send(501, "application/json", "{\"error\":\"RTC not available\"}");
+	sendJson_P(501, ERR_RTC_NOT_AVAILABLE);
 #endif
 }
 
@@ -1953,36 +2941,27 @@ void handleApiChannelConfigGet()
 	Serial.println(F("Channel config GET"));
 
 	// Try to read config from SD card
-	File configFile = SD.open(F("config/channels.cfg"), FILE_READ);
+	File configFile = openChannelConfig();
 
 	if (!configFile)
 	{
 		// File doesn't exist, return defaults
 		Serial.println(F("channels.cfg not found, returning defaults"));
-		_Server.send(200, "application/json",
-					 "{\"channels\":["
-					 "{\"name\":\"Blau\",\"color\":\"#2196F3\"},"
-					 "{\"name\":\"Weiß\",\"color\":\"#E0E0E0\"},"
-					 "{\"name\":\"Rot\",\"color\":\"#F44336\"},"
-					 "{\"name\":\"Grün\",\"color\":\"#4CAF50\"},"
-					 "{\"name\":\"UV\",\"color\":\"#9C27B0\"},"
-					 "{\"name\":\"Mondlicht\",\"color\":\"#FFD700\"}"
-					 "]}");
+		sendJson_P(200, RESP_DEFAULT_CHANNELS);
 		return;
 	}
 
-	// Read config file and stream to client
-	_Server.setContentLength(CONTENT_LENGTH_UNKNOWN);
-	_Server.send(200, "application/json", "");
-
-	while (configFile.available())
+	// The file is the JSON the UI saved, it goes out as it is in slices of the job buffer like the
+	// config section of /api/bootstrap. Nothing is split into lines, so no line length applies.
+	uint32_t size = configFile.size();
+	WiFiClient &client = _Server.client();
+	writeResponseHead(client, 200, "application/json", (long)size, "Cache-Control: no-cache\r\n");
+	if (size == 0)
 	{
-		String line = configFile.readStringUntil('\n');
-		_Server.sendContent(line);
+		configFile.close();
+		return;
 	}
-
-	configFile.close();
-	Serial.println(F("Channel config sent"));
+	_Jobs.start(stepFileBody, ResponseJobInteractive, configFile, size);
 }
 
 // API: POST /api/config/channels - Saves channel names and colors
@@ -1997,59 +2976,26 @@ void handleApiChannelConfigSave()
 	// Validate JSON structure (basic check)
 	if (body.indexOf("\"channels\"") == -1)
 	{
-		_Server.send(400, "application/json", "{\"error\":\"Invalid JSON: missing 'channels' field\"}");
+		sendJson_P(400, ERR_INVALID_CHANNELS_JSON);
 		return;
 	}
 
-	// Write to temporary file first
-	if (SD.exists(F("config/channels_new.cfg")))
-	{
-		SD.remove(F("config/channels_new.cfg"));
-	}
-
-	File newFile = SD.open(F("config/channels_new.cfg"), FILE_WRITE);
-	if (!newFile)
+	// Written to a temp file and swapped in once it is verified
+	AtomicFileWriter newFile;
+	if (!newFile.begin("config/channels.cfg"))
 	{
-		Serial.println(F("ERROR: Failed to open config/channels_new.cfg for writing"));
-		_Server.send(500, "application/json", "{\"error\":\"Failed to open temp file\"}");
+		sendJson_P(500, ERR_TEMP_FILE);
 		return;
 	}
-
 	newFile.print(body);
-	newFile.close();
-
-	// Atomic replace: delete old, rename new
-	if (SD.exists(F("config/channels.cfg")))
+	if (!newFile.commit())
 	{
-		SD.remove(F("config/channels.cfg"));
-	}
-
-	// Rename is not supported on SD library, so we need to copy and delete
-	File source = SD.open(F("config/channels_new.cfg"), FILE_READ);
-	File dest = SD.open(F("config/channels.cfg"), FILE_WRITE);
-
-	if (!source || !dest)
-	{
-		Serial.println(F("ERROR: Failed to copy temp file to final location"));
-		if (source)
-			source.close();
-		if (dest)
-			dest.close();
-		_Server.send(500, "application/json", "{\"error\":\"Failed to finalize config file\"}");
+		sendJson_P(500, ERR_FINALIZE_CONFIG);
 		return;
 	}
 
-	while (source.available())
-	{
-		dest.write(source.read());
-	}
-
-	source.close();
-	dest.close();
-	SD.remove(F("config/channels_new.cfg"));
-
 	Serial.println(F("✅ Channel config saved"));
-	_Server.send(200, "application/json", "{\"status\":\"ok\"}");
+	sendJson_P(200, RESP_OK);
 }
 
 #endif
\ No newline at end of file
@@ -3,13 +3,20 @@
 Sync local SD card files to ESP8266 via HTTP upload endpoint
 Usage: python sync_sd_card.py <esp_ip> [--exclude pattern1,pattern2,...]
 Example: python sync_sd_card.py 192.168.103.8
+
+JavaScript and CSS files are additionally uploaded as precompressed ".gz"
+siblings, which the firmware serves to browsers that accept gzip.
 """
 
+import gzip
 import os
 import sys
 import requests
 from pathlib import Path
 
+# File types that get a precompressed ".gz" sibling on the SD card
+GZIP_SUFFIXES = (".js", ".css")
+
 
 def sync_sd_card(esp_ip, exclude_patterns=None):
     """Sync all files from extras/SDCard/ to ESP8266"""
@@ -44,33 +51,38 @@ def sync_sd_card(esp_ip, exclude_patterns=None):
         print("No files to upload")
         return
 
-    print(f"Found {len(files_to_upload)} files to upload to {esp_ip}")
+    # Precompressed variants (uploaded after the plain file, which removes stale ones)
+    uploads = []
+    for local_path, remote_path in sorted(files_to_upload):
+        data = local_path.read_bytes()
+        uploads.append((remote_path, data))
+        if local_path.suffix.lower() in GZIP_SUFFIXES:
+            uploads.append((remote_path + ".gz", gzip.compress(data, 9, mtime=0)))
+
+    print(f"Found {len(files_to_upload)} files ({len(uploads)} uploads) for {esp_ip}")
     print("-" * 60)
 
     successful = 0
     failed = 0
 
-    for local_path, remote_path in sorted(files_to_upload):
+    for remote_path, content in uploads:
         try:
-            with open(local_path, "rb") as f:
-                files = {"file": f}
-                data = {"path": remote_path}
-
-                response = requests.post(base_url, files=files, data=data, timeout=10)
-
-                if response.status_code == 200:
-                    result = response.json()
-                    if result.get("success"):
-                        print(f"✓ {remote_path}")
-                        successful += 1
-                    else:
-                        print(
-                            f"✗ {remote_path}: {result.get('error', 'Unknown error')}"
-                        )
-                        failed += 1
+            files = {"file": (os.path.basename(remote_path), content)}
+            data = {"path": remote_path}
+
+            response = requests.post(base_url, files=files, data=data, timeout=10)
+
+            if response.status_code == 200:
+                result = response.json()
+                if result.get("success"):
+                    print(f"✓ {remote_path}")
+                    successful += 1
                 else:
-                    print(f"✗ {remote_path}: HTTP {response.status_code}")
+                    print(f"✗ {remote_path}: {result.get('error', 'Unknown error')}")
                     failed += 1
+            else:
+                print(f"✗ {remote_path}: HTTP {response.status_code}")
+                failed += 1
 
         except Exception as e:
             print(f"✗ {remote_path}: {str(e)}")
@@ -0,0 +1,102 @@
+/*
+Aqua Control Library
+
+Creationdate: 2026-10-18
+Host test: recoverAtomicFile() only promotes a temp file that was verified.
+
+Build and run from the repository root:
+  g++ -std=gnu++17 -DESP8266 -Itest/firmware/stubs -Itest/firmware -Isrc test/firmware/AtomicFileRecoveryTest.cpp \
+      test/firmware/FakeArduino.cpp src/AtomicFile.cpp src/ScheduleStore.cpp src/ConfigReader.cpp \
+      -o atomic_file_recovery_test && ./atomic_file_recovery_test
+
+Further information on www.schullebernd.de
+*/
+
+#include "AquaControl.h"
+#include "FakeArduino.h"
+
+// Defined in AquaControl.cpp, not reached by this test (schedule journal replay)
+uint8_t ScheduleSnapshot::add(Target) { abort(); }
+uint8_t PwmChannel::setTarget(Target) { abort(); }
+bool PwmChannel::removeTargetAtTime(time_t) { abort(); }
+
+static int _Failures = 0;
+
+#define CHECK(condition)                                             \
+	if (!(condition))                                                \
+	{                                                                \
+		printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); \
+		_Failures++;                                                 \
+	}
+
+static void put(const char *path, const char *text)
+{
+	fakePut(path, (const uint8_t *)text, strlen(text));
+}
+
+static std::string content(const char *path)
+{
+	std::vector<uint8_t> &bytes = FakeFiles[path];
+	return std::string(bytes.begin(), bytes.end());
+}
+
+static void testCommitReplacesFile()
+{
+	FakeFiles.clear();
+	put("config/channels.cfg", "old");
+	AtomicFileWriter writer;
+	CHECK(writer.begin("config/channels.cfg"));
+	writer.write((const uint8_t *)"new", 3);
+	CHECK(writer.commit());
+	CHECK(content("config/channels.cfg") == "new");
+	CHECK(FakeFiles.size() == 1);
+}
+
+// A reset while the first version of a file was written leaves only a truncated temp file
+static void testFirstWriteCutShortIsDropped()
+{
+	FakeFiles.clear();
+	put("config/channels.cfg.tmp", "{\"chan");
+	recoverAtomicFile("config/channels.cfg");
+	CHECK(FakeFiles.empty());
+}
+
+static void testUpdateCutShortKeepsOldFile()
+{
+	FakeFiles.clear();
+	put("config/channels.cfg", "old");
+	put("config/channels.cfg.tmp", "ne");
+	recoverAtomicFile("config/channels.cfg");
+	CHECK(content("config/channels.cfg") == "old");
+	CHECK(FakeFiles.size() == 1);
+}
+
+// A reset during the swap leaves the verified file under the .new name, with or without the old one
+static void testVerifiedFileIsPromoted()
+{
+	FakeFiles.clear();
+	put("config/channels.cfg.new", "new");
+	recoverAtomicFile("config/channels.cfg");
+	CHECK(content("config/channels.cfg") == "new");
+	CHECK(FakeFiles.size() == 1);
+
+	FakeFiles.clear();
+	put("config/channels.cfg", "old");
+	put("config/channels.cfg.new", "new");
+	recoverAtomicFile("config/channels.cfg");
+	CHECK(content("config/channels.cfg") == "new");
+	CHECK(FakeFiles.size() == 1);
+}
+
+int main()
+{
+	testCommitReplacesFile();
+	testFirstWriteCutShortIsDropped();
+	testUpdateCutShortKeepsOldFile();
+	testVerifiedFileIsPromoted();
+	if (_Failures == 0)
+	{
+		printf("OK\n");
+	}
+	return _Failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,175 @@
+/*
+Host fakes for the firmware tests: an in-memory SD card and a silent Serial.
+Only what the tested modules use is implemented.
+*/
+
+#include <Arduino.h>
+#include <SD.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "FakeArduino.h"
+
+std::map<std::string, std::vector<uint8_t>> FakeFiles;
+
+struct FakeHandle
+{
+	std::string Path;
+	size_t Position;
+	bool Directory;
+	size_t Listed; // Directory entries returned by openNextFile
+};
+static std::vector<FakeHandle> _Handles;
+
+SDClass SD;
+HardwareSerial Serial;
+
+unsigned long millis() { return 0; }
+
+static File openHandle(const std::string &path, bool directory)
+{
+	File f;
+	_Handles.push_back({path, 0, directory, 0});
+	f.Handle = _Handles.size() - 1;
+	return f;
+}
+
+static bool isDirectory(const std::string &path)
+{
+	std::string prefix = path + "/";
+	for (auto &file : FakeFiles)
+	{
+		if (file.first.compare(0, prefix.size(), prefix) == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void fakePut(const char *path, const uint8_t *data, size_t size)
+{
+	FakeFiles[path] = std::vector<uint8_t>(data, data + size);
+}
+
+namespace fs
+{
+File::File() {}
+size_t File::write(uint8_t b) { return write(&b, 1); }
+size_t File::write(const uint8_t *data, size_t size)
+{
+	auto &content = FakeFiles[_Handles[Handle].Path];
+	content.insert(content.end(), data, data + size);
+	return size;
+}
+int File::available() { return Handle >= 0 ? (int)(size() - position()) : 0; }
+int File::read()
+{
+	uint8_t b;
+	return read(&b, 1) == 1 ? b : -1;
+}
+int File::read(uint8_t *data, size_t size)
+{
+	FakeHandle &h = _Handles[Handle];
+	auto &content = FakeFiles[h.Path];
+	size_t n = std::min(size, content.size() - h.Position);
+	memcpy(data, content.data() + h.Position, n);
+	h.Position += n;
+	return n;
+}
+bool File::seek(uint32_t pos, SeekMode)
+{
+	if (pos > size())
+	{
+		return false;
+	}
+	_Handles[Handle].Position = pos;
+	return true;
+}
+int File::peek() { return -1; }
+void File::flush() {}
+size_t File::position() const { return _Handles[Handle].Position; }
+size_t File::size() const { return FakeFiles[_Handles[Handle].Path].size(); }
+void File::close() { Handle = -1; }
+File::operator bool() const { return Handle >= 0; }
+const char *File::name() const
+{
+	const std::string &path = _Handles[Handle].Path;
+	size_t slash = path.rfind('/');
+	return path.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+}
+bool File::isDirectory() { return _Handles[Handle].Directory; }
+File File::openNextFile()
+{
+	FakeHandle &dir = _Handles[Handle];
+	std::string prefix = dir.Path + "/";
+	size_t i = 0;
+	for (auto &file : FakeFiles)
+	{
+		if (file.first.compare(0, prefix.size(), prefix) != 0 || file.first.find('/', prefix.size()) != std::string::npos)
+		{
+			continue;
+		}
+		if (i++ == dir.Listed)
+		{
+			_Handles[Handle].Listed++;
+			return openHandle(file.first, false);
+		}
+	}
+	return File();
+}
+} // namespace fs
+
+File SDClass::open(const char *path, uint8_t mode)
+{
+	if (isDirectory(path))
+	{
+		return openHandle(path, true);
+	}
+	if (mode == FILE_READ && !FakeFiles.count(path))
+	{
+		return File();
+	}
+	File f = openHandle(path, false);
+	if (mode == FILE_WRITE)
+	{
+		FakeFiles[path];
+		f.seek(f.size());
+	}
+	return f;
+}
+bool SDClass::exists(const char *path) { return FakeFiles.count(path) > 0; }
+bool SDClass::remove(const char *path) { return FakeFiles.erase(path) > 0; }
+bool SDClass::rename(const char *from, const char *to)
+{
+	if (!FakeFiles.count(from) || FakeFiles.count(to))
+	{
+		return false;
+	}
+	FakeFiles[to] = FakeFiles[from];
+	FakeFiles.erase(from);
+	return true;
+}
+
+// Serial output is not checked by the tests
+size_t Print::write(const uint8_t *data, size_t size)
+{
+	size_t n = 0;
+	while (size--)
+	{
+		n += write(*data++);
+	}
+	return n;
+}
+size_t Stream::write(uint8_t) { return 1; }
+int HardwareSerial::available() { return 0; }
+int HardwareSerial::read() { return -1; }
+int HardwareSerial::peek() { return -1; }
+size_t Print::print(const char *) { return 0; }
+size_t Print::print(const __FlashStringHelper *) { return 0; }
+size_t Print::print(int, int) { return 0; }
+size_t Print::print(unsigned int, int) { return 0; }
+size_t Print::println(const char *) { return 0; }
+size_t Print::println(const __FlashStringHelper *) { return 0; }
+size_t Print::println(int, int) { return 0; }
+size_t Print::println(unsigned int, int) { return 0; }
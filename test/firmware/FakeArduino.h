@@ -0,0 +1,18 @@
+/*
+Host fakes for the firmware tests, see FakeArduino.cpp.
+*/
+
+#ifndef __FAKEARDUINO_H_
+#define __FAKEARDUINO_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+// Content of the fake SD card by path
+extern std::map<std::string, std::vector<uint8_t>> FakeFiles;
+
+// Places a file on the fake SD card like an upload does
+void fakePut(const char *path, const uint8_t *data, size_t size);
+
+#endif
@@ -0,0 +1,85 @@
+/*
+Aqua Control Library
+
+Creationdate: 2026-10-18
+Host test: a running macro that was edited can be restarted while every cache slot is pinned.
+
+Build and run from the repository root:
+  g++ -std=gnu++17 -DESP8266 -Itest/firmware/stubs -Itest/firmware -Isrc test/firmware/MacroCacheRestartTest.cpp \
+      test/firmware/FakeArduino.cpp src/MacroCache.cpp src/MacroIndex.cpp src/MacroFile.cpp src/AtomicFile.cpp \
+      src/ConfigReader.cpp src/ScheduleStore.cpp -o macro_cache_restart_test && ./macro_cache_restart_test
+
+Further information on www.schullebernd.de
+*/
+
+#include "AquaControl.h"
+#include "FakeArduino.h"
+
+// Defined in AquaControl.cpp, not reached by this test (legacy macros and schedule journal replay)
+uint8_t ScheduleSnapshot::add(Target) { abort(); }
+uint8_t PwmChannel::setTarget(Target) { abort(); }
+bool PwmChannel::removeTargetAtTime(time_t) { abort(); }
+
+static int _Failures = 0;
+
+#define CHECK(condition)                                             \
+	if (!(condition))                                                \
+	{                                                                \
+		printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); \
+		_Failures++;                                                 \
+	}
+
+// Saves a macro with one target on channel 0 the way the macro editor does
+static void saveMacro(uint16_t number, const char *name, uint8_t value)
+{
+	char macroId[16];
+	sprintf(macroId, "macro_%03u", number);
+	MacroWriter writer;
+	writer.begin(macroId);
+	writer.add(0, 600, value);
+	writer.commit(name, 0);
+	_MacroIndex.put(number, name, writer.info().Duration, writer.info().ChannelMask);
+}
+
+// activateMacro() restarting macro_001: the old run is ended (its pin released) before the slot for the
+// saved version is acquired
+static void testEditedMacroRestartsWithAllSlotsPinned()
+{
+	_MacroIndex.begin();
+	const MacroCacheSlot *running[MACRO_CACHE_SLOTS];
+	for (uint8_t i = 0; i < MACRO_CACHE_SLOTS; i++)
+	{
+		char macroId[16];
+		sprintf(macroId, "macro_%03u", i + 1);
+		saveMacro(i + 1, "Run", 40);
+		running[i] = _MacroCache.acquire(macroId);
+		CHECK(running[i] != nullptr);
+	}
+	CHECK(_MacroCache.pinned() == MACRO_CACHE_SLOTS);
+
+	saveMacro(1, "Edited", 90);
+
+	// Still pinned by the old run, the new version has nowhere to go
+	CHECK(_MacroCache.acquire("macro_001") == nullptr);
+
+	_MacroCache.release(running[0]);
+	const MacroCacheSlot *restarted = _MacroCache.acquire("macro_001");
+	CHECK(restarted != nullptr);
+	if (restarted)
+	{
+		CHECK(restarted->Counts[0] == 1);
+		CHECK((restarted->Records[restarted->First[0]] & 0xFF) == 90);
+		CHECK(restarted->Version == _MacroIndex.find(1)->Version);
+	}
+	CHECK(_MacroCache.pinned() == MACRO_CACHE_SLOTS);
+}
+
+int main()
+{
+	testEditedMacroRestartsWithAllSlotsPinned();
+	if (_Failures == 0)
+	{
+		printf("OK\n");
+	}
+	return _Failures == 0 ? 0 : 1;
+}
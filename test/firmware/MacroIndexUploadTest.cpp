@@ -0,0 +1,161 @@
+/*
+Aqua Control Library
+
+Creationdate: 2026-10-18
+Host test: macro files uploaded into macros/ show up in the macro index and can be played.
+
+Build and run from the repository root:
+  g++ -std=gnu++17 -DESP8266 -Itest/firmware/stubs -Itest/firmware -Isrc test/firmware/MacroIndexUploadTest.cpp \
+      test/firmware/FakeArduino.cpp src/MacroIndex.cpp src/MacroFile.cpp src/AtomicFile.cpp src/ConfigReader.cpp \
+      src/ScheduleStore.cpp -o macro_index_upload_test && ./macro_index_upload_test
+
+Further information on www.schullebernd.de
+*/
+
+#include "AquaControl.h"
+#include "FakeArduino.h"
+
+// Defined in AquaControl.cpp, not reached by this test (legacy macros and schedule journal replay)
+uint8_t ScheduleSnapshot::add(Target) { abort(); }
+uint8_t PwmChannel::setTarget(Target) { abort(); }
+bool PwmChannel::removeTargetAtTime(time_t) { abort(); }
+
+static int _Failures = 0;
+
+#define CHECK(condition)                                             \
+	if (!(condition))                                                \
+	{                                                                \
+		printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); \
+		_Failures++;                                                 \
+	}
+
+// The bytes of a macro file, written by the firmware itself and taken off the card again
+static std::vector<uint8_t> macroFile(const char *macroId, const char *name)
+{
+	MacroWriter writer;
+	writer.begin(macroId);
+	writer.add(0, 600, 40);
+	writer.add(1, 1200, 80);
+	writer.commit(name, 0);
+	char path[ATOMIC_FILE_MAX_PATH];
+	macroFilePath(path, sizeof(path), macroId);
+	std::vector<uint8_t> bytes = FakeFiles[path];
+	FakeFiles.erase(path);
+	return bytes;
+}
+
+static void upload(const char *macroId, const std::vector<uint8_t> &bytes)
+{
+	char path[ATOMIC_FILE_MAX_PATH];
+	macroFilePath(path, sizeof(path), macroId);
+	fakePut(path, bytes.data(), bytes.size());
+	// What the upload handler does once a file in macros/ is complete
+	_MacroIndex.invalidate();
+}
+
+static void testUploadIsListed()
+{
+	std::vector<uint8_t> saved = macroFile("macro_001", "Sunrise");
+	upload("macro_001", saved);
+	_MacroIndex.begin();
+	CHECK(_MacroIndex.count() == 1);
+	CHECK(_MacroIndex.setFavorite(1, true));
+
+	// An index file exists now, the upload must not be hidden behind it
+	upload("macro_005", macroFile("macro_005", "Storm"));
+	CHECK(_MacroIndex.count() == 2);
+	const MacroIndexEntry *entry = _MacroIndex.find("macro_005");
+	CHECK(entry != nullptr);
+	if (entry)
+	{
+		CHECK(strcmp(entry->Name, "Storm") == 0);
+		CHECK(entry->Duration == 1200);
+		CHECK(entry->ChannelMask == 0x3);
+	}
+	// Favorites survive the rebuild
+	entry = _MacroIndex.find(1);
+	CHECK(entry && (entry->Flags & MacroFavorite));
+
+	// The rebuilt index is on the card, a restart lists the upload without another rebuild
+	uint32_t rebuilds = _MacroIndex.Rebuilds;
+	MacroIndex restarted;
+	restarted.begin();
+	CHECK(restarted.count() == 2);
+	CHECK(restarted.find(5) != nullptr);
+	CHECK(restarted.Rebuilds == 0);
+	CHECK(_MacroIndex.Rebuilds == rebuilds);
+}
+
+static void testUploadedMacroPlays()
+{
+	// The single file carries everything activation needs
+	MacroReader reader;
+	CHECK(reader.open("macro_005"));
+	CHECK(reader.info().Counts[0] == 1 && reader.info().Counts[1] == 1);
+	uint32_t time = 0;
+	uint8_t value = 0;
+	CHECK(reader.channel(1) && reader.next(time, value));
+	CHECK(time == 1200 && value == 80);
+	CHECK(!reader.next(time, value));
+	reader.close();
+}
+
+static void testDamagedUploadIsNotListed()
+{
+	std::vector<uint8_t> bytes = macroFile("macro_006", "Broken");
+	bytes.resize(bytes.size() - 1); // Upload cut off
+	upload("macro_006", bytes);
+	CHECK(_MacroIndex.find(6) == nullptr);
+	CHECK(_MacroIndex.find(5) != nullptr);
+}
+
+// A reset during a save leaves the verified macro as macro_NNN.mac.new (the old file may be gone) or an
+// unverified macro_NNN.mac.tmp. The rebuild finishes the first and drops the second.
+static void testInterruptedSaveIsRecovered()
+{
+	FakeFiles["macros/macro_007.mac.new"] = macroFile("macro_007", "Dusk");
+	std::vector<uint8_t> partial = macroFile("macro_008", "Half");
+	partial.resize(partial.size() / 2);
+	FakeFiles["macros/macro_008.mac.tmp"] = partial;
+	_MacroIndex.invalidate();
+
+	const MacroIndexEntry *entry = _MacroIndex.find(7);
+	CHECK(entry && strcmp(entry->Name, "Dusk") == 0);
+	CHECK(_MacroIndex.find(8) == nullptr);
+	CHECK(FakeFiles.count("macros/macro_007.mac") == 1);
+	CHECK(FakeFiles.count("macros/macro_007.mac.new") == 0);
+	CHECK(FakeFiles.count("macros/macro_008.mac.tmp") == 0);
+
+	// Leave the card as the following test expects it
+	FakeFiles.erase("macros/macro_007.mac");
+	_MacroIndex.invalidate();
+	CHECK(_MacroIndex.find(7) == nullptr);
+}
+
+static void testFullIndexReportsSkipped()
+{
+	std::vector<uint8_t> bytes = macroFile("macro_100", "Filler");
+	for (uint16_t n = 100; n < 100 + MACRO_INDEX_CAPACITY; n++)
+	{
+		char macroId[16];
+		sprintf(macroId, "macro_%03u", n);
+		upload(macroId, bytes);
+	}
+	CHECK(_MacroIndex.count() == MACRO_INDEX_CAPACITY);
+	CHECK(_MacroIndex.Skipped == 2);
+	CHECK(_MacroIndex.nextFreeNumber() == 0);
+}
+
+int main()
+{
+	testUploadIsListed();
+	testUploadedMacroPlays();
+	testDamagedUploadIsNotListed();
+	testInterruptedSaveIsRecovered();
+	testFullIndexReportsSkipped();
+	if (_Failures == 0)
+	{
+		printf("OK\n");
+	}
+	return _Failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,3 @@
+#pragma once
+#include <Arduino.h>
+class Adafruit_PWMServoDriver { public: Adafruit_PWMServoDriver(); void begin(); void setPWMFreq(float); void setPWM(uint8_t, uint16_t, uint16_t); };
@@ -0,0 +1,99 @@
+#pragma once
+#include <strings.h>
+#include <ctype.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <functional>
+#include <algorithm>
+using std::min; using std::max;
+typedef uint8_t byte;
+typedef bool boolean;
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+#define FPSTR(p) ((const __FlashStringHelper *)(p))
+class __FlashStringHelper;
+#define F(s) ((const __FlashStringHelper *)(s))
+#define strlen_P strlen
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+#define memcpy_P memcpy
+#define strcpy_P strcpy
+#define strcat_P strcat
+#define strncasecmp_P strncasecmp
+#define strncpy_P strncpy
+#define strcasecmp_P strcasecmp
+#define strstr_P strstr
+#define sprintf_P sprintf
+#define snprintf_P snprintf
+#define vsnprintf_P vsnprintf
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define pgm_read_word(p) (*(const uint16_t*)(p))
+#define pgm_read_dword(p) (*(const uint32_t*)(p))
+#define pgm_read_ptr(p) (*(void* const*)(p))
+#define D0 16
+#define D3 0
+#define D4 2
+#define D8 15
+#define FUNC_GPIO0 0
+#define FUNC_GPIO1 1
+#define FUNC_GPIO2 2
+#define FUNC_GPIO3 3
+#define ICACHE_RAM_ATTR
+#define IRAM_ATTR
+unsigned long millis(); unsigned long micros(); void delay(unsigned long); void yield();
+void analogWrite(uint8_t, int);
+uint16_t word(uint8_t, uint8_t);
+char *dtostrf(double, signed char, unsigned char, char *);
+class String {
+public:
+  String(const char *s = ""); String(const String &); String(const __FlashStringHelper *);
+  explicit String(char c); explicit String(int, unsigned char base = 10); explicit String(unsigned int, unsigned char base = 10);
+  explicit String(long, unsigned char base = 10); explicit String(unsigned long, unsigned char base = 10);
+  explicit String(float, unsigned char d = 2); explicit String(double, unsigned char d = 2);
+  ~String();
+  String &operator=(const String &); String &operator=(const char *);
+  String &operator+=(const String &); String &operator+=(const char *); String &operator+=(char); String &operator+=(int); String &operator+=(unsigned int);String &operator+=(long);String &operator+=(unsigned long);
+  friend String operator+(const String &, const String &); friend String operator+(const String &, const char *); friend String operator+(const String &, char);
+  bool operator==(const String &) const; bool operator==(const char *) const; bool operator!=(const String &) const; bool operator!=(const char *) const;
+  char operator[](unsigned int) const; char &operator[](unsigned int);
+  unsigned int length() const; const char *c_str() const; bool reserve(unsigned int);
+  int indexOf(char, unsigned int from = 0) const; int indexOf(const String &, unsigned int from = 0) const; int indexOf(const char *, unsigned int from = 0) const;
+  int lastIndexOf(char) const; int lastIndexOf(const char *) const;
+  String substring(unsigned int, unsigned int) const; String substring(unsigned int) const;
+  bool startsWith(const String &) const; bool startsWith(const char *) const; bool endsWith(const String &) const; bool endsWith(const char *) const;
+  bool equalsIgnoreCase(const String &) const;
+  char charAt(unsigned int) const; void trim(); void toLowerCase(); void toUpperCase(); long toInt() const; float toFloat() const;
+  void replace(const String &, const String &); void replace(const char *, const char *);
+  void toCharArray(char *, unsigned int, unsigned int index = 0) const; void remove(unsigned int); void remove(unsigned int, unsigned int);
+  bool concat(const char *, unsigned int);
+};
+extern const String emptyString;
+class Print {
+public:
+  virtual size_t write(uint8_t) = 0; virtual size_t write(const uint8_t *b, size_t n);
+  size_t write(const char *s); size_t write(const char *b, size_t n);
+  size_t print(const char *); size_t print(const String &); size_t print(const __FlashStringHelper *); size_t print(char);
+  size_t print(int, int = 10); size_t print(unsigned int, int = 10); size_t print(long, int = 10); size_t print(unsigned long, int = 10); size_t print(long long, int = 10);size_t print(unsigned long long, int = 10); size_t print(double, int = 2);
+  size_t println(); size_t println(const char *); size_t println(const String &); size_t println(const __FlashStringHelper *); size_t println(char);
+  size_t println(int, int = 10); size_t println(unsigned int, int = 10); size_t println(long, int = 10); size_t println(unsigned long, int = 10); size_t println(long long, int = 10);size_t println(unsigned long long, int = 10); size_t println(double, int = 2);
+  size_t printf(const char *, ...); size_t printf_P(PGM_P, ...);
+  virtual void flush() {}
+  virtual int availableForWrite() { return 0; }
+};
+class Stream : public Print {
+public:
+  virtual int available() = 0; virtual int read() = 0; virtual int peek() = 0;
+  String readStringUntil(char); size_t readBytesUntil(char, char *, size_t); size_t readBytes(char *, size_t); size_t readBytes(uint8_t *, size_t);
+  void setTimeout(unsigned long);
+  virtual size_t write(uint8_t) override; using Print::write;
+};
+class HardwareSerial : public Stream { public: void begin(unsigned long); int available() override; int read() override; int peek() override; };
+extern HardwareSerial Serial;
+class IPAddress { public: IPAddress(); IPAddress(uint32_t); IPAddress(uint8_t, uint8_t, uint8_t, uint8_t); String toString() const; bool fromString(const char *); operator uint32_t() const; };
+class EspClass { public: uint32_t getFreeHeap(); uint32_t getMaxFreeBlockSize(); uint8_t getHeapFragmentation(); uint16_t getVcc(); uint8_t getCpuFreqMHz(); void restart(); uint32_t getFreeContStack(); void resetFreeContStack(); uint32_t getCycleCount(); };
+extern EspClass ESP;
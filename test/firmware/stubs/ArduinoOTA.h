@@ -0,0 +1,6 @@
+#pragma once
+#include <Arduino.h>
+typedef int ota_error_t;
+enum { OTA_AUTH_ERROR, OTA_BEGIN_ERROR, OTA_CONNECT_ERROR, OTA_RECEIVE_ERROR, OTA_END_ERROR };
+class ArduinoOTAClass { public: void setHostname(const char *); void setPassword(const char *); void onStart(std::function<void()>); void onEnd(std::function<void()>); void onProgress(std::function<void(unsigned int, unsigned int)>); void onError(std::function<void(ota_error_t)>); void begin(); void handle(); };
+extern ArduinoOTAClass ArduinoOTA;
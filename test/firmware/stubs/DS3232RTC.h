@@ -0,0 +1,3 @@
+#pragma once
+#include <TimeLib.h>
+class DS3232RTC { public: void begin(); time_t get(); uint8_t set(time_t); };
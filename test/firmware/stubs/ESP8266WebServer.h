@@ -0,0 +1,18 @@
+#pragma once
+#include <ESP8266WiFi.h>
+#include <FS.h>
+enum HTTPMethod { HTTP_ANY, HTTP_GET, HTTP_HEAD, HTTP_POST, HTTP_PUT, HTTP_PATCH, HTTP_DELETE, HTTP_OPTIONS };
+enum HTTPUploadStatus { UPLOAD_FILE_START, UPLOAD_FILE_WRITE, UPLOAD_FILE_END, UPLOAD_FILE_ABORTED };
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+#define CONTENT_LENGTH_NOT_SET ((size_t)-2)
+#define HTTP_UPLOAD_BUFLEN 2048
+struct HTTPUpload { HTTPUploadStatus status; String filename; String name; String type; size_t totalSize; size_t currentSize; uint8_t buf[HTTP_UPLOAD_BUFLEN]; };
+class ESP8266WebServer { public: typedef std::function<void(void)> THandlerFunction; enum ClientFuture { CLIENT_REQUEST_CAN_CONTINUE, CLIENT_REQUEST_IS_HANDLED, CLIENT_MUST_STOP, CLIENT_IS_GIVEN }; typedef std::function<String(const String &)> ContentTypeFunction; typedef std::function<ClientFuture(const String &, const String &, WiFiClient *, ContentTypeFunction)> HookFunction; void addHook(HookFunction); ESP8266WebServer(int); void begin(); void handleClient(); void close(); void stop();
+ void on(const char *, THandlerFunction); void on(const char *, HTTPMethod, THandlerFunction); void on(const char *, HTTPMethod, THandlerFunction, THandlerFunction); void onNotFound(THandlerFunction);
+ const String &uri() const; HTTPMethod method() const; WiFiClient &client(); HTTPUpload &upload();
+ const String &arg(const char *) const; const String &arg(const String &) const; const String &arg(int) const; const String &argName(int) const; int args() const; bool hasArg(const char *) const; bool hasArg(const String &) const;
+ void collectHeaders(const char *headerKeys[], const size_t headerKeysCount); const String &header(const char *) const; const String &header(int) const; bool hasHeader(const char *) const; int headers() const;
+ void send(int, const char *content_type = NULL, const String &content = emptyString); void send(int, char *, const String &); void send(int, const String &, const String &); void send(int, const char *, const char *); void send(int, const char *, const char *, size_t);
+ void send_P(int, PGM_P, PGM_P); void send_P(int, PGM_P, PGM_P, size_t);
+ void setContentLength(size_t); void sendHeader(const String &, const String &, bool first = false); void sendContent(const String &); void sendContent(const char *); void sendContent(const char *, size_t); void sendContent_P(PGM_P); void sendContent_P(PGM_P, size_t);
+ template <typename T> size_t streamFile(T &, const String &, HTTPMethod requestMethod = HTTP_GET); void enableKeepAlive(bool); void enableCORS(bool); };
@@ -0,0 +1,8 @@
+#pragma once
+#include <WiFiClient.h>
+#define WIFI_STA 1
+#define WIFI_AP 2
+#define WL_CONNECTED 3
+class WiFiServer { public: WiFiServer(uint16_t); void begin(); WiFiClient available(); WiFiClient accept(); bool hasClient(); };
+class ESP8266WiFiClass { public: void persistent(bool); void mode(int); bool config(IPAddress, IPAddress, IPAddress); void begin(const char *, const char *); int status(); bool softAPdisconnect(); bool disconnect(); bool softAPConfig(IPAddress, IPAddress, IPAddress); bool softAP(const char *, const char *); IPAddress localIP(); };
+extern ESP8266WiFiClass WiFi;
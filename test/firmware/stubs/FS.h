@@ -0,0 +1,19 @@
+#pragma once
+#include <Arduino.h>
+#include <time.h>
+namespace fs {
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+class File : public Stream {
+public:
+  File(); size_t write(uint8_t) override; size_t write(const uint8_t *, size_t) override; using Print::write;
+  int available() override; int read() override; int peek() override; void flush() override;
+  int read(uint8_t *, size_t); bool seek(uint32_t, SeekMode = SeekSet); size_t position() const; size_t size() const; void close();
+  operator bool() const; const char *name() const; const char *fullName() const; bool isDirectory(); File openNextFile(); void rewindDirectory();
+  time_t getLastWrite(); time_t getCreationTime(); bool truncate(uint32_t);
+  int Handle = -1;
+};
+class Dir { public: bool next(); String fileName(); size_t fileSize(); File openFile(const char *); bool isDirectory(); };
+struct FSInfo { size_t totalBytes; size_t usedBytes; size_t blockSize; size_t pageSize; size_t maxOpenFiles; size_t maxPathLength; };
+class FS { public: bool begin(); void end(); bool format(); bool info(FSInfo &); File open(const char *, const char *mode = "r"); File open(const String &, const char *mode = "r"); bool exists(const char *); bool exists(const String &); bool remove(const char *); bool remove(const String &); bool rename(const char *, const char *); bool mkdir(const char *); bool rmdir(const char *); Dir openDir(const char *); };
+}
+using fs::File; using fs::FS; using fs::Dir; using fs::FSInfo; using fs::SeekSet; using fs::SeekCur; using fs::SeekEnd; using fs::SeekMode;
@@ -0,0 +1,3 @@
+#pragma once
+#include <Arduino.h>
+void sha1(const uint8_t *data, uint32_t size, uint8_t hash[20]);
@@ -0,0 +1,3 @@
+#pragma once
+#include <Arduino.h>
+class OneWire { public: OneWire(uint8_t); uint8_t reset(); void select(const uint8_t *); void write(uint8_t, uint8_t p = 0); uint8_t read(); uint8_t search(uint8_t *); void reset_search(); static uint8_t crc8(const uint8_t *, uint8_t); };
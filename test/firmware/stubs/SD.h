@@ -0,0 +1,7 @@
+#pragma once
+#include <FS.h>
+#define FILE_READ 0
+#define FILE_WRITE 1
+class SDClass { public: bool begin(uint8_t); File open(const char *, uint8_t mode = FILE_READ); File open(const String &, uint8_t mode = FILE_READ); File open(const __FlashStringHelper *, uint8_t mode = FILE_READ);
+ bool exists(const char *); bool exists(const String &); bool exists(const __FlashStringHelper *); bool remove(const char *); bool remove(const String &); bool remove(const __FlashStringHelper *); bool mkdir(const char *); bool rename(const char *, const char *); bool rmdir(const char*); };
+extern SDClass SD;
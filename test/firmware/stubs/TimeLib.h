@@ -0,0 +1,10 @@
+#pragma once
+#include <Arduino.h>
+#include <time.h>
+typedef struct { uint8_t Second, Minute, Hour, Wday, Day, Month, Year; } tmElements_t;
+enum timeStatus_t { timeNotSet, timeNeedsSync, timeSet };
+typedef time_t (*getExternalTime)();
+int hour(); int hour(time_t); int minute(); int minute(time_t); int second(); int second(time_t); int day(); int day(time_t); int month(); int month(time_t); int year(); int year(time_t); int weekday(time_t);
+time_t now(); void setTime(time_t); timeStatus_t timeStatus(); void setSyncProvider(getExternalTime); time_t makeTime(const tmElements_t &); void breakTime(time_t, tmElements_t &);
+#define SECS_PER_DAY 86400UL
+#define elapsedSecsToday(_time_) ((_time_) % SECS_PER_DAY)
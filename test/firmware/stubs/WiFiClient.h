@@ -0,0 +1,4 @@
+#pragma once
+#include <Arduino.h>
+class WiFiClient : public Stream { public: WiFiClient(); size_t write(uint8_t) override; size_t write(const uint8_t *, size_t) override; using Print::write; size_t write_P(PGM_P, size_t);
+ int available() override; int read() override; int peek() override; int read(uint8_t *, size_t); void flush() override; bool flush(unsigned int); void stop(); bool stop(unsigned int); uint8_t connected(); operator bool(); int availableForWrite() override; void setNoDelay(bool); bool getNoDelay() const; IPAddress remoteIP(); uint16_t remotePort(); void setSync(bool); bool operator==(const WiFiClient &) const; void keepAlive(uint16_t idle = 7200, uint16_t intv = 75, uint8_t count = 9); bool isKeepAliveEnabled() const; void disableKeepAlive(); uint8_t status(); };
@@ -0,0 +1,3 @@
+#pragma once
+#include <ESP8266WiFi.h>
+class WiFiUDP : public Stream { public: uint8_t begin(uint16_t); void stop(); int beginPacket(const char *, uint16_t); int beginPacket(IPAddress, uint16_t); int endPacket(); size_t write(uint8_t) override; size_t write(const uint8_t *, size_t) override; using Print::write; int parsePacket(); int available() override; int read() override; int read(unsigned char *, size_t); int read(char *, size_t); int peek() override; IPAddress remoteIP(); uint16_t remotePort(); };
@@ -9,10 +9,11 @@ Usage:
 Then open: http://localhost:5000
 """
 
-from flask import Flask, jsonify, request, send_from_directory
+from flask import Flask, Response, jsonify, request, send_from_directory
 from flask_cors import CORS
 import json
 import os
+import time
 from datetime import datetime, timedelta
 
 app = Flask(__name__)
@@ -349,6 +350,58 @@ def delete_target():
     return jsonify({"status": "ok", "targets": current_targets})
 
 
+def parse_time(time):
+    """HH:MM string or seconds"""
+    if isinstance(time, str):
+        parts = time.split(":")
+        return int(parts[0]) * 3600 + int(parts[1]) * 60
+    return int(time)
+
+
+@app.route("/api/schedule/batch", methods=["POST"])
+def schedule_batch():
+    """Apply add/move/delete operations atomically (all or nothing)"""
+    ops = (request.json or {}).get("ops")
+    if ops is None:
+        return jsonify({"error": "Missing ops"}), 400
+
+    staged = {}
+    for index, op in enumerate(ops):
+        try:
+            channel = int(op["channel"])
+            time = parse_time(op["time"])
+            if not 0 <= channel < 6 or not 0 <= time <= 86400:
+                raise ValueError
+            targets = staged.setdefault(channel, [dict(t) for t in schedules.get(channel, [])])
+            if op["op"] == "delete":
+                if not any(t["time"] == time for t in targets):
+                    raise ValueError
+                targets[:] = [t for t in targets if t["time"] != time]
+                continue
+            if op["op"] == "move":
+                source = parse_time(op["from"])
+                moved = next(t for t in targets if t["time"] == source)
+                value = op.get("value", moved["value"])
+                targets[:] = [t for t in targets if t["time"] != source]
+            elif op["op"] == "add":
+                value = op["value"]
+            else:
+                raise ValueError
+            targets[:] = [t for t in targets if t["time"] != time]
+            if len(targets) >= MAX_TARGETS:
+                raise ValueError
+            targets.append({"time": time, "value": max(0, min(100, int(value)))})
+            targets.sort(key=lambda t: t["time"])
+        except (KeyError, ValueError, StopIteration, TypeError):
+            return jsonify({"error": "Invalid operation", "index": index}), 400
+
+    for channel, targets in staged.items():
+        schedules[channel] = targets
+        write_channel_cfg(channel, targets)
+    save_schedules_to_disk()
+    return jsonify({"success": True, "applied": len(ops), "channels": len(staged)})
+
+
 # === Test Mode API ===
 
 
@@ -540,6 +593,21 @@ def status():
     return jsonify(status_data)
 
 
+@app.route("/api/events")
+def events():
+    """Server-Sent Events: status snapshot on connect, then a temperature event every 5 seconds"""
+    snapshot = status().get_data(as_text=True)
+
+    def stream():
+        yield "retry: 3000\n\n"
+        yield f"event: status\ndata: {snapshot}\n\n"
+        while True:
+            time.sleep(5)
+            yield 'event: temperature\ndata: {"temperature":24.5}\n\n'
+
+    return Response(stream(), mimetype="text/event-stream")
+
+
 # === Channel Configuration API ===
 
 
@@ -569,6 +637,17 @@ def get_channel_config():
     })
 
 
+@app.route("/api/bootstrap")
+def bootstrap():
+    """Status, channel config, schedules and macro list in one response"""
+    return jsonify({
+        "status": status().get_json(),
+        "config": get_channel_config().get_json(),
+        "schedules": get_all_schedules().get_json(),
+        "macros": macro_list().get_json(),
+    })
+
+
 @app.route("/api/config/channels", methods=["POST"])
 def save_channel_config():
     """Save channel names and colors"""